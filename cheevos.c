@@ -26,6 +26,7 @@
 #include "libretro.h"
 #include "net_http_special.h"
 #include "configuration.h"
+#include "mem_account.h"
 #include "performance.h"
 #include "runloop.h"
 
@@ -669,7 +670,7 @@ Load achievements from a JSON string.
 
 static INLINE const char *cheevos_dupstr(const cheevos_field_t *field)
 {
-   char *string = (char*)malloc(field->length + 1);
+   char *string = (char*)mem_tag_malloc(MEM_TAG_CHEEVOS, field->length + 1);
 
    if (!string)
       return NULL;
@@ -705,10 +706,10 @@ static int cheevos_new_cheevo(cheevos_readud_t *ud)
 
    if (!cheevo->title || !cheevo->description || !cheevo->author || !cheevo->badge)
    {
-      free((void*)cheevo->title);
-      free((void*)cheevo->description);
-      free((void*)cheevo->author);
-      free((void*)cheevo->badge);
+      mem_tag_free((void*)cheevo->title);
+      mem_tag_free((void*)cheevo->description);
+      mem_tag_free((void*)cheevo->author);
+      mem_tag_free((void*)cheevo->badge);
       return -1;
    }
 
@@ -716,7 +717,8 @@ static int cheevos_new_cheevo(cheevos_readud_t *ud)
 
    if (cheevo->count)
    {
-      cheevo->condsets = (cheevos_condset_t*)malloc(cheevo->count * sizeof(cheevos_condset_t));
+      cheevo->condsets = (cheevos_condset_t*)mem_tag_malloc(MEM_TAG_CHEEVOS,
+            cheevo->count * sizeof(cheevos_condset_t));
 
       if (!cheevo->condsets)
          return -1;
@@ -731,7 +733,8 @@ static int cheevos_new_cheevo(cheevos_readud_t *ud)
 
          if (condset->count)
          {
-            condset->conds = (cheevos_cond_t*)malloc(condset->count * sizeof(cheevos_cond_t));
+            condset->conds = (cheevos_cond_t*)mem_tag_malloc(MEM_TAG_CHEEVOS,
+                  condset->count * sizeof(cheevos_cond_t));
 
             if (!condset->conds)
                return -1;
@@ -853,16 +856,18 @@ static int cheevos_parse(const char *json)
 
    /* Allocate the achievements. */
 
-   cheevos_locals.core.cheevos = (cheevo_t*)malloc(core_count * sizeof(cheevo_t));
+   cheevos_locals.core.cheevos = (cheevo_t*)
+      mem_tag_calloc(MEM_TAG_CHEEVOS, core_count, sizeof(cheevo_t));
    cheevos_locals.core.count = core_count;
 
-   cheevos_locals.unofficial.cheevos = (cheevo_t*)malloc(unofficial_count * sizeof(cheevo_t));
+   cheevos_locals.unofficial.cheevos = (cheevo_t*)
+      mem_tag_calloc(MEM_TAG_CHEEVOS, unofficial_count, sizeof(cheevo_t));
    cheevos_locals.unofficial.count = unofficial_count;
 
    if (!cheevos_locals.core.cheevos || !cheevos_locals.unofficial.cheevos)
    {
-      free((void*)cheevos_locals.core.cheevos);
-      free((void*)cheevos_locals.unofficial.cheevos);
+      mem_tag_free((void*)cheevos_locals.core.cheevos);
+      mem_tag_free((void*)cheevos_locals.unofficial.cheevos);
       cheevos_locals.core.count = cheevos_locals.unofficial.count = 0;
 
       return -1;
@@ -1321,16 +1326,22 @@ Free the loaded achievements.
 
 static void cheevos_free_condset(const cheevos_condset_t *set)
 {
-   free((void*)set->conds);
+   mem_tag_free((void*)set->conds);
+   mem_tag_free((void*)set->expression);
 }
 
 static void cheevos_free_cheevo(const cheevo_t *cheevo)
 {
-   free((void*)cheevo->title);
-   free((void*)cheevo->description);
-   free((void*)cheevo->author);
-   free((void*)cheevo->badge);
-   cheevos_free_condset(cheevo->condsets);
+   unsigned i;
+
+   mem_tag_free((void*)cheevo->title);
+   mem_tag_free((void*)cheevo->description);
+   mem_tag_free((void*)cheevo->author);
+   mem_tag_free((void*)cheevo->badge);
+
+   for (i = 0; i < cheevo->count; i++)
+      cheevos_free_condset(cheevo->condsets + i);
+   mem_tag_free((void*)cheevo->condsets);
 }
 
 static void cheevos_free_cheevo_set(const cheevoset_t *set)
@@ -1341,7 +1352,7 @@ static void cheevos_free_cheevo_set(const cheevoset_t *set)
    while (cheevo < end)
       cheevos_free_cheevo(cheevo++);
 
-   free((void*)set->cheevos);
+   mem_tag_free((void*)set->cheevos);
 }
 
 void cheevos_unload(void)
@@ -30,8 +30,10 @@
 #include "msg_hash.h"
 
 #include "command.h"
+#include "command_event.h"
 
 #include "general.h"
+#include "perf_trace.h"
 #include "verbosity.h"
 
 #define DEFAULT_NETWORK_CMD_PORT 55355
@@ -250,8 +252,25 @@ static bool cmd_set_shader(const char *arg)
    return video_driver_set_shader(type, arg);
 }
 
+static bool cmd_perf_trace(const char *arg)
+{
+   settings_t *settings = config_get_ptr();
+   unsigned frames      = strtoul(arg, NULL, 0);
+
+   return perf_trace_start(frames, settings->perf_trace_path);
+}
+
+static bool cmd_memory_stats(const char *arg)
+{
+   (void)arg;
+   return event_command(EVENT_CMD_MEMORY_STATS_LOG);
+}
+
+/* Actions without an argument description take no argument. */
 static const struct cmd_action_map action_map[] = {
-   { "SET_SHADER", cmd_set_shader, "<shader path>" },
+   { "SET_SHADER",   cmd_set_shader,   "<shader path>" },
+   { "PERF_TRACE",   cmd_perf_trace,   "<frames>" },
+   { "MEMORY_STATS", cmd_memory_stats, NULL },
 };
 
 static bool command_get_arg(const char *tok,
@@ -279,11 +298,19 @@ static bool command_get_arg(const char *tok,
       if (str == tok)
       {
          const char *argument = str + strlen(action_map[i].str);
-         if (*argument != ' ')
+
+         if (!action_map[i].arg_desc)
+         {
+            if (*argument != '\0')
+               continue;
+         }
+         else if (*argument != ' ')
             return false;
+         else
+            argument++;
 
          if (arg)
-            *arg = argument + 1;
+            *arg = argument;
 
          if (index)
             *index = i;
@@ -606,7 +633,8 @@ static bool verify_command(const char *cmd)
       RARCH_ERR("\t\t%s\n", map[i].str);
 
    for (i = 0; i < sizeof(action_map) / sizeof(action_map[0]); i++)
-      RARCH_ERR("\t\t%s %s\n", action_map[i].str, action_map[i].arg_desc);
+      RARCH_ERR("\t\t%s %s\n", action_map[i].str,
+            action_map[i].arg_desc ? action_map[i].arg_desc : "");
 
    return false;
 }
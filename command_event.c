@@ -26,6 +26,7 @@
 #include "core_info.h"
 #include "cheats.h"
 #include "general.h"
+#include "mem_account.h"
 #include "performance.h"
 #include "dynamic.h"
 #include "content.h"
@@ -585,7 +586,8 @@ static bool event_init_core(void)
    rarch_ctl(RARCH_CTL_VERIFY_API_VERSION, NULL);
    core.retro_init();
 
-   global->sram.use = (global->inited.core.type == CORE_TYPE_PLAIN) &&
+   global->sram.use = (global->inited.core.type == CORE_TYPE_PLAIN ||
+         global->inited.core.type == CORE_TYPE_BENCHMARK) &&
       !global->inited.core.no_content;
 
    if (!event_init_content())
@@ -886,6 +888,102 @@ static bool event_update_system_info(struct retro_system_info *_info,
 }
 #endif
 
+/**
+ * event_reinit:
+ * @subsystems           : Bitmask of enum config_subsystem.
+ *
+ * Restarts @subsystems and whatever depends on them, leaving
+ * everything else running. Dependents are torn down first and
+ * brought back up last.
+ **/
+void event_reinit(unsigned subsystems)
+{
+   int flags = 0;
+
+   /* The input driver is created along with the video driver,
+    * and the menu and overlays hold video resources. */
+   if (subsystems & CONFIG_SUBSYSTEM_INPUT)
+      subsystems |= CONFIG_SUBSYSTEM_VIDEO;
+   if (subsystems & CONFIG_SUBSYSTEM_VIDEO)
+      subsystems |= CONFIG_SUBSYSTEM_INPUT | CONFIG_SUBSYSTEM_MENU;
+
+   /* A video restart also reloads overlays, an audio restart
+    * also reloads the DSP filter. */
+   if (subsystems & CONFIG_SUBSYSTEM_VIDEO)
+      subsystems &= ~CONFIG_SUBSYSTEM_OVERLAY;
+   if (subsystems & CONFIG_SUBSYSTEM_AUDIO)
+      subsystems &= ~CONFIG_SUBSYSTEM_DSP_FILTER;
+
+   if (subsystems == CONFIG_SUBSYSTEM_NONE)
+      return;
+
+   RARCH_LOG("Reinitializing subsystems (0x%x).\n", subsystems);
+
+   if (subsystems & CONFIG_SUBSYSTEM_VIDEO)
+      flags |= DRIVER_VIDEO | DRIVER_INPUT | DRIVERS_VIDEO_INPUT;
+   if (subsystems & CONFIG_SUBSYSTEM_AUDIO)
+      flags |= DRIVER_AUDIO;
+   if (subsystems & CONFIG_SUBSYSTEM_MENU)
+      flags |= DRIVER_MENU;
+   if (subsystems & CONFIG_SUBSYSTEM_CAMERA)
+      flags |= DRIVER_CAMERA;
+   if (subsystems & CONFIG_SUBSYSTEM_LOCATION)
+      flags |= DRIVER_LOCATION;
+
+   if (subsystems & CONFIG_SUBSYSTEM_AUTOSAVE)
+      event_command(EVENT_CMD_AUTOSAVE_DEINIT);
+   if (subsystems & CONFIG_SUBSYSTEM_REWIND)
+      event_command(EVENT_CMD_REWIND_DEINIT);
+   if (subsystems & CONFIG_SUBSYSTEM_OVERLAY)
+      event_command(EVENT_CMD_OVERLAY_DEINIT);
+
+   if (subsystems & CONFIG_SUBSYSTEM_VIDEO)
+   {
+      const struct retro_hw_render_callback *hw_render =
+         (const struct retro_hw_render_callback*)video_driver_callback();
+
+      if (hw_render->cache_context)
+         video_driver_ctl(RARCH_DISPLAY_CTL_SET_VIDEO_CACHE_CONTEXT, NULL);
+      else
+         video_driver_ctl(RARCH_DISPLAY_CTL_UNSET_VIDEO_CACHE_CONTEXT, NULL);
+
+      video_driver_ctl(RARCH_DISPLAY_CTL_UNSET_VIDEO_CACHE_CONTEXT_ACK, NULL);
+   }
+
+   if (flags)
+   {
+      driver_ctl(RARCH_DRIVER_CTL_UNINIT, &flags);
+      driver_ctl(RARCH_DRIVER_CTL_INIT, &flags);
+   }
+
+   if (subsystems & CONFIG_SUBSYSTEM_VIDEO)
+   {
+      video_driver_ctl(RARCH_DISPLAY_CTL_UNSET_VIDEO_CACHE_CONTEXT, NULL);
+
+      /* Poll input to avoid possibly stale data to corrupt things. */
+      input_driver_ctl(RARCH_INPUT_CTL_POLL, NULL);
+   }
+
+   if (subsystems & CONFIG_SUBSYSTEM_DSP_FILTER)
+      event_command(EVENT_CMD_DSP_FILTER_INIT);
+   if (subsystems & CONFIG_SUBSYSTEM_OVERLAY)
+      event_command(EVENT_CMD_OVERLAY_INIT);
+   if (subsystems & CONFIG_SUBSYSTEM_REWIND)
+      event_command(EVENT_CMD_REWIND_INIT);
+   if (subsystems & CONFIG_SUBSYSTEM_AUTOSAVE)
+      event_command(EVENT_CMD_AUTOSAVE_INIT);
+
+#ifdef HAVE_MENU
+   if (subsystems & CONFIG_SUBSYSTEM_MENU)
+   {
+      menu_display_ctl(MENU_DISPLAY_CTL_SET_FRAMEBUFFER_DIRTY_FLAG, NULL);
+
+      if (menu_driver_ctl(RARCH_MENU_CTL_IS_ALIVE, NULL))
+         event_command(EVENT_CMD_VIDEO_SET_BLOCKING_STATE);
+   }
+#endif
+}
+
 /**
  * event_command:
  * @cmd                  : Event command index.
@@ -1010,7 +1108,7 @@ bool event_command(enum event_command cmd)
             settings->video.scale = *window_scale;
 
             if (!settings->video.fullscreen)
-               event_command(EVENT_CMD_REINIT);
+               event_reinit(config_get_subsystems("video_scale"));
 
             runloop_ctl(RUNLOOP_CTL_SET_WINDOWED_SCALE, &idx);
          }
@@ -1065,29 +1163,7 @@ bool event_command(enum event_command cmd)
          rarch_ctl(RARCH_CTL_QUIT, NULL);
          break;
       case EVENT_CMD_REINIT:
-         {
-            const struct retro_hw_render_callback *hw_render =
-               (const struct retro_hw_render_callback*)video_driver_callback();
-
-            if (hw_render->cache_context)
-               video_driver_ctl(RARCH_DISPLAY_CTL_SET_VIDEO_CACHE_CONTEXT, NULL);
-            else
-               video_driver_ctl(RARCH_DISPLAY_CTL_UNSET_VIDEO_CACHE_CONTEXT, NULL);
-
-            video_driver_ctl(RARCH_DISPLAY_CTL_UNSET_VIDEO_CACHE_CONTEXT_ACK, NULL);
-            event_command(EVENT_CMD_RESET_CONTEXT);
-            video_driver_ctl(RARCH_DISPLAY_CTL_UNSET_VIDEO_CACHE_CONTEXT, NULL);
-
-            /* Poll input to avoid possibly stale data to corrupt things. */
-            input_driver_ctl(RARCH_INPUT_CTL_POLL, NULL);
-
-#ifdef HAVE_MENU
-            menu_display_ctl(MENU_DISPLAY_CTL_SET_FRAMEBUFFER_DIRTY_FLAG, NULL);
-
-            if (menu_driver_ctl(RARCH_MENU_CTL_IS_ALIVE, NULL))
-               event_command(EVENT_CMD_VIDEO_SET_BLOCKING_STATE);
-#endif
-         }
+         event_reinit(CONFIG_SUBSYSTEM_DRIVERS);
          break;
       case EVENT_CMD_CHEATS_DEINIT:
          cheat_manager_state_free();
@@ -1230,6 +1306,9 @@ bool event_command(enum event_command cmd)
          break;
       case EVENT_CMD_CORE_INFO_DEINIT:
          runloop_ctl(RUNLOOP_CTL_CURRENT_CORE_LIST_FREE, NULL);
+#ifdef HAVE_DYNAMIC
+         libretro_free_system_info_cache();
+#endif
          break;
       case EVENT_CMD_CORE_INFO_INIT:
          event_command(EVENT_CMD_CORE_INFO_DEINIT);
@@ -1465,7 +1544,7 @@ bool event_command(enum event_command cmd)
          /* If we go fullscreen we drop all drivers and
           * reinitialize to be safe. */
          settings->video.fullscreen = !settings->video.fullscreen;
-         event_command(EVENT_CMD_REINIT);
+         event_reinit(config_get_subsystems("video_fullscreen"));
          break;
       case EVENT_CMD_COMMAND_DEINIT:
          input_driver_ctl(RARCH_INPUT_CTL_COMMAND_DEINIT, NULL);
@@ -1581,6 +1660,9 @@ bool event_command(enum event_command cmd)
       case EVENT_CMD_PERFCNT_REPORT_FRONTEND_LOG:
          rarch_perf_log();
          break;
+      case EVENT_CMD_MEMORY_STATS_LOG:
+         mem_account_log();
+         break;
       case EVENT_CMD_VOLUME_UP:
          event_set_volume(0.5f);
          break;
@@ -50,7 +50,8 @@ enum event_command
    EVENT_CMD_TAKE_SCREENSHOT,
    /* Quits RetroArch. */
    EVENT_CMD_QUIT,
-   /* Reinitialize all drivers. */
+   /* Reinitialize all drivers, see event_reinit() to
+    * only restart some of them. */
    EVENT_CMD_REINIT,
    /* Deinitialize rewind. */
    EVENT_CMD_REWIND_DEINIT,
@@ -201,6 +202,8 @@ enum event_command
    /* Toggles fullscreen mode. */
    EVENT_CMD_FULLSCREEN_TOGGLE,
    EVENT_CMD_PERFCNT_REPORT_FRONTEND_LOG,
+   /* Logs memory use per subsystem. */
+   EVENT_CMD_MEMORY_STATS_LOG,
    EVENT_CMD_REMAPPING_INIT,
    EVENT_CMD_REMAPPING_DEINIT,
    EVENT_CMD_VOLUME_UP,
@@ -225,6 +228,16 @@ void event_disk_control_append_image(const char *path);
  **/
 bool event_command(enum event_command action);
 
+/**
+ * event_reinit:
+ * @subsystems           : Bitmask of enum config_subsystem.
+ *
+ * Restarts @subsystems and whatever depends on them, leaving
+ * everything else running. Dependents are torn down first and
+ * brought back up last.
+ **/
+void event_reinit(unsigned subsystems);
+
 #ifdef __cplusplus
 }
 #endif
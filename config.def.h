@@ -725,6 +725,33 @@ static const unsigned menu_dpi_override_value = 200;
 /* Log level for libretro cores (GET_LOG_INTERFACE). */
 static const unsigned libretro_log_level = 0;
 
+/* Log level for the frontend's own messages (RARCH_LOG and friends). */
+static const unsigned frontend_log_level = 0;
+
+/* Log and reset performance counters every this many frames, 0 to never. */
+static const unsigned perfcnt_reset_interval = 0;
+
+/* Count CPU events (cycles, cache misses, ...) around every frame
+ * of the core. Linux only. */
+static const bool perfcnt_hw_enable = false;
+
+/* Frames to record into a trace, starting at perf_trace_start_frame.
+ * 0 only records when asked to through the PERF_TRACE command. */
+static const unsigned perf_trace_frames = 0;
+static const unsigned perf_trace_start_frame = 0;
+
+/* Synthetic core started with --benchmark. */
+static const unsigned benchmark_width = 320;
+static const unsigned benchmark_height = 240;
+/* 0RGB1555, RGB565 or XRGB8888. */
+static const char benchmark_pixel_format[] = "XRGB8888";
+/* Stereo frames passed to the audio driver per video frame. */
+static const unsigned benchmark_audio_batch = 800;
+static const unsigned benchmark_serialize_size = 64 * 1024;
+/* Fraction of the savestate that changes every frame. */
+static const float benchmark_dirty_ratio = 0.05f;
+static const unsigned benchmark_sram_size = 8 * 1024;
+
 #ifndef RARCH_DEFAULT_PORT
 #define RARCH_DEFAULT_PORT 55435
 #endif
@@ -15,11 +15,15 @@
  */
 
 #include <ctype.h>
+#include <errno.h>
+#include <stddef.h>
+#include <time.h>
 
 #include <file/config_file.h>
 #include <file/file_path.h>
 #include <compat/strl.h>
 #include <compat/posix_string.h>
+#include <retro_miscellaneous.h>
 #include <retro_stat.h>
 #include <string/stdstring.h>
 
@@ -30,7 +34,9 @@
 #include "input/input_keymaps.h"
 #include "input/input_remapping.h"
 #include "defaults.h"
+#include "file_ops.h"
 #include "general.h"
+#include "msg_hash.h"
 #include "retroarch.h"
 #include "system.h"
 #include "verbosity.h"
@@ -59,9 +65,403 @@ settings_t *config_get_ptr(void)
    return *settings;
 }
 
+/**
+ * config_get_cache_file_path:
+ * @name            : File name of the cache.
+ * @s               : Output buffer.
+ * @len             : Size of @s.
+ *
+ * Cache files live in the cache directory, or next to the
+ * config file if no cache directory is set.
+ *
+ * Returns: true (1) if a location is known, otherwise false (0)
+ * and @s is left empty.
+ **/
+bool config_get_cache_file_path(const char *name, char *s, size_t len)
+{
+   char dir[PATH_MAX_LENGTH] = {0};
+   settings_t *settings      = config_get_ptr();
+   global_t   *global        = global_get_ptr();
+
+   *s = '\0';
+
+   if (settings && *settings->cache_directory)
+      strlcpy(dir, settings->cache_directory, sizeof(dir));
+   else if (global && *global->path.config)
+      fill_pathname_basedir(dir, global->path.config, sizeof(dir));
+
+   if (!*dir)
+      return false;
+
+   fill_pathname_join(s, dir, name, len);
+   return true;
+}
+
+/* Cheap fingerprint of every key/value pair, used to spot
+ * changes made to a config file behind the index's back. */
+static uint32_t config_file_checksum(const config_file_t *conf)
+{
+   uint32_t hash                        = 5381;
+   const struct config_entry_list *list = NULL;
+
+   for (list = conf->entries; list; list = list->next)
+   {
+      hash = (hash * 33) ^ msg_hash_calculate(list->key);
+      hash = (hash * 33) ^ msg_hash_calculate(list->value ? list->value : "");
+   }
+
+   return hash;
+}
+
+/* Parsed config files (layers) are kept in memory, so switching
+ * cores or content only has to stat retroarch.cfg and its
+ * overrides instead of parsing them again. */
+#ifndef CONFIG_LAYER_CACHE_SIZE
+#define CONFIG_LAYER_CACHE_SIZE 16
+#endif
+
+enum config_layer_type
+{
+   /* retroarch.cfg or a per-core config. */
+   CONFIG_LAYER_BASE = 0,
+   /* Passed through --appendconfig. */
+   CONFIG_LAYER_APPEND,
+   /* Override of a core, content directory or game. */
+   CONFIG_LAYER_CORE,
+   CONFIG_LAYER_CONTENT_DIR,
+   CONFIG_LAYER_GAME,
+   /* Input remap file. */
+   CONFIG_LAYER_REMAP
+};
+
+static const char *config_layer_names[] = {
+   "base",
+   "append",
+   "core override",
+   "content dir override",
+   "game override",
+   "remap"
+};
+
+typedef struct config_layer
+{
+   char *path;
+   enum config_layer_type type;
+   /* NULL if the file does not exist. */
+   config_file_t *conf;
+   uint64_t size;
+   int64_t mtime;
+   /* Parsed within the same second the file was last modified,
+    * or pulls in other files through #include, so size and mtime
+    * alone can't tell whether the parsed entries are stale. */
+   bool racy;
+   /* Handed over by config_layer_adopt() without being on disk,
+    * kept as is until the file shows up. */
+   bool pinned;
+   /* Fingerprint of the parsed entries, 0 if there are none. */
+   uint32_t checksum;
+   unsigned last_used;
+} config_layer_t;
+
+static config_layer_t config_layers[CONFIG_LAYER_CACHE_SIZE];
+static unsigned config_layers_clock;
+
+/* Fingerprint of the layers config_load_file() applied last. */
+static uint32_t config_layers_applied;
+
+static void config_layer_clear(config_layer_t *layer)
+{
+   if (layer->conf)
+      config_file_free(layer->conf);
+   free(layer->path);
+   memset(layer, 0, sizeof(*layer));
+}
+
+static void config_layer_set_conf(config_layer_t *layer,
+      config_file_t *conf, bool exists, uint64_t size, int64_t mtime)
+{
+   uint32_t checksum = conf ? config_file_checksum(conf) : 0;
+
+   if (layer->conf && layer->conf != conf)
+      config_file_free(layer->conf);
+
+   layer->conf   = conf;
+   layer->size   = size;
+   layer->mtime  = mtime;
+   layer->pinned = false;
+   layer->racy   = exists && ((int64_t)time(NULL) <= mtime
+         || (conf && conf->includes));
+
+   if (conf && checksum != layer->checksum)
+      RARCH_LOG("Config: parsed %s layer \"%s\".\n",
+            config_layer_names[layer->type], layer->path);
+   layer->checksum = checksum;
+}
+
+/* Finds the slot of @path, or claims the least recently
+ * used one. */
+static config_layer_t *config_layer_slot(const char *path,
+      enum config_layer_type type)
+{
+   size_t i;
+   config_layer_t *layer = NULL;
+
+   for (i = 0; i < CONFIG_LAYER_CACHE_SIZE; i++)
+   {
+      config_layer_t *cur = &config_layers[i];
+
+      if (cur->path && !strcmp(cur->path, path))
+      {
+         cur->last_used = ++config_layers_clock;
+         return cur;
+      }
+
+      if (!layer || (layer->path &&
+               (!cur->path || cur->last_used < layer->last_used)))
+         layer = cur;
+   }
+
+   config_layer_clear(layer);
+
+   if (!(layer->path = strdup(path)))
+      return NULL;
+
+   layer->type      = type;
+   /* Makes config_layer_get() parse the file. */
+   layer->racy      = true;
+   layer->last_used = ++config_layers_clock;
+   return layer;
+}
+
+/**
+ * config_layer_get:
+ * @path            : Path of the config file.
+ * @type            : What the file is used for, if it is new
+ *                    to the cache.
+ *
+ * Gets the parsed config file at @path, parsing it again only
+ * if it changed on disk since it was last parsed. The config
+ * file stays owned by the cache; it is valid until the next
+ * call to config_layer_get().
+ *
+ * Returns: cached layer, with a NULL conf if @path does not
+ * exist. NULL on allocation failure.
+ **/
+static config_layer_t *config_layer_get(const char *path,
+      enum config_layer_type type)
+{
+   uint64_t size         = 0;
+   int64_t mtime         = 0;
+   bool exists           = false;
+   config_layer_t *layer = NULL;
+
+   if (string_is_empty(path))
+      return NULL;
+
+   if (!(layer = config_layer_slot(path, type)))
+      return NULL;
+
+   exists = file_get_stat(path, &size, &mtime);
+
+   if (layer->pinned && !exists)
+      return layer;
+
+   if (!layer->racy)
+   {
+      if (!exists && !layer->conf)
+         return layer;
+      if (exists && layer->conf
+            && layer->size == size && layer->mtime == mtime)
+         return layer;
+   }
+
+   config_layer_set_conf(layer, exists ? config_file_new(path) : NULL,
+         exists, size, mtime);
+   return layer;
+}
+
+/* Hands a config file parsed elsewhere over to the cache. */
+static void config_layer_adopt(const char *path, config_file_t *conf)
+{
+   uint64_t size         = 0;
+   int64_t mtime         = 0;
+   bool exists           = false;
+   config_layer_t *layer = config_layer_slot(path, CONFIG_LAYER_BASE);
+
+   if (!layer)
+   {
+      config_file_free(conf);
+      return;
+   }
+
+   exists = file_get_stat(path, &size, &mtime);
+   config_layer_set_conf(layer, conf, exists, size, mtime);
+
+   if (!exists)
+      layer->pinned = true;
+}
+
+/* Makes the next config_layer_get() of @path parse it again. */
+static void config_layer_invalidate(const char *path)
+{
+   size_t i;
+
+   for (i = 0; i < CONFIG_LAYER_CACHE_SIZE; i++)
+      if (config_layers[i].path && !strcmp(config_layers[i].path, path))
+         config_layers[i].racy = true;
+}
+
+static uint32_t config_layer_signature(uint32_t signature,
+      const config_layer_t *layer)
+{
+   signature = (signature * 33) ^ msg_hash_calculate(layer->path);
+   return (signature * 33) ^ layer->checksum;
+}
+
+/**
+ * config_layers_merge:
+ * @layers          : Layers, lowest precedence first.
+ * @count           : Number of layers.
+ *
+ * Copies the entries of every layer into a new config file.
+ * Entries of higher precedence layers come first, so they win
+ * lookups, just like config_append_file() does it.
+ *
+ * Returns: merged config file, or NULL on error.
+ **/
+static config_file_t *config_layers_merge(config_layer_t **layers,
+      size_t count)
+{
+   size_t i;
+   config_file_t *conf = config_file_new(NULL);
+
+   if (!conf)
+      return NULL;
+
+   for (i = count; i-- > 0; )
+   {
+      const struct config_entry_list *list = NULL;
+
+      if (!layers[i]->conf)
+         continue;
+
+      for (list = layers[i]->conf->entries; list; list = list->next)
+      {
+         struct config_entry_list *entry = (struct config_entry_list*)
+            calloc(1, sizeof(*entry));
+
+         if (!entry)
+            goto error;
+
+         entry->key   = strdup(list->key);
+         entry->value = strdup(list->value ? list->value : "");
+
+         if (conf->tail)
+            conf->tail->next = entry;
+         else
+            conf->entries    = entry;
+         conf->tail = entry;
+
+         if (!entry->key || !entry->value)
+            goto error;
+      }
+   }
+
+   return conf;
+
+error:
+   config_file_free(conf);
+   return NULL;
+}
+
+/**
+ * config_layers_collect:
+ * @path            : Path of the base config file.
+ * @layers          : Filled with the base layer, followed by
+ *                    every file in append_config_path.
+ * @signature       : Fingerprint of the collected layers.
+ *
+ * Returns: number of layers collected, 0 if the base config
+ * file could not be read.
+ **/
+static size_t config_layers_collect(const char *path,
+      config_layer_t **layers, uint32_t *signature)
+{
+   char *save                            = NULL;
+   const char *extra_path                = NULL;
+   char tmp_append_path[PATH_MAX_LENGTH] = {0}; /* Don't destroy append_config_path. */
+   size_t count                          = 0;
+   global_t *global                      = global_get_ptr();
+
+   layers[0] = config_layer_get(path, CONFIG_LAYER_BASE);
+   if (!layers[0] || !layers[0]->conf)
+      return 0;
+
+   *signature = config_layer_signature(5381, layers[0]);
+   count      = 1;
+
+   strlcpy(tmp_append_path, global->path.append_config,
+         sizeof(tmp_append_path));
+   extra_path = strtok_r(tmp_append_path, "|", &save);
+
+   while (extra_path)
+   {
+      config_layer_t *layer = NULL;
+
+      /* Every collected layer must stay in the cache. */
+      if (count == CONFIG_LAYER_CACHE_SIZE)
+      {
+         RARCH_ERR("Config: too many configs to append, ignoring \"%s\"\n",
+               extra_path);
+         break;
+      }
+
+      layer = config_layer_get(extra_path, CONFIG_LAYER_APPEND);
+
+      if (layer && layer->conf)
+      {
+         RARCH_LOG("Config: appending config \"%s\"\n", extra_path);
+         *signature      = config_layer_signature(*signature, layer);
+         layers[count++] = layer;
+      }
+      else
+         RARCH_ERR("Config: failed to append config \"%s\"\n", extra_path);
+
+      extra_path = strtok_r(NULL, "|", &save);
+   }
+
+   return count;
+}
+
+/* Whether config_load_file(@path) would apply the exact same
+ * layers it applied last, making the reload a no-op. */
+static bool config_layers_unchanged(const char *path)
+{
+   config_layer_t *layers[CONFIG_LAYER_CACHE_SIZE];
+   uint32_t signature = 0;
+
+   if (!config_layers_applied)
+      return false;
+   if (!config_layers_collect(path, layers, &signature))
+      return false;
+   return signature == config_layers_applied;
+}
+
+static void config_layers_free(void)
+{
+   size_t i;
+
+   for (i = 0; i < CONFIG_LAYER_CACHE_SIZE; i++)
+      config_layer_clear(&config_layers[i]);
+   config_layers_clock   = 0;
+   config_layers_applied = 0;
+}
+
 void config_free(void)
 {
    settings_t *settings = config_get_ptr();
+   config_layers_free();
+
    if (!settings)
       return;
 
@@ -420,7 +820,812 @@ const char *config_get_default_location(void)
          break;
    }
 
-   return "null";
+   return "null";
+}
+
+enum config_setting_type
+{
+   CONFIG_SETTING_BOOL = 0,
+   CONFIG_SETTING_INT,
+   CONFIG_SETTING_UINT,
+   CONFIG_SETTING_FLOAT,
+   CONFIG_SETTING_HEX,
+   CONFIG_SETTING_ARRAY,
+   CONFIG_SETTING_PATH
+};
+
+/* "default" in the config file means an empty value. */
+#define CONFIG_SETTING_FLAG_LOAD_DEFAULT  (1 << 0)
+/* An empty value is written out as "default". */
+#define CONFIG_SETTING_FLAG_SAVE_DEFAULT  (1 << 1)
+#define CONFIG_SETTING_FLAG_DEFAULT_DIR   (CONFIG_SETTING_FLAG_LOAD_DEFAULT | CONFIG_SETTING_FLAG_SAVE_DEFAULT)
+/* Path that is written out verbatim, without abbreviating it. */
+#define CONFIG_SETTING_FLAG_SAVE_STRING   (1 << 2)
+#define CONFIG_SETTING_FLAG_NO_SAVE       (1 << 3)
+
+struct config_setting
+{
+   const char *key;
+   enum config_setting_type type;
+   size_t offset;
+   size_t size;
+   unsigned flags;
+   /* Default value from config.def.h, NULL if the default
+    * is set up by config_set_defaults() itself. */
+   const void *def;
+   size_t def_size;
+};
+
+#define CONFIG_FIELD(field)   offsetof(settings_t, field), sizeof(((settings_t*)0)->field)
+#define CONFIG_DEF(var)       &(var), sizeof(var)
+#define CONFIG_DEF_EMPTY      "", 1
+#define CONFIG_DEF_NONE       NULL, 0
+
+/* Settings which map one config key to one settings_t field.
+ * Anything with side effects, clamping or command line overrides
+ * is handled by config_load_file() and config_save_file(). */
+static const struct config_setting config_settings[] = {
+   { "video_scale",                 CONFIG_SETTING_FLOAT, CONFIG_FIELD(video.scale),                 0, CONFIG_DEF(scale) },
+   { "video_fullscreen_x",          CONFIG_SETTING_UINT,  CONFIG_FIELD(video.fullscreen_x),          0, CONFIG_DEF(fullscreen_x) },
+   { "video_fullscreen_y",          CONFIG_SETTING_UINT,  CONFIG_FIELD(video.fullscreen_y),          0, CONFIG_DEF(fullscreen_y) },
+   { "video_windowed_fullscreen",   CONFIG_SETTING_BOOL,  CONFIG_FIELD(video.windowed_fullscreen),   0, CONFIG_DEF(windowed_fullscreen) },
+   { "video_monitor_index",         CONFIG_SETTING_UINT,  CONFIG_FIELD(video.monitor_index),         0, CONFIG_DEF(monitor_index) },
+   { "video_disable_composition",   CONFIG_SETTING_BOOL,  CONFIG_FIELD(video.disable_composition),   0, CONFIG_DEF(disable_composition) },
+   { "video_vsync",                 CONFIG_SETTING_BOOL,  CONFIG_FIELD(video.vsync),                 0, CONFIG_DEF(vsync) },
+   { "video_hard_sync",             CONFIG_SETTING_BOOL,  CONFIG_FIELD(video.hard_sync),             0, CONFIG_DEF(hard_sync) },
+   { "video_hard_sync_frames",      CONFIG_SETTING_UINT,  CONFIG_FIELD(video.hard_sync_frames),      0, CONFIG_DEF(hard_sync_frames) },
+   { "video_frame_delay",           CONFIG_SETTING_UINT,  CONFIG_FIELD(video.frame_delay),           0, CONFIG_DEF(frame_delay) },
+   { "video_black_frame_insertion", CONFIG_SETTING_BOOL,  CONFIG_FIELD(video.black_frame_insertion), 0, CONFIG_DEF(black_frame_insertion) },
+   { "video_swap_interval",         CONFIG_SETTING_UINT,  CONFIG_FIELD(video.swap_interval),         0, CONFIG_DEF(swap_interval) },
+   { "video_threaded",              CONFIG_SETTING_BOOL,  CONFIG_FIELD(video.threaded),              0, CONFIG_DEF(video_threaded) },
+   { "video_shared_context",        CONFIG_SETTING_BOOL,  CONFIG_FIELD(video.shared_context),        0, CONFIG_DEF(video_shared_context) },
+#ifdef GEKKO
+   { "video_viwidth",               CONFIG_SETTING_UINT,  CONFIG_FIELD(video.viwidth),               0, CONFIG_DEF(video_viwidth) },
+   { "video_vfilter",               CONFIG_SETTING_BOOL,  CONFIG_FIELD(video.vfilter),               0, CONFIG_DEF(video_vfilter) },
+#endif
+   { "video_smooth",                CONFIG_SETTING_BOOL,  CONFIG_FIELD(video.smooth),                0, CONFIG_DEF(video_smooth) },
+   { "video_force_aspect",          CONFIG_SETTING_BOOL,  CONFIG_FIELD(video.force_aspect),
+      CONFIG_SETTING_FLAG_NO_SAVE, CONFIG_DEF(force_aspect) },
+   { "video_scale_integer",         CONFIG_SETTING_BOOL,  CONFIG_FIELD(video.scale_integer),         0, CONFIG_DEF(scale_integer) },
+   { "video_crop_overscan",         CONFIG_SETTING_BOOL,  CONFIG_FIELD(video.crop_overscan),         0, CONFIG_DEF(crop_overscan) },
+   { "video_aspect_ratio",          CONFIG_SETTING_FLOAT, CONFIG_FIELD(video.aspect_ratio),          0, CONFIG_DEF(aspect_ratio) },
+   { "aspect_ratio_index",          CONFIG_SETTING_UINT,  CONFIG_FIELD(video.aspect_ratio_idx),      0, CONFIG_DEF(aspect_ratio_idx) },
+   { "video_aspect_ratio_auto",     CONFIG_SETTING_BOOL,  CONFIG_FIELD(video.aspect_ratio_auto),     0, CONFIG_DEF(aspect_ratio_auto) },
+   { "video_refresh_rate",          CONFIG_SETTING_FLOAT, CONFIG_FIELD(video.refresh_rate),          0, CONFIG_DEF(refresh_rate) },
+   { "video_shader",                CONFIG_SETTING_PATH,  CONFIG_FIELD(video.shader_path),           0, CONFIG_DEF_EMPTY },
+   { "video_shader_enable",         CONFIG_SETTING_BOOL,  CONFIG_FIELD(video.shader_enable),         0, CONFIG_DEF(shader_enable) },
+   { "video_shader_dir",            CONFIG_SETTING_PATH,  CONFIG_FIELD(video.shader_dir),
+      CONFIG_SETTING_FLAG_DEFAULT_DIR, CONFIG_DEF_EMPTY },
+   { "video_allow_rotate",          CONFIG_SETTING_BOOL,  CONFIG_FIELD(video.allow_rotate),
+      CONFIG_SETTING_FLAG_NO_SAVE, CONFIG_DEF(allow_rotate) },
+   { "video_font_path",             CONFIG_SETTING_PATH,  CONFIG_FIELD(video.font_path),             0, CONFIG_DEF_NONE },
+   { "video_font_size",             CONFIG_SETTING_FLOAT, CONFIG_FIELD(video.font_size),             0, CONFIG_DEF(font_size) },
+   { "video_font_enable",           CONFIG_SETTING_BOOL,  CONFIG_FIELD(video.font_enable),           0, CONFIG_DEF(font_enable) },
+   { "video_message_pos_x",         CONFIG_SETTING_FLOAT, CONFIG_FIELD(video.msg_pos_x),             0, CONFIG_DEF(message_pos_offset_x) },
+   { "video_message_pos_y",         CONFIG_SETTING_FLOAT, CONFIG_FIELD(video.msg_pos_y),             0, CONFIG_DEF(message_pos_offset_y) },
+   { "video_rotation",              CONFIG_SETTING_UINT,  CONFIG_FIELD(video.rotation),              0, CONFIG_DEF_NONE },
+   { "video_force_srgb_disable",    CONFIG_SETTING_BOOL,  CONFIG_FIELD(video.force_srgb_disable),    0, CONFIG_DEF_NONE },
+   { "video_post_filter_record",    CONFIG_SETTING_BOOL,  CONFIG_FIELD(video.post_filter_record),
+      CONFIG_SETTING_FLAG_NO_SAVE, CONFIG_DEF(post_filter_record) },
+   { "video_gpu_record",            CONFIG_SETTING_BOOL,  CONFIG_FIELD(video.gpu_record),            0, CONFIG_DEF(gpu_record) },
+   { "video_gpu_screenshot",        CONFIG_SETTING_BOOL,  CONFIG_FIELD(video.gpu_screenshot),        0, CONFIG_DEF(gpu_screenshot) },
+   { "video_filter",                CONFIG_SETTING_PATH,  CONFIG_FIELD(video.softfilter_plugin),
+      CONFIG_SETTING_FLAG_SAVE_STRING, CONFIG_DEF_EMPTY },
+   { "video_filter_dir",            CONFIG_SETTING_PATH,  CONFIG_FIELD(video.filter_dir),
+      CONFIG_SETTING_FLAG_DEFAULT_DIR, CONFIG_DEF_EMPTY },
+   { "video_driver",                CONFIG_SETTING_ARRAY, CONFIG_FIELD(video.driver),                0, CONFIG_DEF_NONE },
+   { "video_context_driver",        CONFIG_SETTING_ARRAY, CONFIG_FIELD(video.context_driver),        0, CONFIG_DEF_NONE },
+   { "custom_viewport_width",       CONFIG_SETTING_UINT,  CONFIG_FIELD(video_viewport_custom.width), 0, CONFIG_DEF_NONE },
+   { "custom_viewport_height",      CONFIG_SETTING_UINT,  CONFIG_FIELD(video_viewport_custom.height),0, CONFIG_DEF_NONE },
+   { "custom_viewport_x",           CONFIG_SETTING_INT,   CONFIG_FIELD(video_viewport_custom.x),     0, CONFIG_DEF_NONE },
+   { "custom_viewport_y",           CONFIG_SETTING_INT,   CONFIG_FIELD(video_viewport_custom.y),     0, CONFIG_DEF_NONE },
+   { "state_slot",                  CONFIG_SETTING_INT,   CONFIG_FIELD(state_slot),                  0, CONFIG_DEF_NONE },
+   { "record_driver",               CONFIG_SETTING_ARRAY, CONFIG_FIELD(record.driver),               0, CONFIG_DEF_NONE },
+
+#ifdef HAVE_MENU
+#ifdef HAVE_THREADS
+   { "threaded_data_runloop_enable", CONFIG_SETTING_BOOL, CONFIG_FIELD(threaded_data_runloop_enable), 0, CONFIG_DEF_NONE },
+#endif
+   { "dpi_override_enable",         CONFIG_SETTING_BOOL,  CONFIG_FIELD(menu.dpi.override_enable),    0, CONFIG_DEF(menu_dpi_override_enable) },
+   { "dpi_override_value",          CONFIG_SETTING_UINT,  CONFIG_FIELD(menu.dpi.override_value),     0, CONFIG_DEF(menu_dpi_override_value) },
+   { "menu_driver",                 CONFIG_SETTING_ARRAY, CONFIG_FIELD(menu.driver),                 0, CONFIG_DEF_NONE },
+   { "menu_pause_libretro",         CONFIG_SETTING_BOOL,  CONFIG_FIELD(menu.pause_libretro),         0, CONFIG_DEF_NONE },
+   { "menu_mouse_enable",           CONFIG_SETTING_BOOL,  CONFIG_FIELD(menu.mouse.enable),           0, CONFIG_DEF_NONE },
+   { "menu_pointer_enable",         CONFIG_SETTING_BOOL,  CONFIG_FIELD(menu.pointer.enable),         0, CONFIG_DEF(pointer_enable) },
+   { "menu_timedate_enable",        CONFIG_SETTING_BOOL,  CONFIG_FIELD(menu.timedate_enable),        0, CONFIG_DEF_NONE },
+   { "menu_core_enable",            CONFIG_SETTING_BOOL,  CONFIG_FIELD(menu.core_enable),            0, CONFIG_DEF_NONE },
+   { "menu_dynamic_wallpaper_enable", CONFIG_SETTING_BOOL, CONFIG_FIELD(menu.dynamic_wallpaper_enable), 0, CONFIG_DEF_NONE },
+   { "menu_boxart_enable",          CONFIG_SETTING_BOOL,  CONFIG_FIELD(menu.boxart_enable),          0, CONFIG_DEF_NONE },
+   { "menu_navigation_wraparound_enable", CONFIG_SETTING_BOOL,
+      CONFIG_FIELD(menu.navigation.wraparound.enable), 0, CONFIG_DEF_NONE },
+   { "menu_navigation_browser_filter_supported_extensions_enable", CONFIG_SETTING_BOOL,
+      CONFIG_FIELD(menu.navigation.browser.filter.supported_extensions_enable), 0, CONFIG_DEF_NONE },
+   { "menu_show_advanced_settings", CONFIG_SETTING_BOOL,  CONFIG_FIELD(menu.show_advanced_settings), 0, CONFIG_DEF(show_advanced_settings) },
+   { "menu_entry_normal_color",     CONFIG_SETTING_HEX,   CONFIG_FIELD(menu.entry_normal_color),     0, CONFIG_DEF(menu_entry_normal_color) },
+   { "menu_entry_hover_color",      CONFIG_SETTING_HEX,   CONFIG_FIELD(menu.entry_hover_color),      0, CONFIG_DEF(menu_entry_hover_color) },
+   { "menu_title_color",            CONFIG_SETTING_HEX,   CONFIG_FIELD(menu.title_color),            0, CONFIG_DEF(menu_title_color) },
+   { "menu_wallpaper",              CONFIG_SETTING_PATH,  CONFIG_FIELD(menu.wallpaper),
+      CONFIG_SETTING_FLAG_LOAD_DEFAULT, CONFIG_DEF_EMPTY },
+   { "rgui_browser_directory",      CONFIG_SETTING_PATH,  CONFIG_FIELD(menu_content_directory),
+      CONFIG_SETTING_FLAG_DEFAULT_DIR, CONFIG_DEF_EMPTY },
+   { "rgui_config_directory",       CONFIG_SETTING_PATH,  CONFIG_FIELD(menu_config_directory),
+      CONFIG_SETTING_FLAG_DEFAULT_DIR, CONFIG_DEF_EMPTY },
+   { "rgui_show_start_screen",      CONFIG_SETTING_BOOL,  CONFIG_FIELD(menu_show_start_screen),      0, CONFIG_DEF_NONE },
+#endif
+
+   { "core_set_supports_no_game_enable", CONFIG_SETTING_BOOL, CONFIG_FIELD(core.set_supports_no_game_enable), 0, CONFIG_DEF_NONE },
+   { "ui_companion_start_on_boot",  CONFIG_SETTING_BOOL,  CONFIG_FIELD(ui.companion_start_on_boot),  0, CONFIG_DEF(ui_companion_start_on_boot) },
+   { "ui_menubar_enable",           CONFIG_SETTING_BOOL,  CONFIG_FIELD(ui.menubar_enable),           0, CONFIG_DEF_NONE },
+   { "suspend_screensaver_enable",  CONFIG_SETTING_BOOL,  CONFIG_FIELD(ui.suspend_screensaver_enable), 0, CONFIG_DEF_NONE },
+   { "fps_show",                    CONFIG_SETTING_BOOL,  CONFIG_FIELD(fps_show),                    0, CONFIG_DEF_NONE },
+   { "load_dummy_on_core_shutdown", CONFIG_SETTING_BOOL,  CONFIG_FIELD(load_dummy_on_core_shutdown), 0, CONFIG_DEF(load_dummy_on_core_shutdown) },
+   { "builtin_mediaplayer_enable",  CONFIG_SETTING_BOOL,  CONFIG_FIELD(multimedia.builtin_mediaplayer_enable), 0, CONFIG_DEF_NONE },
+   { "builtin_imageviewer_enable",  CONFIG_SETTING_BOOL,  CONFIG_FIELD(multimedia.builtin_imageviewer_enable), 0, CONFIG_DEF_NONE },
+   { "core_updater_buildbot_url",   CONFIG_SETTING_PATH,  CONFIG_FIELD(network.buildbot_url),
+      CONFIG_SETTING_FLAG_SAVE_STRING, CONFIG_DEF(buildbot_server_url) },
+   { "core_updater_buildbot_assets_url", CONFIG_SETTING_PATH, CONFIG_FIELD(network.buildbot_assets_url),
+      CONFIG_SETTING_FLAG_SAVE_STRING, CONFIG_DEF(buildbot_assets_server_url) },
+   { "core_updater_auto_extract_archive", CONFIG_SETTING_BOOL, CONFIG_FIELD(network.buildbot_auto_extract_archive), 0, CONFIG_DEF_NONE },
+
+   { "back_as_menu_toggle_enable",  CONFIG_SETTING_BOOL,  CONFIG_FIELD(input.back_as_menu_toggle_enable), 0, CONFIG_DEF_NONE },
+   { "input_remap_binds_enable",    CONFIG_SETTING_BOOL,  CONFIG_FIELD(input.remap_binds_enable),    0, CONFIG_DEF_NONE },
+   { "input_axis_threshold",        CONFIG_SETTING_FLOAT, CONFIG_FIELD(input.axis_threshold),        0, CONFIG_DEF(axis_threshold) },
+   { "netplay_client_swap_input",   CONFIG_SETTING_BOOL,  CONFIG_FIELD(input.netplay_client_swap_input), 0, CONFIG_DEF(netplay_client_swap_input) },
+   { "input_max_users",             CONFIG_SETTING_UINT,  CONFIG_FIELD(input.max_users),             0, CONFIG_DEF(input_max_users) },
+   { "input_menu_toggle_gamepad_combo", CONFIG_SETTING_UINT, CONFIG_FIELD(input.menu_toggle_gamepad_combo), 0, CONFIG_DEF(menu_toggle_gamepad_combo) },
+   { "input_descriptor_label_show", CONFIG_SETTING_BOOL,  CONFIG_FIELD(input.input_descriptor_label_show), 0, CONFIG_DEF(input_descriptor_label_show) },
+   { "input_descriptor_hide_unbound", CONFIG_SETTING_BOOL, CONFIG_FIELD(input.input_descriptor_hide_unbound), 0, CONFIG_DEF(input_descriptor_hide_unbound) },
+   { "input_driver",                CONFIG_SETTING_ARRAY, CONFIG_FIELD(input.driver),                0, CONFIG_DEF_NONE },
+   { "input_joypad_driver",         CONFIG_SETTING_ARRAY, CONFIG_FIELD(input.joypad_driver),         0, CONFIG_DEF_NONE },
+   { "input_keyboard_layout",       CONFIG_SETTING_ARRAY, CONFIG_FIELD(input.keyboard_layout),       0, CONFIG_DEF_EMPTY },
+   { "input_turbo_period",          CONFIG_SETTING_UINT,  CONFIG_FIELD(input.turbo_period),          0, CONFIG_DEF(turbo_period) },
+   { "input_duty_cycle",            CONFIG_SETTING_UINT,  CONFIG_FIELD(input.turbo_duty_cycle),      0, CONFIG_DEF(turbo_duty_cycle) },
+   { "input_autodetect_enable",     CONFIG_SETTING_BOOL,  CONFIG_FIELD(input.autodetect_enable),     0, CONFIG_DEF(input_autodetect_enable) },
+   { "joypad_autoconfig_dir",       CONFIG_SETTING_PATH,  CONFIG_FIELD(input.autoconfig_dir),        0, CONFIG_DEF_EMPTY },
+   { "input_remapping_path",        CONFIG_SETTING_PATH,  CONFIG_FIELD(input.remapping_path),        0, CONFIG_DEF_NONE },
+#if TARGET_OS_IPHONE
+   { "small_keyboard_enable",       CONFIG_SETTING_BOOL,  CONFIG_FIELD(input.small_keyboard_enable), 0, CONFIG_DEF_NONE },
+#endif
+   { "keyboard_gamepad_enable",     CONFIG_SETTING_BOOL,  CONFIG_FIELD(input.keyboard_gamepad_enable), 0, CONFIG_DEF_NONE },
+   { "keyboard_gamepad_mapping_type", CONFIG_SETTING_UINT, CONFIG_FIELD(input.keyboard_gamepad_mapping_type), 0, CONFIG_DEF_NONE },
+#ifdef HAVE_OVERLAY
+   { "overlay_directory",           CONFIG_SETTING_PATH,  CONFIG_FIELD(overlay_directory),
+      CONFIG_SETTING_FLAG_DEFAULT_DIR, CONFIG_DEF_NONE },
+   { "input_overlay",               CONFIG_SETTING_PATH,  CONFIG_FIELD(input.overlay),               0, CONFIG_DEF_NONE },
+   { "input_overlay_enable",        CONFIG_SETTING_BOOL,  CONFIG_FIELD(input.overlay_enable),        0, CONFIG_DEF_NONE },
+   { "input_overlay_enable_autopreferred", CONFIG_SETTING_BOOL, CONFIG_FIELD(input.overlay_enable_autopreferred), 0, CONFIG_DEF_NONE },
+   { "input_overlay_hide_in_menu",  CONFIG_SETTING_BOOL,  CONFIG_FIELD(input.overlay_hide_in_menu),  0, CONFIG_DEF_NONE },
+   { "input_overlay_opacity",       CONFIG_SETTING_FLOAT, CONFIG_FIELD(input.overlay_opacity),       0, CONFIG_DEF_NONE },
+   { "input_overlay_scale",         CONFIG_SETTING_FLOAT, CONFIG_FIELD(input.overlay_scale),         0, CONFIG_DEF_NONE },
+   { "input_osk_overlay",           CONFIG_SETTING_PATH,  CONFIG_FIELD(osk.overlay),                 0, CONFIG_DEF_NONE },
+   { "input_osk_overlay_enable",    CONFIG_SETTING_BOOL,  CONFIG_FIELD(osk.enable),                  0, CONFIG_DEF_NONE },
+#endif
+
+   { "audio_enable",                CONFIG_SETTING_BOOL,  CONFIG_FIELD(audio.enable),                0, CONFIG_DEF(audio_enable) },
+   { "audio_mute_enable",           CONFIG_SETTING_BOOL,  CONFIG_FIELD(audio.mute_enable),           0, CONFIG_DEF_NONE },
+   { "audio_out_rate",              CONFIG_SETTING_UINT,  CONFIG_FIELD(audio.out_rate),              0, CONFIG_DEF(out_rate) },
+   { "audio_block_frames",          CONFIG_SETTING_UINT,  CONFIG_FIELD(audio.block_frames),          0, CONFIG_DEF_NONE },
+   { "audio_device",                CONFIG_SETTING_ARRAY, CONFIG_FIELD(audio.device),                0, CONFIG_DEF_NONE },
+   { "audio_latency",               CONFIG_SETTING_UINT,  CONFIG_FIELD(audio.latency),               0, CONFIG_DEF_NONE },
+   { "audio_sync",                  CONFIG_SETTING_BOOL,  CONFIG_FIELD(audio.sync),                  0, CONFIG_DEF(audio_sync) },
+   { "audio_rate_control",          CONFIG_SETTING_BOOL,  CONFIG_FIELD(audio.rate_control),          0, CONFIG_DEF(rate_control) },
+   { "audio_rate_control_delta",    CONFIG_SETTING_FLOAT, CONFIG_FIELD(audio.rate_control_delta),    0, CONFIG_DEF(rate_control_delta) },
+   { "audio_max_timing_skew",       CONFIG_SETTING_FLOAT, CONFIG_FIELD(audio.max_timing_skew),       0, CONFIG_DEF(max_timing_skew) },
+   { "audio_volume",                CONFIG_SETTING_FLOAT, CONFIG_FIELD(audio.volume),                0, CONFIG_DEF(audio_volume) },
+   { "audio_resampler",             CONFIG_SETTING_ARRAY, CONFIG_FIELD(audio.resampler),             0, CONFIG_DEF_NONE },
+   { "audio_driver",                CONFIG_SETTING_ARRAY, CONFIG_FIELD(audio.driver),                0, CONFIG_DEF_NONE },
+   { "audio_dsp_plugin",            CONFIG_SETTING_PATH,  CONFIG_FIELD(audio.dsp_plugin),
+      CONFIG_SETTING_FLAG_SAVE_STRING, CONFIG_DEF_EMPTY },
+   { "audio_filter_dir",            CONFIG_SETTING_PATH,  CONFIG_FIELD(audio.filter_dir),
+      CONFIG_SETTING_FLAG_DEFAULT_DIR, CONFIG_DEF_EMPTY },
+
+   { "camera_driver",               CONFIG_SETTING_ARRAY, CONFIG_FIELD(camera.driver),               0, CONFIG_DEF_NONE },
+   { "camera_device",               CONFIG_SETTING_ARRAY, CONFIG_FIELD(camera.device),               0, CONFIG_DEF_NONE },
+   { "camera_allow",                CONFIG_SETTING_BOOL,  CONFIG_FIELD(camera.allow),                0, CONFIG_DEF_NONE },
+   { "location_driver",             CONFIG_SETTING_ARRAY, CONFIG_FIELD(location.driver),             0, CONFIG_DEF_NONE },
+   { "location_allow",              CONFIG_SETTING_BOOL,  CONFIG_FIELD(location.allow),              0, CONFIG_DEF_NONE },
+#ifdef HAVE_CHEEVOS
+   { "cheevos_enable",              CONFIG_SETTING_BOOL,  CONFIG_FIELD(cheevos.enable),              0, CONFIG_DEF_NONE },
+   { "cheevos_test_unofficial",     CONFIG_SETTING_BOOL,  CONFIG_FIELD(cheevos.test_unofficial),     0, CONFIG_DEF_NONE },
+   { "cheevos_username",            CONFIG_SETTING_ARRAY, CONFIG_FIELD(cheevos.username),            0, CONFIG_DEF_EMPTY },
+   { "cheevos_password",            CONFIG_SETTING_ARRAY, CONFIG_FIELD(cheevos.password),            0, CONFIG_DEF_EMPTY },
+#endif
+
+   { "playlist_names",              CONFIG_SETTING_ARRAY, CONFIG_FIELD(playlist_names),              0, CONFIG_DEF_EMPTY },
+   { "playlist_cores",              CONFIG_SETTING_ARRAY, CONFIG_FIELD(playlist_cores),              0, CONFIG_DEF_EMPTY },
+   { "libretro_info_path",          CONFIG_SETTING_PATH,  CONFIG_FIELD(libretro_info_path),          0, CONFIG_DEF_EMPTY },
+   { "core_options_path",           CONFIG_SETTING_PATH,  CONFIG_FIELD(core_options_path),           0, CONFIG_DEF_EMPTY },
+   { "screenshot_directory",        CONFIG_SETTING_PATH,  CONFIG_FIELD(screenshot_directory),
+      CONFIG_SETTING_FLAG_DEFAULT_DIR, CONFIG_DEF_EMPTY },
+   { "resampler_directory",         CONFIG_SETTING_PATH,  CONFIG_FIELD(resampler_directory),         0, CONFIG_DEF_EMPTY },
+   { "cache_directory",             CONFIG_SETTING_PATH,  CONFIG_FIELD(cache_directory),             0, CONFIG_DEF_EMPTY },
+   { "input_remapping_directory",   CONFIG_SETTING_PATH,  CONFIG_FIELD(input_remapping_directory),   0, CONFIG_DEF_EMPTY },
+   { "core_assets_directory",       CONFIG_SETTING_PATH,  CONFIG_FIELD(core_assets_directory),
+      CONFIG_SETTING_FLAG_DEFAULT_DIR, CONFIG_DEF_EMPTY },
+   { "assets_directory",            CONFIG_SETTING_PATH,  CONFIG_FIELD(assets_directory),
+      CONFIG_SETTING_FLAG_DEFAULT_DIR, CONFIG_DEF_EMPTY },
+   { "dynamic_wallpapers_directory", CONFIG_SETTING_PATH, CONFIG_FIELD(dynamic_wallpapers_directory),
+      CONFIG_SETTING_FLAG_DEFAULT_DIR, CONFIG_DEF_EMPTY },
+   { "boxarts_directory",           CONFIG_SETTING_PATH,  CONFIG_FIELD(boxarts_directory),
+      CONFIG_SETTING_FLAG_DEFAULT_DIR, CONFIG_DEF_EMPTY },
+   { "playlist_directory",          CONFIG_SETTING_PATH,  CONFIG_FIELD(playlist_directory),
+      CONFIG_SETTING_FLAG_DEFAULT_DIR, CONFIG_DEF_EMPTY },
+   { "content_database_path",       CONFIG_SETTING_PATH,  CONFIG_FIELD(content_database),            0, CONFIG_DEF_EMPTY },
+   { "cheat_database_path",         CONFIG_SETTING_PATH,  CONFIG_FIELD(cheat_database),              0, CONFIG_DEF_EMPTY },
+   { "cursor_directory",            CONFIG_SETTING_PATH,  CONFIG_FIELD(cursor_directory),            0, CONFIG_DEF_EMPTY },
+   { "cheat_settings_path",         CONFIG_SETTING_PATH,  CONFIG_FIELD(cheat_settings_path),
+      CONFIG_SETTING_FLAG_NO_SAVE, CONFIG_DEF_EMPTY },
+   { "content_history_dir",         CONFIG_SETTING_PATH,  CONFIG_FIELD(content_history_directory),   0, CONFIG_DEF_EMPTY },
+   { "content_history_path",        CONFIG_SETTING_PATH,  CONFIG_FIELD(content_history_path),        0, CONFIG_DEF_EMPTY },
+   { "content_history_size",        CONFIG_SETTING_UINT,  CONFIG_FIELD(content_history_size),        0, CONFIG_DEF(default_content_history_size) },
+   { "history_list_enable",         CONFIG_SETTING_BOOL,  CONFIG_FIELD(history_list_enable),         0, CONFIG_DEF(def_history_list_enable) },
+
+   { "libretro_log_level",          CONFIG_SETTING_UINT,  CONFIG_FIELD(libretro_log_level),          0, CONFIG_DEF(libretro_log_level) },
+   { "frontend_log_level",          CONFIG_SETTING_UINT,  CONFIG_FIELD(frontend_log_level),          0, CONFIG_DEF(frontend_log_level) },
+   { "perfcnt_reset_interval",      CONFIG_SETTING_UINT,  CONFIG_FIELD(perfcnt_reset_interval),      0, CONFIG_DEF(perfcnt_reset_interval) },
+   { "perfcnt_hw_enable",           CONFIG_SETTING_BOOL,  CONFIG_FIELD(perfcnt_hw_enable),           0, CONFIG_DEF(perfcnt_hw_enable) },
+   { "perf_trace_frames",           CONFIG_SETTING_UINT,  CONFIG_FIELD(perf_trace_frames),           0, CONFIG_DEF(perf_trace_frames) },
+   { "perf_trace_start_frame",      CONFIG_SETTING_UINT,  CONFIG_FIELD(perf_trace_start_frame),      0, CONFIG_DEF(perf_trace_start_frame) },
+   { "perf_trace_path",             CONFIG_SETTING_PATH,  CONFIG_FIELD(perf_trace_path),             0, CONFIG_DEF_EMPTY },
+   { "benchmark_width",             CONFIG_SETTING_UINT,  CONFIG_FIELD(benchmark.width),             0, CONFIG_DEF(benchmark_width) },
+   { "benchmark_height",            CONFIG_SETTING_UINT,  CONFIG_FIELD(benchmark.height),            0, CONFIG_DEF(benchmark_height) },
+   { "benchmark_pixel_format",      CONFIG_SETTING_ARRAY, CONFIG_FIELD(benchmark.pixel_format),      0, CONFIG_DEF(benchmark_pixel_format) },
+   { "benchmark_audio_batch",       CONFIG_SETTING_UINT,  CONFIG_FIELD(benchmark.audio_batch),       0, CONFIG_DEF(benchmark_audio_batch) },
+   { "benchmark_serialize_size",    CONFIG_SETTING_UINT,  CONFIG_FIELD(benchmark.serialize_size),    0, CONFIG_DEF(benchmark_serialize_size) },
+   { "benchmark_dirty_ratio",       CONFIG_SETTING_FLOAT, CONFIG_FIELD(benchmark.dirty_ratio),       0, CONFIG_DEF(benchmark_dirty_ratio) },
+   { "benchmark_sram_size",         CONFIG_SETTING_UINT,  CONFIG_FIELD(benchmark.sram_size),         0, CONFIG_DEF(benchmark_sram_size) },
+   { "benchmark_memory_map",        CONFIG_SETTING_ARRAY, CONFIG_FIELD(benchmark.memory_map),        0, CONFIG_DEF_EMPTY },
+   { "rewind_enable",               CONFIG_SETTING_BOOL,  CONFIG_FIELD(rewind_enable),               0, CONFIG_DEF(rewind_enable) },
+   { "rewind_granularity",          CONFIG_SETTING_UINT,  CONFIG_FIELD(rewind_granularity),          0, CONFIG_DEF(rewind_granularity) },
+   { "bundle_assets_extract_enable", CONFIG_SETTING_BOOL, CONFIG_FIELD(bundle_assets_extract_enable), 0, CONFIG_DEF(bundle_assets_extract_enable) },
+   { "bundle_assets_extract_version_current", CONFIG_SETTING_UINT, CONFIG_FIELD(bundle_assets_extract_version_current), 0, CONFIG_DEF_NONE },
+   { "bundle_assets_extract_last_version", CONFIG_SETTING_UINT, CONFIG_FIELD(bundle_assets_extract_last_version), 0, CONFIG_DEF_NONE },
+   { "bundle_assets_src_path",      CONFIG_SETTING_ARRAY, CONFIG_FIELD(bundle_assets_src_path),      0, CONFIG_DEF_NONE },
+   { "bundle_assets_dst_path",      CONFIG_SETTING_ARRAY, CONFIG_FIELD(bundle_assets_dst_path),      0, CONFIG_DEF_NONE },
+   { "bundle_assets_dst_path_subdir", CONFIG_SETTING_ARRAY, CONFIG_FIELD(bundle_assets_dst_path_subdir), 0, CONFIG_DEF_NONE },
+   { "slowmotion_ratio",            CONFIG_SETTING_FLOAT, CONFIG_FIELD(slowmotion_ratio),            0, CONFIG_DEF(slowmotion_ratio) },
+   { "fastforward_ratio",           CONFIG_SETTING_FLOAT, CONFIG_FIELD(fastforward_ratio),           0, CONFIG_DEF(fastforward_ratio) },
+   { "pause_nonactive",             CONFIG_SETTING_BOOL,  CONFIG_FIELD(pause_nonactive),             0, CONFIG_DEF(pause_nonactive) },
+   { "autosave_interval",           CONFIG_SETTING_UINT,  CONFIG_FIELD(autosave_interval),           0, CONFIG_DEF(autosave_interval) },
+   { "block_sram_overwrite",        CONFIG_SETTING_BOOL,  CONFIG_FIELD(block_sram_overwrite),        0, CONFIG_DEF(block_sram_overwrite) },
+   { "savestate_auto_index",        CONFIG_SETTING_BOOL,  CONFIG_FIELD(savestate_auto_index),        0, CONFIG_DEF(savestate_auto_index) },
+   { "savestate_auto_save",         CONFIG_SETTING_BOOL,  CONFIG_FIELD(savestate_auto_save),         0, CONFIG_DEF(savestate_auto_save) },
+   { "savestate_auto_load",         CONFIG_SETTING_BOOL,  CONFIG_FIELD(savestate_auto_load),         0, CONFIG_DEF(savestate_auto_load) },
+#ifdef HAVE_COMMAND
+   { "network_cmd_enable",          CONFIG_SETTING_BOOL,  CONFIG_FIELD(network_cmd_enable),          0, CONFIG_DEF_NONE },
+   { "network_cmd_port",            CONFIG_SETTING_UINT,  CONFIG_FIELD(network_cmd_port),            0, CONFIG_DEF_NONE },
+   { "stdin_cmd_enable",            CONFIG_SETTING_BOOL,  CONFIG_FIELD(stdin_cmd_enable),            0, CONFIG_DEF_NONE },
+#endif
+#ifdef HAVE_NETWORK_GAMEPAD
+   { "network_remote_enable",       CONFIG_SETTING_BOOL,  CONFIG_FIELD(network_remote_enable),       0, CONFIG_DEF_NONE },
+   { "network_remote_base_port",    CONFIG_SETTING_UINT,  CONFIG_FIELD(network_remote_base_port),    0, CONFIG_DEF_NONE },
+#endif
+   { "debug_panel_enable",          CONFIG_SETTING_BOOL,  CONFIG_FIELD(debug_panel_enable),
+      CONFIG_SETTING_FLAG_NO_SAVE, CONFIG_DEF_NONE },
+   { "user_language",               CONFIG_SETTING_UINT,  CONFIG_FIELD(user_language),               0, CONFIG_DEF(def_user_language) },
+   { "config_save_on_exit",         CONFIG_SETTING_BOOL,  CONFIG_FIELD(config_save_on_exit),         0, CONFIG_DEF(config_save_on_exit) },
+   { "core_specific_config",        CONFIG_SETTING_BOOL,  CONFIG_FIELD(core_specific_config),        0, CONFIG_DEF(default_core_specific_config) },
+   { "game_specific_options",       CONFIG_SETTING_BOOL,  CONFIG_FIELD(game_specific_options),       0, CONFIG_DEF(default_game_specific_options) },
+   { "auto_overrides_enable",       CONFIG_SETTING_BOOL,  CONFIG_FIELD(auto_overrides_enable),       0, CONFIG_DEF(default_auto_overrides_enable) },
+   { "auto_remaps_enable",          CONFIG_SETTING_BOOL,  CONFIG_FIELD(auto_remaps_enable),          0, CONFIG_DEF(default_auto_remaps_enable) },
+   { "sort_savefiles_enable",       CONFIG_SETTING_BOOL,  CONFIG_FIELD(sort_savefiles_enable),       0, CONFIG_DEF(default_sort_savefiles_enable) },
+   { "sort_savestates_enable",      CONFIG_SETTING_BOOL,  CONFIG_FIELD(sort_savestates_enable),      0, CONFIG_DEF(default_sort_savestates_enable) },
+   { "menu_ok_btn",                 CONFIG_SETTING_UINT,  CONFIG_FIELD(menu_ok_btn),                 0, CONFIG_DEF(default_menu_btn_ok) },
+   { "menu_cancel_btn",             CONFIG_SETTING_UINT,  CONFIG_FIELD(menu_cancel_btn),             0, CONFIG_DEF(default_menu_btn_cancel) },
+   { "menu_search_btn",             CONFIG_SETTING_UINT,  CONFIG_FIELD(menu_search_btn),             0, CONFIG_DEF(default_menu_btn_search) },
+   { "menu_info_btn",               CONFIG_SETTING_UINT,  CONFIG_FIELD(menu_info_btn),               0, CONFIG_DEF(default_menu_btn_info) },
+   { "menu_default_btn",            CONFIG_SETTING_UINT,  CONFIG_FIELD(menu_default_btn),            0, CONFIG_DEF(default_menu_btn_default) },
+   { "menu_scroll_down_btn",        CONFIG_SETTING_UINT,  CONFIG_FIELD(menu_scroll_down_btn),        0, CONFIG_DEF(default_menu_btn_scroll_down) },
+   { "menu_scroll_up_btn",          CONFIG_SETTING_UINT,  CONFIG_FIELD(menu_scroll_up_btn),          0, CONFIG_DEF(default_menu_btn_scroll_up) },
+};
+
+struct config_setting_subsystems
+{
+   const char *key;
+   unsigned subsystems;
+};
+
+/* Settings that are only picked up when a subsystem starts.
+ * Anything not listed here is read on the fly. */
+static const struct config_setting_subsystems config_setting_subsystems[] = {
+   { "video_driver",                        CONFIG_SUBSYSTEM_VIDEO },
+   { "video_context_driver",                CONFIG_SUBSYSTEM_VIDEO },
+   { "video_fullscreen",                    CONFIG_SUBSYSTEM_VIDEO },
+   { "video_fullscreen_x",                  CONFIG_SUBSYSTEM_VIDEO },
+   { "video_fullscreen_y",                  CONFIG_SUBSYSTEM_VIDEO },
+   { "video_windowed_fullscreen",           CONFIG_SUBSYSTEM_VIDEO },
+   { "video_scale",                         CONFIG_SUBSYSTEM_VIDEO },
+   { "video_monitor_index",                 CONFIG_SUBSYSTEM_VIDEO },
+   { "video_disable_composition",           CONFIG_SUBSYSTEM_VIDEO },
+   { "video_threaded",                      CONFIG_SUBSYSTEM_VIDEO },
+   { "video_shared_context",                CONFIG_SUBSYSTEM_VIDEO },
+   { "video_viwidth",                       CONFIG_SUBSYSTEM_VIDEO },
+   { "video_vfilter",                       CONFIG_SUBSYSTEM_VIDEO },
+   { "video_smooth",                        CONFIG_SUBSYSTEM_VIDEO },
+   { "video_force_srgb_disable",            CONFIG_SUBSYSTEM_VIDEO },
+   { "video_filter",                        CONFIG_SUBSYSTEM_VIDEO },
+   { "video_font_path",                     CONFIG_SUBSYSTEM_VIDEO },
+   { "video_font_size",                     CONFIG_SUBSYSTEM_VIDEO },
+   { "video_font_enable",                   CONFIG_SUBSYSTEM_VIDEO },
+   { "input_driver",                        CONFIG_SUBSYSTEM_INPUT },
+   { "input_joypad_driver",                 CONFIG_SUBSYSTEM_INPUT },
+   { "input_keyboard_layout",               CONFIG_SUBSYSTEM_INPUT },
+   { "input_autodetect_enable",             CONFIG_SUBSYSTEM_INPUT },
+   { "menu_driver",                         CONFIG_SUBSYSTEM_MENU },
+   { "menu_wallpaper",                      CONFIG_SUBSYSTEM_MENU },
+   { "menu_dynamic_wallpaper_enable",       CONFIG_SUBSYSTEM_MENU },
+   { "dpi_override_enable",                 CONFIG_SUBSYSTEM_MENU },
+   { "dpi_override_value",                  CONFIG_SUBSYSTEM_MENU },
+   { "audio_driver",                        CONFIG_SUBSYSTEM_AUDIO },
+   { "audio_enable",                        CONFIG_SUBSYSTEM_AUDIO },
+   { "audio_device",                        CONFIG_SUBSYSTEM_AUDIO },
+   { "audio_out_rate",                      CONFIG_SUBSYSTEM_AUDIO },
+   { "audio_block_frames",                  CONFIG_SUBSYSTEM_AUDIO },
+   { "audio_latency",                       CONFIG_SUBSYSTEM_AUDIO },
+   { "audio_resampler",                     CONFIG_SUBSYSTEM_AUDIO },
+   { "audio_dsp_plugin",                    CONFIG_SUBSYSTEM_DSP_FILTER },
+   { "camera_driver",                       CONFIG_SUBSYSTEM_CAMERA },
+   { "camera_device",                       CONFIG_SUBSYSTEM_CAMERA },
+   { "camera_allow",                        CONFIG_SUBSYSTEM_CAMERA },
+   { "location_driver",                     CONFIG_SUBSYSTEM_LOCATION },
+   { "location_allow",                      CONFIG_SUBSYSTEM_LOCATION },
+   { "input_overlay",                       CONFIG_SUBSYSTEM_OVERLAY },
+   { "input_overlay_enable",                CONFIG_SUBSYSTEM_OVERLAY },
+   { "input_overlay_enable_autopreferred",  CONFIG_SUBSYSTEM_OVERLAY },
+   { "input_osk_overlay",                   CONFIG_SUBSYSTEM_OVERLAY },
+   { "input_osk_overlay_enable",            CONFIG_SUBSYSTEM_OVERLAY },
+   { "rewind_enable",                       CONFIG_SUBSYSTEM_REWIND },
+   { "rewind_buffer_size",                  CONFIG_SUBSYSTEM_REWIND },
+   { "autosave_interval",                   CONFIG_SUBSYSTEM_AUTOSAVE },
+};
+
+/**
+ * config_get_subsystems:
+ * @key             : Config key of a setting.
+ *
+ * Gets the subsystems that have to be restarted before a
+ * new value of @key takes effect. Settings which are read
+ * on the fly map to CONFIG_SUBSYSTEM_NONE.
+ *
+ * Returns: bitmask of enum config_subsystem.
+ **/
+unsigned config_get_subsystems(const char *key)
+{
+   size_t i;
+
+   if (!key)
+      return CONFIG_SUBSYSTEM_NONE;
+
+   for (i = 0; i < ARRAY_SIZE(config_setting_subsystems); i++)
+      if (!strcmp(config_setting_subsystems[i].key, key))
+         return config_setting_subsystems[i].subsystems;
+
+   return CONFIG_SUBSYSTEM_NONE;
+}
+
+/* Hash index over the entries of a config file, so every
+ * lookup costs one probe instead of a walk over all entries. */
+typedef struct config_index
+{
+   config_file_t *conf;
+   struct config_entry_list **slots;
+   uint32_t *hashes;
+   size_t mask;
+   /* Set once config_index_set() changed or added a value. */
+   bool dirty;
+} config_index_t;
+
+static void config_index_init(config_index_t *idx, config_file_t *conf)
+{
+   size_t count                   = 0;
+   size_t cap                     = 64;
+   struct config_entry_list *list = NULL;
+
+   memset(idx, 0, sizeof(*idx));
+   idx->conf = conf;
+
+   for (list = conf->entries; list; list = list->next)
+      count++;
+   while (cap < count * 2)
+      cap <<= 1;
+
+   idx->slots  = (struct config_entry_list**)calloc(cap, sizeof(*idx->slots));
+   idx->hashes = (uint32_t*)calloc(cap, sizeof(*idx->hashes));
+
+   if (!idx->slots || !idx->hashes)
+   {
+      /* Lookups fall back to walking the entries. */
+      free(idx->slots);
+      free(idx->hashes);
+      idx->slots  = NULL;
+      idx->hashes = NULL;
+      return;
+   }
+
+   idx->mask = cap - 1;
+
+   for (list = conf->entries; list; list = list->next)
+   {
+      uint32_t hash = msg_hash_calculate(list->key);
+      size_t i      = hash & idx->mask;
+
+      /* The first entry of a key wins, as with config_get_*(). */
+      while (idx->slots[i])
+      {
+         if (idx->hashes[i] == hash && !strcmp(idx->slots[i]->key, list->key))
+            break;
+         i = (i + 1) & idx->mask;
+      }
+
+      if (idx->slots[i])
+         continue;
+
+      idx->slots[i]  = list;
+      idx->hashes[i] = hash;
+   }
+}
+
+static struct config_entry_list *config_index_find(
+      const config_index_t *idx, const char *key)
+{
+   uint32_t hash;
+   size_t i;
+
+   if (!idx->slots)
+   {
+      struct config_entry_list *list = NULL;
+
+      for (list = idx->conf->entries; list; list = list->next)
+         if (!strcmp(list->key, key))
+            return list;
+      return NULL;
+   }
+
+   hash = msg_hash_calculate(key);
+
+   for (i = hash & idx->mask; idx->slots[i]; i = (i + 1) & idx->mask)
+   {
+      if (idx->hashes[i] == hash && !strcmp(idx->slots[i]->key, key))
+         return idx->slots[i];
+   }
+
+   return NULL;
+}
+
+/**
+ * config_index_set:
+ * @idx             : Index of the config file.
+ * @key             : Key to set.
+ * @value           : New value.
+ *
+ * Same as config_set_string(), but finds existing
+ * entries through @idx. Setting a key to the value
+ * it already holds leaves the entry alone, anything
+ * else marks @idx as dirty.
+ **/
+static void config_index_set(config_index_t *idx,
+      const char *key, const char *value)
+{
+   struct config_entry_list *entry = config_index_find(idx, key);
+
+   if (entry && entry->value && !strcmp(entry->value, value))
+      return;
+
+   idx->dirty = true;
+
+   if (entry && !entry->readonly)
+   {
+      char *val = strdup(value);
+
+      if (val)
+      {
+         free(entry->value);
+         entry->value = val;
+         return;
+      }
+   }
+
+   config_set_string(idx->conf, key, value);
+}
+
+static void config_index_free(config_index_t *idx)
+{
+   free(idx->slots);
+   free(idx->hashes);
+   idx->slots  = NULL;
+   idx->hashes = NULL;
+}
+
+static int64_t config_setting_get_int(const void *ptr, size_t size)
+{
+   switch (size)
+   {
+      case sizeof(uint8_t):
+         return *(const uint8_t*)ptr;
+      case sizeof(uint16_t):
+         return *(const uint16_t*)ptr;
+      case sizeof(int32_t):
+         return *(const int32_t*)ptr;
+      case sizeof(int64_t):
+         return *(const int64_t*)ptr;
+   }
+
+   return 0;
+}
+
+static uint64_t config_setting_get_uint(const void *ptr, size_t size)
+{
+   switch (size)
+   {
+      case sizeof(uint8_t):
+         return *(const uint8_t*)ptr;
+      case sizeof(uint16_t):
+         return *(const uint16_t*)ptr;
+      case sizeof(uint32_t):
+         return *(const uint32_t*)ptr;
+      case sizeof(uint64_t):
+         return *(const uint64_t*)ptr;
+   }
+
+   return 0;
+}
+
+static void config_setting_set_int(void *ptr, size_t size, int64_t val)
+{
+   switch (size)
+   {
+      case sizeof(uint8_t):
+         *(uint8_t*)ptr  = (uint8_t)val;
+         break;
+      case sizeof(uint16_t):
+         *(uint16_t*)ptr = (uint16_t)val;
+         break;
+      case sizeof(int32_t):
+         *(int32_t*)ptr  = (int32_t)val;
+         break;
+      case sizeof(int64_t):
+         *(int64_t*)ptr  = val;
+         break;
+   }
+}
+
+/**
+ * config_settings_set_defaults:
+ * @settings        : Settings to reset.
+ *
+ * Resets every table setting that has a default in config.def.h.
+ **/
+static void config_settings_set_defaults(settings_t *settings)
+{
+   unsigned i;
+
+   for (i = 0; i < ARRAY_SIZE(config_settings); i++)
+   {
+      const struct config_setting *s = &config_settings[i];
+      uint8_t *ptr                   = (uint8_t*)settings + s->offset;
+
+      if (!s->def)
+         continue;
+
+      switch (s->type)
+      {
+         case CONFIG_SETTING_BOOL:
+            *(bool*)ptr = *(const bool*)s->def;
+            break;
+         case CONFIG_SETTING_INT:
+            config_setting_set_int(ptr, s->size,
+                  config_setting_get_int(s->def, s->def_size));
+            break;
+         case CONFIG_SETTING_UINT:
+         case CONFIG_SETTING_HEX:
+            config_setting_set_int(ptr, s->size,
+                  (int64_t)config_setting_get_uint(s->def, s->def_size));
+            break;
+         case CONFIG_SETTING_FLOAT:
+            *(float*)ptr = *(const float*)s->def;
+            break;
+         case CONFIG_SETTING_ARRAY:
+         case CONFIG_SETTING_PATH:
+            strlcpy((char*)ptr, (const char*)s->def, s->size);
+            break;
+      }
+   }
+}
+
+/**
+ * config_setting_parse:
+ * @type            : Type of the setting.
+ * @value           : Value from the config file.
+ * @ptr             : Variable to store the value in.
+ * @size            : Size of @ptr.
+ *
+ * Parses @value with the same rules as the config_get_*() functions.
+ *
+ * Returns: true (1) if @value was valid and stored, otherwise false (0).
+ **/
+static bool config_setting_parse(enum config_setting_type type,
+      const char *value, void *ptr, size_t size)
+{
+   switch (type)
+   {
+      case CONFIG_SETTING_BOOL:
+         if (!strcasecmp(value, "true") || !strcasecmp(value, "1"))
+            *(bool*)ptr = true;
+         else if (!strcasecmp(value, "false") || !strcasecmp(value, "0"))
+            *(bool*)ptr = false;
+         else
+            return false;
+         break;
+      case CONFIG_SETTING_INT:
+         {
+            int val;
+
+            errno = 0;
+            val   = strtol(value, NULL, 0);
+            if (errno != 0)
+               return false;
+            config_setting_set_int(ptr, size, val);
+         }
+         break;
+      case CONFIG_SETTING_UINT:
+         {
+            unsigned long val;
+
+            errno = 0;
+            val   = strtoul(value, NULL, 0);
+            if (errno != 0)
+               return false;
+            config_setting_set_int(ptr, size, (int64_t)val);
+         }
+         break;
+      case CONFIG_SETTING_HEX:
+         {
+            unsigned val;
+
+            errno = 0;
+            val   = strtoul(value, NULL, 16);
+            if (errno != 0)
+               return false;
+            config_setting_set_int(ptr, size, val);
+         }
+         break;
+      case CONFIG_SETTING_FLOAT:
+         *(float*)ptr = (float)strtod(value, NULL);
+         break;
+      case CONFIG_SETTING_ARRAY:
+         strlcpy((char*)ptr, value, size);
+         break;
+      case CONFIG_SETTING_PATH:
+         fill_pathname_expand_special((char*)ptr, value, size);
+         break;
+   }
+
+   return true;
+}
+
+static bool config_index_get(const config_index_t *idx, const char *key,
+      enum config_setting_type type, void *ptr, size_t size)
+{
+   const struct config_entry_list *entry = config_index_find(idx, key);
+
+   if (!entry)
+      return false;
+   return config_setting_parse(type, entry->value, ptr, size);
+}
+
+#define CONFIG_INDEX_GET(idx, key, type, var) \
+   config_index_get(idx, key, type, &(var), sizeof(var))
+
+/**
+ * config_settings_load:
+ * @idx             : Index of the config file.
+ * @settings        : Settings to fill in.
+ *
+ * Reads every table setting present in the config file.
+ **/
+static void config_settings_load(const config_index_t *idx,
+      settings_t *settings)
+{
+   unsigned i;
+
+   for (i = 0; i < ARRAY_SIZE(config_settings); i++)
+   {
+      const struct config_setting *s = &config_settings[i];
+      uint8_t *ptr                   = (uint8_t*)settings + s->offset;
+
+      if (!config_index_get(idx, s->key, s->type, ptr, s->size))
+         continue;
+
+      if ((s->flags & CONFIG_SETTING_FLAG_LOAD_DEFAULT)
+            && !strcmp((const char*)ptr, "default"))
+         *ptr = '\0';
+   }
+}
+
+/**
+ * config_index_put:
+ * @idx             : Index of the config file.
+ * @key             : Key to set.
+ * @type            : Type of the value.
+ * @ptr             : Value to write out.
+ * @size            : Size of @ptr.
+ * @flags           : CONFIG_SETTING_FLAG_* save flags.
+ *
+ * Formats @ptr the same way as the config_set_*() functions
+ * and writes it to the config file.
+ **/
+static void config_index_put(config_index_t *idx, const char *key,
+      enum config_setting_type type, const void *ptr, size_t size,
+      unsigned flags)
+{
+   char buf[PATH_MAX_LENGTH] = {0};
+   const char *value         = buf;
+
+   switch (type)
+   {
+      case CONFIG_SETTING_BOOL:
+         value = *(const bool*)ptr ? "true" : "false";
+         break;
+      case CONFIG_SETTING_INT:
+         snprintf(buf, sizeof(buf), "%d",
+               (int)config_setting_get_int(ptr, size));
+         break;
+      case CONFIG_SETTING_UINT:
+         snprintf(buf, sizeof(buf), "%llu",
+               (unsigned long long)config_setting_get_uint(ptr, size));
+         break;
+      case CONFIG_SETTING_HEX:
+         snprintf(buf, sizeof(buf), "%x",
+               (unsigned)config_setting_get_uint(ptr, size));
+         break;
+      case CONFIG_SETTING_FLOAT:
+         snprintf(buf, sizeof(buf), "%f", *(const float*)ptr);
+         break;
+      case CONFIG_SETTING_ARRAY:
+         value = (const char*)ptr;
+         break;
+      case CONFIG_SETTING_PATH:
+         value = (const char*)ptr;
+         if (!*value && (flags & CONFIG_SETTING_FLAG_SAVE_DEFAULT))
+            value = "default";
+#ifndef RARCH_CONSOLE
+         else if (!(flags & CONFIG_SETTING_FLAG_SAVE_STRING))
+         {
+            fill_pathname_abbreviate_special(buf, value, sizeof(buf));
+            value = buf;
+         }
+#endif
+         break;
+   }
+
+   config_index_set(idx, key, value);
+}
+
+#define CONFIG_INDEX_SET(idx, key, type, var) \
+   config_index_put(idx, key, type, &(var), sizeof(var), 0)
+
+/**
+ * config_settings_save:
+ * @idx             : Index of the config file.
+ * @settings        : Settings to write out.
+ *
+ * Writes every table setting to the config file.
+ **/
+static void config_settings_save(config_index_t *idx,
+      const settings_t *settings)
+{
+   unsigned i;
+
+   for (i = 0; i < ARRAY_SIZE(config_settings); i++)
+   {
+      const struct config_setting *s = &config_settings[i];
+
+      if (s->flags & CONFIG_SETTING_FLAG_NO_SAVE)
+         continue;
+
+      config_index_put(idx, s->key, s->type,
+            (const uint8_t*)settings + s->offset, s->size, s->flags);
+   }
 }
 
 /**
@@ -446,6 +1651,8 @@ static void config_set_defaults(void)
    const char *def_record          = config_get_default_record();
    static bool first_initialized   = true;
 
+   config_settings_set_defaults(settings);
+
    if (def_camera)
       strlcpy(settings->camera.driver,
             def_camera, sizeof(settings->camera.driver));
@@ -476,9 +1683,6 @@ static void config_set_defaults(void)
             def_menu,  sizeof(settings->menu.driver));
 #endif
 
-   settings->history_list_enable         = def_history_list_enable;
-   settings->load_dummy_on_core_shutdown = load_dummy_on_core_shutdown;
-
 #if TARGET_OS_IPHONE
    settings->input.small_keyboard_enable   = false;
 #endif
@@ -490,21 +1694,7 @@ static void config_set_defaults(void)
    settings->multimedia.builtin_mediaplayer_enable  = false;
 #endif
    settings->multimedia.builtin_imageviewer_enable = true;
-   settings->video.scale                 = scale;
    settings->video.fullscreen            = rarch_ctl(RARCH_CTL_IS_FORCE_FULLSCREEN, NULL)  ? true : fullscreen;
-   settings->video.windowed_fullscreen   = windowed_fullscreen;
-   settings->video.monitor_index         = monitor_index;
-   settings->video.fullscreen_x          = fullscreen_x;
-   settings->video.fullscreen_y          = fullscreen_y;
-   settings->video.disable_composition   = disable_composition;
-   settings->video.vsync                 = vsync;
-   settings->video.hard_sync             = hard_sync;
-   settings->video.hard_sync_frames      = hard_sync_frames;
-   settings->video.frame_delay           = frame_delay;
-   settings->video.black_frame_insertion = black_frame_insertion;
-   settings->video.swap_interval         = swap_interval;
-   settings->video.threaded              = video_threaded;
-   settings->bundle_assets_extract_enable = bundle_assets_extract_enable;
 
    if (g_defaults.settings.video_threaded_enable != video_threaded)
       settings->video.threaded           = g_defaults.settings.video_threaded_enable;
@@ -512,45 +1702,18 @@ static void config_set_defaults(void)
 #ifdef HAVE_THREADS
    settings->threaded_data_runloop_enable = threaded_data_runloop_enable;
 #endif
-   settings->video.shared_context              = video_shared_context;
    settings->video.force_srgb_disable          = false;
-#ifdef GEKKO
-   settings->video.viwidth                     = video_viwidth;
-   settings->video.vfilter                     = video_vfilter;
-#endif
-   settings->video.smooth                      = video_smooth;
-   settings->video.force_aspect                = force_aspect;
-   settings->video.scale_integer               = scale_integer;
-   settings->video.crop_overscan               = crop_overscan;
-   settings->video.aspect_ratio                = aspect_ratio;
-   settings->video.aspect_ratio_auto           = aspect_ratio_auto; /* Let implementation decide if automatic, or 1:1 PAR. */
-   settings->video.aspect_ratio_idx            = aspect_ratio_idx;
-   settings->video.shader_enable               = shader_enable;
-   settings->video.allow_rotate                = allow_rotate;
-
-   settings->video.font_enable                 = font_enable;
-   settings->video.font_size                   = font_size;
-   settings->video.msg_pos_x                   = message_pos_offset_x;
-   settings->video.msg_pos_y                   = message_pos_offset_y;
-
    settings->video.msg_color_r                 = ((message_color >> 16) & 0xff) / 255.0f;
    settings->video.msg_color_g                 = ((message_color >>  8) & 0xff) / 255.0f;
    settings->video.msg_color_b                 = ((message_color >>  0) & 0xff) / 255.0f;
 
-   settings->video.refresh_rate                = refresh_rate;
-
    if (g_defaults.settings.video_refresh_rate > 0.0 &&
          g_defaults.settings.video_refresh_rate != refresh_rate)
       settings->video.refresh_rate             = g_defaults.settings.video_refresh_rate;
 
-   settings->video.post_filter_record          = post_filter_record;
-   settings->video.gpu_record                  = gpu_record;
-   settings->video.gpu_screenshot              = gpu_screenshot;
    settings->video.rotation                    = ORIENTATION_NORMAL;
 
-   settings->audio.enable                      = audio_enable;
    settings->audio.mute_enable                 = false;
-   settings->audio.out_rate                    = out_rate;
    settings->audio.block_frames                = 0;
    if (audio_device)
       strlcpy(settings->audio.device,
@@ -560,58 +1723,31 @@ static void config_set_defaults(void)
       g_defaults.settings.out_latency          = out_latency;
 
    settings->audio.latency                     = g_defaults.settings.out_latency;
-   settings->audio.sync                        = audio_sync;
-   settings->audio.rate_control                = rate_control;
-   settings->audio.rate_control_delta          = rate_control_delta;
-   settings->audio.max_timing_skew             = max_timing_skew;
-   settings->audio.volume                      = audio_volume;
 
    audio_driver_set_volume_gain(db_to_gain(settings->audio.volume));
 
-   settings->rewind_enable                     = rewind_enable;
    settings->rewind_buffer_size                = rewind_buffer_size;
-   settings->rewind_granularity                = rewind_granularity;
-   settings->slowmotion_ratio                  = slowmotion_ratio;
-   settings->fastforward_ratio                 = fastforward_ratio;
-   settings->pause_nonactive                   = pause_nonactive;
-   settings->autosave_interval                 = autosave_interval;
-
-   settings->block_sram_overwrite              = block_sram_overwrite;
-   settings->savestate_auto_index              = savestate_auto_index;
-   settings->savestate_auto_save               = savestate_auto_save;
-   settings->savestate_auto_load               = savestate_auto_load;
+
    settings->network_cmd_enable                = network_cmd_enable;
    settings->network_cmd_port                  = network_cmd_port;
    settings->network_remote_base_port           = network_remote_base_port;
    settings->stdin_cmd_enable                  = stdin_cmd_enable;
-   settings->content_history_size              = default_content_history_size;
-   settings->libretro_log_level                = libretro_log_level;
 
 #ifdef HAVE_MENU
    if (first_initialized)
       settings->menu_show_start_screen         = default_menu_show_start_screen;
    settings->menu.pause_libretro               = true;
    settings->menu.mouse.enable                 = false;
-   settings->menu.pointer.enable               = pointer_enable;
    settings->menu.timedate_enable              = true;
    settings->menu.core_enable                  = true;
    settings->menu.dynamic_wallpaper_enable     = false;
    settings->menu.boxart_enable                = false;
-   *settings->menu.wallpaper                   = '\0';
-   settings->menu.show_advanced_settings       = show_advanced_settings;
-   settings->menu.entry_normal_color           = menu_entry_normal_color;
-   settings->menu.entry_hover_color            = menu_entry_hover_color;
-   settings->menu.title_color                  = menu_title_color;
-
-   settings->menu.dpi.override_enable          = menu_dpi_override_enable;
-   settings->menu.dpi.override_value           = menu_dpi_override_value;
 
    settings->menu.navigation.wraparound.setting_enable                  = true;
    settings->menu.navigation.wraparound.enable                          = true;
    settings->menu.navigation.browser.filter.supported_extensions_enable = true;
 #endif
 
-   settings->ui.companion_start_on_boot             = ui_companion_start_on_boot;
    settings->ui.menubar_enable                      = true;
    settings->ui.suspend_screensaver_enable          = true;
 
@@ -621,16 +1757,10 @@ static void config_set_defaults(void)
 #ifdef HAVE_CHEEVOS
    settings->cheevos.enable                         = false;
    settings->cheevos.test_unofficial                = false;
-   *settings->cheevos.username                      = '\0';
-   *settings->cheevos.password                      = '\0';
 #endif
 
    settings->input.back_as_menu_toggle_enable       = true;
-   settings->input.input_descriptor_label_show      = input_descriptor_label_show;
-   settings->input.input_descriptor_hide_unbound    = input_descriptor_hide_unbound;
    settings->input.remap_binds_enable               = true;
-   settings->input.max_users                        = input_max_users;
-   settings->input.menu_toggle_gamepad_combo        = menu_toggle_gamepad_combo;
 
    retro_assert(sizeof(settings->input.binds[0]) >= sizeof(retro_keybinds_1));
    retro_assert(sizeof(settings->input.binds[1]) >= sizeof(retro_keybinds_rest));
@@ -662,15 +1792,6 @@ static void config_set_defaults(void)
             retro_assert(j == settings->input.binds[i][j].id);
       }
 
-   settings->input.axis_threshold                  = axis_threshold;
-   settings->input.netplay_client_swap_input       = netplay_client_swap_input;
-   settings->input.turbo_period                    = turbo_period;
-   settings->input.turbo_duty_cycle                = turbo_duty_cycle;
-
-   strlcpy(settings->network.buildbot_url, buildbot_server_url,
-         sizeof(settings->network.buildbot_url));
-   strlcpy(settings->network.buildbot_assets_url, buildbot_assets_server_url,
-         sizeof(settings->network.buildbot_assets_url));
    settings->network.buildbot_auto_extract_archive = true;
 
    settings->input.overlay_enable                  = true;
@@ -678,8 +1799,6 @@ static void config_set_defaults(void)
    settings->input.overlay_hide_in_menu            = overlay_hide_in_menu;
    settings->input.overlay_opacity                 = 0.7f;
    settings->input.overlay_scale                   = 1.0f;
-   settings->input.autodetect_enable               = input_autodetect_enable;
-   *settings->input.keyboard_layout                = '\0';
 
    settings->osk.enable                            = true;
 
@@ -702,7 +1821,6 @@ static void config_set_defaults(void)
    if (!global->has_set.state_path)
       *global->dir.savestate = '\0';
 
-   *settings->libretro_info_path = '\0';
    if (!global->has_set.libretro_directory)
       *settings->libretro_directory = '\0';
 
@@ -723,54 +1841,8 @@ static void config_set_defaults(void)
    *settings->bundle_assets_dst_path = '\0';
    *settings->bundle_assets_dst_path_subdir = '\0';
 #endif
-   *settings->playlist_names = '\0';
-   *settings->playlist_cores = '\0';
-   *settings->core_options_path = '\0';
-   *settings->content_history_path = '\0';
-   *settings->content_history_directory = '\0';
-   *settings->content_database = '\0';
-   *settings->cheat_database = '\0';
-   *settings->cursor_directory = '\0';
-   *settings->cheat_settings_path = '\0';
-   *settings->resampler_directory = '\0';
-   *settings->screenshot_directory = '\0';
    *settings->system_directory = '\0';
-   *settings->cache_directory = '\0';
-   *settings->input_remapping_directory = '\0';
-   *settings->input.autoconfig_dir = '\0';
    *settings->input.overlay = '\0';
-   *settings->core_assets_directory = '\0';
-   *settings->assets_directory = '\0';
-   *settings->dynamic_wallpapers_directory = '\0';
-   *settings->boxarts_directory = '\0';
-   *settings->playlist_directory = '\0';
-   *settings->video.shader_path = '\0';
-   *settings->video.shader_dir = '\0';
-   *settings->video.filter_dir = '\0';
-   *settings->audio.filter_dir = '\0';
-   *settings->video.softfilter_plugin = '\0';
-   *settings->audio.dsp_plugin = '\0';
-#ifdef HAVE_MENU
-   *settings->menu_content_directory = '\0';
-   *settings->menu_config_directory = '\0';
-#endif
-   settings->core_specific_config = default_core_specific_config;
-   settings->game_specific_options = default_game_specific_options;
-   settings->auto_overrides_enable = default_auto_overrides_enable;
-   settings->auto_remaps_enable = default_auto_remaps_enable;
-
-   settings->sort_savefiles_enable = default_sort_savefiles_enable;
-   settings->sort_savestates_enable = default_sort_savestates_enable;
-
-   settings->menu_ok_btn          = default_menu_btn_ok;
-   settings->menu_cancel_btn      = default_menu_btn_cancel;
-   settings->menu_search_btn      = default_menu_btn_search;
-   settings->menu_default_btn     = default_menu_btn_default;
-   settings->menu_info_btn        = default_menu_btn_info;
-   settings->menu_scroll_down_btn = default_menu_btn_scroll_down;
-   settings->menu_scroll_up_btn   = default_menu_btn_scroll_up;
-
-   settings->user_language = 0;
 
    global->console.sound.system_bgm_enable = false;
 
@@ -890,8 +1962,6 @@ static void config_set_defaults(void)
       fill_pathname_expand_special(global->path.config,
             g_defaults.path.config, sizeof(global->path.config));
 
-   settings->config_save_on_exit = config_save_on_exit;
-
    /* Avoid reloading config on every content load */
    if (default_block_config_read)
       rarch_ctl(RARCH_CTL_SET_BLOCK_CONFIG_READ, NULL);
@@ -1111,85 +2181,73 @@ static config_file_t *open_default_config_file(void)
    return conf;
 }
 
-static void read_keybinds_keyboard(config_file_t *conf, unsigned user,
-      unsigned idx, struct retro_keybind *bind)
-{
-   const char *prefix = NULL;
-
-   if (!input_config_bind_map_get_valid(idx))
-      return;
-
-   if (!input_config_bind_map_get_base(idx))
-      return;
-
-   prefix = input_config_get_prefix(user, input_config_bind_map_get_meta(idx));
-
-   if (prefix)
-      input_config_parse_key(conf, prefix,
-            input_config_bind_map_get_base(idx), bind);
-}
-
-static void read_keybinds_button(config_file_t *conf, unsigned user,
-      unsigned idx, struct retro_keybind *bind)
-{
-   const char *prefix = NULL;
-
-   if (!input_config_bind_map_get_valid(idx))
-      return;
-   if (!input_config_bind_map_get_base(idx))
-      return;
-
-   prefix = input_config_get_prefix(user,
-         input_config_bind_map_get_meta(idx));
-
-   if (prefix)
-      input_config_parse_joy_button(conf, prefix,
-            input_config_bind_map_get_base(idx), bind);
-}
-
-static void read_keybinds_axis(config_file_t *conf, unsigned user,
-      unsigned idx, struct retro_keybind *bind)
+/**
+ * config_index_has_bind:
+ * @idx             : Index of the config file.
+ * @prefix          : Prefix of the bind, e.g. "input_player1".
+ * @base            : Base name of the bind.
+ *
+ * The input_config_parse_*() functions look up every key on their
+ * own. Binds the config file has no key for at all are skipped,
+ * which avoids most of those lookups for sparse configs.
+ *
+ * Returns: true (1) if the config file has any key of the bind.
+ **/
+static bool config_index_has_bind(const config_index_t *idx,
+      const char *prefix, const char *base)
 {
-   const char *prefix = NULL;
+   unsigned i;
+   static const char *suffixes[] = {
+      "", "_btn", "_btn_label", "_axis", "_axis_label"
+   };
 
-   if (!input_config_bind_map_get_valid(idx))
-      return;
-   if (!input_config_bind_map_get_base(idx))
-      return;
+   for (i = 0; i < ARRAY_SIZE(suffixes); i++)
+   {
+      char key[64] = {0};
 
-   prefix = input_config_get_prefix(user,
-         input_config_bind_map_get_meta(idx));
+      snprintf(key, sizeof(key), "%s_%s%s", prefix, base, suffixes[i]);
+      if (config_index_find(idx, key))
+         return true;
+   }
 
-   if (prefix)
-      input_config_parse_joy_axis(conf, prefix,
-            input_config_bind_map_get_base(idx), bind);
+   return false;
 }
 
-static void read_keybinds_user(config_file_t *conf, unsigned user)
+static void read_keybinds_user(config_file_t *conf,
+      const config_index_t *idx, unsigned user)
 {
    unsigned i;
    settings_t *settings = config_get_ptr();
 
    for (i = 0; input_config_bind_map_get_valid(i); i++)
    {
+      const char *prefix         = NULL;
+      const char *base           = input_config_bind_map_get_base(i);
       struct retro_keybind *bind = (struct retro_keybind*)
          &settings->input.binds[user][i];
 
-      if (!bind->valid)
+      if (!bind->valid || !base)
+         continue;
+
+      prefix = input_config_get_prefix(user,
+            input_config_bind_map_get_meta(i));
+
+      if (!prefix || !config_index_has_bind(idx, prefix, base))
          continue;
 
-      read_keybinds_keyboard(conf, user, i, bind);
-      read_keybinds_button(conf, user, i, bind);
-      read_keybinds_axis(conf, user, i, bind);
+      input_config_parse_key(conf, prefix, base, bind);
+      input_config_parse_joy_button(conf, prefix, base, bind);
+      input_config_parse_joy_axis(conf, prefix, base, bind);
    }
 }
 
-static void config_read_keybinds_conf(config_file_t *conf)
+static void config_read_keybinds_conf(config_file_t *conf,
+      const config_index_t *idx)
 {
    unsigned i;
 
    for (i = 0; i < MAX_USERS; i++)
-      read_keybinds_user(conf, i);
+      read_keybinds_user(conf, idx, i);
 }
 
 /* Also dumps inherited values, useful for logging. */
@@ -1216,15 +2274,6 @@ static void config_file_dump_all(config_file_t *conf)
 }
 #endif
 
-static void config_get_hex_base(config_file_t *conf, const char *key, unsigned *base)
-{
-   unsigned tmp = 0;
-   if (!base)
-      return;
-   if (config_get_hex(conf, key, &tmp))
-      *base = tmp;
-}
-
 /**
  * config_load:
  * @path                : path to be read from.
@@ -1238,45 +2287,39 @@ static bool config_load_file(const char *path, bool set_defaults)
 {
    unsigned i;
    bool tmp_bool;
-   char *save                            = NULL;
-   const char *extra_path                = NULL;
+   config_index_t idx;
+   config_layer_t *layers[CONFIG_LAYER_CACHE_SIZE];
+   size_t num_layers                     = 0;
+   uint32_t signature                    = 0;
    char tmp_str[PATH_MAX_LENGTH]         = {0};
-   char tmp_append_path[PATH_MAX_LENGTH] = {0}; /* Don't destroy append_config_path. */
    unsigned msg_color                    = 0;
    config_file_t *conf                   = NULL;
    settings_t *settings                  = config_get_ptr();
    global_t   *global                    = global_get_ptr();
    bool *verbose                         = retro_main_verbosity();
 
-   if (path)
+   if (!path)
    {
-      conf = config_file_new(path);
+      conf = open_default_config_file();
+
       if (!conf)
-         return false;
+         return true;
+
+      path = global->path.config;
+      config_layer_adopt(path, conf);
    }
-   else
-      conf = open_default_config_file();
 
+   num_layers = config_layers_collect(path, layers, &signature);
+   if (!num_layers)
+      return false;
+
+   conf = config_layers_merge(layers, num_layers);
    if (!conf)
-      return true;
+      return false;
 
    if (set_defaults)
       config_set_defaults();
 
-   strlcpy(tmp_append_path, global->path.append_config,
-         sizeof(tmp_append_path));
-   extra_path = strtok_r(tmp_append_path, "|", &save);
-
-   while (extra_path)
-   {
-      bool ret = config_append_file(conf, extra_path);
-
-      RARCH_LOG("Config: appending config \"%s\"\n", extra_path);
-
-      if (!ret)
-         RARCH_ERR("Config: failed to append config \"%s\"\n", extra_path);
-      extra_path = strtok_r(NULL, "|", &save);
-   }
 #if 0
    if (*verbose)
    {
@@ -1286,242 +2329,72 @@ static bool config_load_file(const char *path, bool set_defaults)
    }
 #endif
 
-   CONFIG_GET_FLOAT_BASE(conf, settings, video.scale, "video_scale");
-   CONFIG_GET_INT_BASE  (conf, settings, video.fullscreen_x, "video_fullscreen_x");
-   CONFIG_GET_INT_BASE  (conf, settings, video.fullscreen_y, "video_fullscreen_y");
+   config_index_init(&idx, conf);
+   config_settings_load(&idx, settings);
 
    if (!rarch_ctl(RARCH_CTL_IS_FORCE_FULLSCREEN, NULL))
-      CONFIG_GET_BOOL_BASE(conf, settings, video.fullscreen, "video_fullscreen");
-
-   config_get_array(conf, "playlist_names", settings->playlist_names, sizeof(settings->playlist_names));
-   config_get_array(conf, "playlist_cores", settings->playlist_cores, sizeof(settings->playlist_cores));
-
-   CONFIG_GET_BOOL_BASE(conf, settings, video.windowed_fullscreen, "video_windowed_fullscreen");
-   CONFIG_GET_INT_BASE (conf, settings, video.monitor_index, "video_monitor_index");
-   CONFIG_GET_BOOL_BASE(conf, settings, video.disable_composition, "video_disable_composition");
-   CONFIG_GET_BOOL_BASE(conf, settings, video.vsync, "video_vsync");
-   CONFIG_GET_BOOL_BASE(conf, settings, video.hard_sync, "video_hard_sync");
-
-#ifdef HAVE_MENU
-#ifdef HAVE_THREADS
-   CONFIG_GET_BOOL_BASE(conf, settings, threaded_data_runloop_enable,
-         "threaded_data_runloop_enable");
-#endif
-
-   CONFIG_GET_BOOL_BASE(conf, settings, menu.dpi.override_enable,
-         "dpi_override_enable");
-   CONFIG_GET_INT_BASE (conf, settings, menu.dpi.override_value,
-         "dpi_override_value");
-
-   CONFIG_GET_BOOL_BASE(conf, settings, menu.pause_libretro,
-         "menu_pause_libretro");
-   CONFIG_GET_BOOL_BASE(conf, settings, menu.mouse.enable,
-         "menu_mouse_enable");
-   CONFIG_GET_BOOL_BASE(conf, settings, menu.pointer.enable,
-         "menu_pointer_enable");
-   CONFIG_GET_BOOL_BASE(conf, settings, menu.timedate_enable,
-         "menu_timedate_enable");
-   CONFIG_GET_BOOL_BASE(conf, settings, menu.core_enable,
-         "menu_core_enable");
-   CONFIG_GET_BOOL_BASE(conf, settings, menu.dynamic_wallpaper_enable,
-         "menu_dynamic_wallpaper_enable");
-   CONFIG_GET_BOOL_BASE(conf, settings, menu.boxart_enable,
-         "menu_boxart_enable");
-   CONFIG_GET_BOOL_BASE(conf, settings, menu.navigation.wraparound.enable,
-         "menu_navigation_wraparound_enable");
-   CONFIG_GET_BOOL_BASE(conf, settings,
-         menu.navigation.browser.filter.supported_extensions_enable,
-         "menu_navigation_browser_filter_supported_extensions_enable");
-   CONFIG_GET_BOOL_BASE(conf, settings, menu.show_advanced_settings,
-         "menu_show_advanced_settings");
-   config_get_hex_base(conf, "menu_entry_normal_color",
-         &settings->menu.entry_normal_color);
-   config_get_hex_base(conf, "menu_entry_hover_color",
-         &settings->menu.entry_hover_color);
-   config_get_hex_base(conf, "menu_title_color",
-         &settings->menu.title_color);
-   config_get_path(conf, "menu_wallpaper",
-         settings->menu.wallpaper, sizeof(settings->menu.wallpaper));
-   if (!strcmp(settings->menu.wallpaper, "default"))
-      *settings->menu.wallpaper = '\0';
-#endif
+      CONFIG_INDEX_GET(&idx, "video_fullscreen",
+            CONFIG_SETTING_BOOL, settings->video.fullscreen);
 
-   CONFIG_GET_INT_BASE(conf, settings, video.hard_sync_frames, "video_hard_sync_frames");
    if (settings->video.hard_sync_frames > 3)
       settings->video.hard_sync_frames = 3;
 
-   CONFIG_GET_INT_BASE(conf, settings, video.frame_delay, "video_frame_delay");
    if (settings->video.frame_delay > 15)
       settings->video.frame_delay = 15;
 
-   CONFIG_GET_BOOL_BASE(conf, settings, video.black_frame_insertion, "video_black_frame_insertion");
-   CONFIG_GET_INT_BASE(conf, settings, video.swap_interval, "video_swap_interval");
    settings->video.swap_interval = max(settings->video.swap_interval, 1);
    settings->video.swap_interval = min(settings->video.swap_interval, 4);
-   CONFIG_GET_BOOL_BASE(conf, settings, video.threaded, "video_threaded");
-   CONFIG_GET_BOOL_BASE(conf, settings, video.shared_context, "video_shared_context");
-#ifdef GEKKO
-   CONFIG_GET_INT_BASE(conf, settings, video.viwidth, "video_viwidth");
-   CONFIG_GET_BOOL_BASE(conf, settings, video.vfilter, "video_vfilter");
-#endif
-   CONFIG_GET_BOOL_BASE(conf, settings, video.smooth, "video_smooth");
-   CONFIG_GET_BOOL_BASE(conf, settings, video.force_aspect, "video_force_aspect");
-   CONFIG_GET_BOOL_BASE(conf, settings, video.scale_integer, "video_scale_integer");
-   CONFIG_GET_BOOL_BASE(conf, settings, video.crop_overscan, "video_crop_overscan");
-   CONFIG_GET_FLOAT_BASE(conf, settings, video.aspect_ratio, "video_aspect_ratio");
-   CONFIG_GET_INT_BASE(conf, settings, video.aspect_ratio_idx, "aspect_ratio_index");
-   CONFIG_GET_BOOL_BASE(conf,  settings, video.aspect_ratio_auto, "video_aspect_ratio_auto");
-   CONFIG_GET_FLOAT_BASE(conf, settings, video.refresh_rate, "video_refresh_rate");
-
-   config_get_path(conf, "video_shader", settings->video.shader_path, sizeof(settings->video.shader_path));
-   CONFIG_GET_BOOL_BASE(conf, settings, video.shader_enable, "video_shader_enable");
-
-   CONFIG_GET_BOOL_BASE(conf, settings, video.allow_rotate, "video_allow_rotate");
-
-   config_get_path(conf, "video_font_path", settings->video.font_path, sizeof(settings->video.font_path));
-   CONFIG_GET_FLOAT_BASE(conf, settings, video.font_size, "video_font_size");
-   CONFIG_GET_BOOL_BASE(conf, settings, video.font_enable, "video_font_enable");
-   CONFIG_GET_FLOAT_BASE(conf, settings, video.msg_pos_x, "video_message_pos_x");
-   CONFIG_GET_FLOAT_BASE(conf, settings, video.msg_pos_y, "video_message_pos_y");
-   CONFIG_GET_INT_BASE(conf, settings, video.rotation, "video_rotation");
-
-   CONFIG_GET_BOOL_BASE(conf, settings, video.force_srgb_disable, "video_force_srgb_disable");
-
-   CONFIG_GET_BOOL_BASE(conf, settings, core.set_supports_no_game_enable, "core_set_supports_no_game_enable");
 
 #ifdef RARCH_CONSOLE
    /* TODO - will be refactored later to make it more clean - it's more
     * important that it works for consoles right now */
-   config_get_bool(conf, "custom_bgm_enable",
-         &global->console.sound.system_bgm_enable);
+   CONFIG_INDEX_GET(&idx, "custom_bgm_enable",
+         CONFIG_SETTING_BOOL, global->console.sound.system_bgm_enable);
    video_driver_ctl(RARCH_DISPLAY_CTL_LOAD_SETTINGS, conf);
 #endif
-   CONFIG_GET_INT_BASE(conf, settings, state_slot, "state_slot");
 
-   CONFIG_GET_INT_BASE(conf, settings, video_viewport_custom.width,  "custom_viewport_width");
-   CONFIG_GET_INT_BASE(conf, settings, video_viewport_custom.height, "custom_viewport_height");
-   CONFIG_GET_INT_BASE(conf, settings, video_viewport_custom.x,      "custom_viewport_x");
-   CONFIG_GET_INT_BASE(conf, settings, video_viewport_custom.y,      "custom_viewport_y");
-
-   if (config_get_hex(conf, "video_message_color", &msg_color))
+   if (CONFIG_INDEX_GET(&idx, "video_message_color",
+            CONFIG_SETTING_HEX, msg_color))
    {
       settings->video.msg_color_r = ((msg_color >> 16) & 0xff) / 255.0f;
       settings->video.msg_color_g = ((msg_color >>  8) & 0xff) / 255.0f;
       settings->video.msg_color_b = ((msg_color >>  0) & 0xff) / 255.0f;
    }
 
-   CONFIG_GET_BOOL_BASE(conf, settings, video.post_filter_record, "video_post_filter_record");
-   CONFIG_GET_BOOL_BASE(conf, settings, video.gpu_record, "video_gpu_record");
-   CONFIG_GET_BOOL_BASE(conf, settings, video.gpu_screenshot, "video_gpu_screenshot");
-
-   config_get_path(conf, "video_shader_dir", settings->video.shader_dir, sizeof(settings->video.shader_dir));
-   if (!strcmp(settings->video.shader_dir, "default"))
-      *settings->video.shader_dir = '\0';
-
-   config_get_path(conf, "video_filter_dir", settings->video.filter_dir, sizeof(settings->video.filter_dir));
-   if (!strcmp(settings->video.filter_dir, "default"))
-      *settings->video.filter_dir = '\0';
-
-   config_get_path(conf, "audio_filter_dir", settings->audio.filter_dir, sizeof(settings->audio.filter_dir));
-   if (!strcmp(settings->audio.filter_dir, "default"))
-      *settings->audio.filter_dir = '\0';
-
-   CONFIG_GET_BOOL_BASE(conf, settings, input.back_as_menu_toggle_enable, "back_as_menu_toggle_enable");
-   CONFIG_GET_BOOL_BASE(conf, settings, input.remap_binds_enable, "input_remap_binds_enable");
-   CONFIG_GET_FLOAT_BASE(conf, settings, input.axis_threshold, "input_axis_threshold");
-   CONFIG_GET_BOOL_BASE(conf, settings, input.netplay_client_swap_input, "netplay_client_swap_input");
-   CONFIG_GET_INT_BASE(conf, settings, input.max_users, "input_max_users");
-   CONFIG_GET_INT_BASE(conf, settings, input.menu_toggle_gamepad_combo, "input_menu_toggle_gamepad_combo");
-   CONFIG_GET_BOOL_BASE(conf, settings, input.input_descriptor_label_show, "input_descriptor_label_show");
-   CONFIG_GET_BOOL_BASE(conf, settings, input.input_descriptor_hide_unbound, "input_descriptor_hide_unbound");
-
-   CONFIG_GET_BOOL_BASE(conf, settings, ui.companion_start_on_boot, "ui_companion_start_on_boot");
-
-   config_get_path(conf, "core_updater_buildbot_url",
-         settings->network.buildbot_url, sizeof(settings->network.buildbot_url));
-   config_get_path(conf, "core_updater_buildbot_assets_url",
-         settings->network.buildbot_assets_url, sizeof(settings->network.buildbot_assets_url));
-   CONFIG_GET_BOOL_BASE(conf, settings, network.buildbot_auto_extract_archive, "core_updater_auto_extract_archive");
-
    for (i = 0; i < MAX_USERS; i++)
    {
       char buf[64] = {0};
       snprintf(buf, sizeof(buf), "input_player%u_joypad_index", i + 1);
-      CONFIG_GET_INT_BASE(conf, settings, input.joypad_map[i], buf);
+      CONFIG_INDEX_GET(&idx, buf, CONFIG_SETTING_UINT,
+            settings->input.joypad_map[i]);
 
       snprintf(buf, sizeof(buf), "input_player%u_analog_dpad_mode", i + 1);
-      CONFIG_GET_INT_BASE(conf, settings, input.analog_dpad_mode[i], buf);
+      CONFIG_INDEX_GET(&idx, buf, CONFIG_SETTING_UINT,
+            settings->input.analog_dpad_mode[i]);
 
       if (!global->has_set.libretro_device[i])
       {
          snprintf(buf, sizeof(buf), "input_libretro_device_p%u", i + 1);
-         CONFIG_GET_INT_BASE(conf, settings, input.libretro_device[i], buf);
+         CONFIG_INDEX_GET(&idx, buf, CONFIG_SETTING_UINT,
+               settings->input.libretro_device[i]);
       }
    }
 
    if (!global->has_set.ups_pref)
-   {
-      CONFIG_GET_BOOL_BASE(conf, global, patch.ups_pref, "ups_pref");
-   }
+      CONFIG_INDEX_GET(&idx, "ups_pref", CONFIG_SETTING_BOOL, global->patch.ups_pref);
    if (!global->has_set.bps_pref)
-   {
-      CONFIG_GET_BOOL_BASE(conf, global, patch.bps_pref, "bps_pref");
-   }
+      CONFIG_INDEX_GET(&idx, "bps_pref", CONFIG_SETTING_BOOL, global->patch.bps_pref);
    if (!global->has_set.ips_pref)
-   {
-      CONFIG_GET_BOOL_BASE(conf, global, patch.ips_pref, "ips_pref");
-   }
-
-   /* Audio settings. */
-   CONFIG_GET_BOOL_BASE(conf, settings, audio.enable, "audio_enable");
-   CONFIG_GET_BOOL_BASE(conf, settings, audio.mute_enable, "audio_mute_enable");
-   CONFIG_GET_INT_BASE(conf, settings, audio.out_rate, "audio_out_rate");
-   CONFIG_GET_INT_BASE(conf, settings, audio.block_frames, "audio_block_frames");
-
-   config_get_array(conf, "audio_device", settings->audio.device, sizeof(settings->audio.device));
-
-   CONFIG_GET_INT_BASE(conf, settings, audio.latency, "audio_latency");
-   CONFIG_GET_BOOL_BASE(conf, settings, audio.sync, "audio_sync");
-   CONFIG_GET_BOOL_BASE(conf, settings, audio.rate_control, "audio_rate_control");
-   CONFIG_GET_FLOAT_BASE(conf, settings, audio.rate_control_delta, "audio_rate_control_delta");
-   CONFIG_GET_FLOAT_BASE(conf, settings, audio.max_timing_skew, "audio_max_timing_skew");
-   CONFIG_GET_FLOAT_BASE(conf, settings, audio.volume, "audio_volume");
-
-   config_get_array(conf, "audio_resampler", settings->audio.resampler, sizeof(settings->audio.resampler));
+      CONFIG_INDEX_GET(&idx, "ips_pref", CONFIG_SETTING_BOOL, global->patch.ips_pref);
 
    audio_driver_set_volume_gain(db_to_gain(settings->audio.volume));
 
-   config_get_array(conf, "camera_device", settings->camera.device, sizeof(settings->camera.device));
-
-   CONFIG_GET_BOOL_BASE(conf, settings, camera.allow, "camera_allow");
-
-#ifdef HAVE_CHEEVOS
-   CONFIG_GET_BOOL_BASE(conf, settings, cheevos.enable, "cheevos_enable");
-   CONFIG_GET_BOOL_BASE(conf, settings, cheevos.test_unofficial, "cheevos_test_unofficial");
-   config_get_array(conf, "cheevos_username", settings->cheevos.username, sizeof(settings->cheevos.username));
-   config_get_array(conf, "cheevos_password", settings->cheevos.password, sizeof(settings->cheevos.password));
-#endif
-
-   CONFIG_GET_BOOL_BASE(conf, settings, location.allow, "location_allow");
-   config_get_array(conf, "video_driver",    settings->video.driver, sizeof(settings->video.driver));
-   config_get_array(conf, "record_driver",   settings->record.driver, sizeof(settings->video.driver));
-   config_get_array(conf, "camera_driver",   settings->camera.driver, sizeof(settings->camera.driver));
-   config_get_array(conf, "location_driver", settings->location.driver, sizeof(settings->location.driver));
-#ifdef HAVE_MENU
-   config_get_array(conf, "menu_driver",     settings->menu.driver, sizeof(settings->menu.driver));
-#endif
-   config_get_array(conf, "video_context_driver", settings->video.context_driver, sizeof(settings->video.context_driver));
-   config_get_array(conf, "audio_driver", settings->audio.driver, sizeof(settings->audio.driver));
-   config_get_path(conf, "video_filter", settings->video.softfilter_plugin, sizeof(settings->video.softfilter_plugin));
-   config_get_path(conf, "audio_dsp_plugin", settings->audio.dsp_plugin, sizeof(settings->audio.dsp_plugin));
-   config_get_array(conf, "input_driver", settings->input.driver, sizeof(settings->input.driver));
-   config_get_array(conf, "input_joypad_driver", settings->input.joypad_driver, sizeof(settings->input.joypad_driver));
-   config_get_array(conf, "input_keyboard_layout", settings->input.keyboard_layout, sizeof(settings->input.keyboard_layout));
-
    if (!global->has_set.libretro)
-      config_get_path(conf, "libretro_path", settings->libretro, sizeof(settings->libretro));
+      CONFIG_INDEX_GET(&idx, "libretro_path",
+            CONFIG_SETTING_PATH, settings->libretro);
    if (!global->has_set.libretro_directory)
-      config_get_path(conf, "libretro_directory", settings->libretro_directory, sizeof(settings->libretro_directory));
+      CONFIG_INDEX_GET(&idx, "libretro_directory",
+            CONFIG_SETTING_PATH, settings->libretro_directory);
 
    /* Safe-guard against older behavior. */
    if (path_is_directory(settings->libretro))
@@ -1532,223 +2405,92 @@ static bool config_load_file(const char *path, bool set_defaults)
       *settings->libretro = '\0';
    }
 
-   CONFIG_GET_BOOL_BASE(conf, settings, ui.menubar_enable, "ui_menubar_enable");
-   CONFIG_GET_BOOL_BASE(conf, settings, ui.suspend_screensaver_enable, "suspend_screensaver_enable");
-   CONFIG_GET_BOOL_BASE(conf, settings, fps_show, "fps_show");
-   CONFIG_GET_BOOL_BASE(conf, settings, load_dummy_on_core_shutdown, "load_dummy_on_core_shutdown");
-   CONFIG_GET_BOOL_BASE(conf, settings, multimedia.builtin_mediaplayer_enable, "builtin_mediaplayer_enable");
-   CONFIG_GET_BOOL_BASE(conf, settings, multimedia.builtin_imageviewer_enable, "builtin_imageviewer_enable");
-
-   config_get_path(conf, "libretro_info_path", settings->libretro_info_path, sizeof(settings->libretro_info_path));
-
-   config_get_path(conf, "core_options_path", settings->core_options_path, sizeof(settings->core_options_path));
-   config_get_path(conf, "screenshot_directory", settings->screenshot_directory, sizeof(settings->screenshot_directory));
-   if (*settings->screenshot_directory)
+   if (*settings->screenshot_directory
+         && !path_is_directory(settings->screenshot_directory))
    {
-      if (!strcmp(settings->screenshot_directory, "default"))
-         *settings->screenshot_directory = '\0';
-      else if (!path_is_directory(settings->screenshot_directory))
-      {
-         RARCH_WARN("screenshot_directory is not an existing directory, ignoring ...\n");
-         *settings->screenshot_directory = '\0';
-      }
+      RARCH_WARN("screenshot_directory is not an existing directory, ignoring ...\n");
+      *settings->screenshot_directory = '\0';
    }
 
-   config_get_path(conf, "input_remapping_path", settings->input.remapping_path,
-         sizeof(settings->input.remapping_path));
-   config_get_path(conf, "resampler_directory", settings->resampler_directory,
-         sizeof(settings->resampler_directory));
-   config_get_path(conf, "cache_directory", settings->cache_directory,
-         sizeof(settings->cache_directory));
-   config_get_path(conf, "input_remapping_directory", settings->input_remapping_directory,
-         sizeof(settings->input_remapping_directory));
-   config_get_path(conf, "core_assets_directory", settings->core_assets_directory,
-         sizeof(settings->core_assets_directory));
-   config_get_path(conf, "assets_directory", settings->assets_directory,
-         sizeof(settings->assets_directory));
-   config_get_path(conf, "dynamic_wallpapers_directory", settings->dynamic_wallpapers_directory,
-         sizeof(settings->dynamic_wallpapers_directory));
-   config_get_path(conf, "boxarts_directory", settings->boxarts_directory,
-         sizeof(settings->boxarts_directory));
-   config_get_path(conf, "playlist_directory", settings->playlist_directory,
-         sizeof(settings->playlist_directory));
-   if (!strcmp(settings->core_assets_directory, "default"))
-      *settings->core_assets_directory = '\0';
-   if (!strcmp(settings->assets_directory, "default"))
-      *settings->assets_directory = '\0';
-   if (!strcmp(settings->dynamic_wallpapers_directory, "default"))
-      *settings->dynamic_wallpapers_directory = '\0';
-   if (!strcmp(settings->boxarts_directory, "default"))
-      *settings->boxarts_directory = '\0';
-   if (!strcmp(settings->playlist_directory, "default"))
-      *settings->playlist_directory = '\0';
-#ifdef HAVE_MENU
-   config_get_path(conf, "rgui_browser_directory", settings->menu_content_directory,
-         sizeof(settings->menu_content_directory));
-   if (!strcmp(settings->menu_content_directory, "default"))
-      *settings->menu_content_directory = '\0';
-   config_get_path(conf, "rgui_config_directory", settings->menu_config_directory,
-         sizeof(settings->menu_config_directory));
-   if (!strcmp(settings->menu_config_directory, "default"))
-      *settings->menu_config_directory = '\0';
-   CONFIG_GET_BOOL_BASE(conf, settings, menu_show_start_screen, "rgui_show_start_screen");
-#endif
-   CONFIG_GET_INT_BASE(conf, settings, libretro_log_level, "libretro_log_level");
-
    if (!global->has_set.verbosity)
    {
-      if (config_get_bool(conf, "log_verbosity", &tmp_bool))
+      if (CONFIG_INDEX_GET(&idx, "log_verbosity", CONFIG_SETTING_BOOL, tmp_bool))
       {
          if (verbose)
             *verbose = tmp_bool;
       }
    }
 
-   {
-      bool tmp_bool;
-      char tmp[64] = {0};
-      strlcpy(tmp, "perfcnt_enable", sizeof(tmp));
-      config_get_bool(conf, tmp, &tmp_bool);
-
-      if (tmp_bool)
-         runloop_ctl(RUNLOOP_CTL_SET_PERFCNT_ENABLE, NULL);
-      else
-         runloop_ctl(RUNLOOP_CTL_UNSET_PERFCNT_ENABLE, NULL);
-   }
+   tmp_bool = false;
+   CONFIG_INDEX_GET(&idx, "perfcnt_enable", CONFIG_SETTING_BOOL, tmp_bool);
 
-#if TARGET_OS_IPHONE
-   CONFIG_GET_BOOL_BASE(conf, settings, input.small_keyboard_enable,   "small_keyboard_enable");
-#endif
-   CONFIG_GET_BOOL_BASE(conf, settings, input.keyboard_gamepad_enable, "keyboard_gamepad_enable");
-   CONFIG_GET_INT_BASE(conf, settings, input.keyboard_gamepad_mapping_type, "keyboard_gamepad_mapping_type");
+   if (tmp_bool)
+      runloop_ctl(RUNLOOP_CTL_SET_PERFCNT_ENABLE, NULL);
+   else
+      runloop_ctl(RUNLOOP_CTL_UNSET_PERFCNT_ENABLE, NULL);
 
-   config_get_path(conf, "recording_output_directory", global->record.output_dir,
-         sizeof(global->record.output_dir));
-   config_get_path(conf, "recording_config_directory", global->record.config_dir,
-         sizeof(global->record.config_dir));
+   CONFIG_INDEX_GET(&idx, "recording_output_directory",
+         CONFIG_SETTING_PATH, global->record.output_dir);
+   CONFIG_INDEX_GET(&idx, "recording_config_directory",
+         CONFIG_SETTING_PATH, global->record.config_dir);
 
 #ifdef HAVE_OVERLAY
-   config_get_path(conf, "overlay_directory", settings->overlay_directory, sizeof(settings->overlay_directory));
-   if (!strcmp(settings->overlay_directory, "default"))
-      *settings->overlay_directory = '\0';
-
-   config_get_path(conf, "input_overlay", settings->input.overlay, sizeof(settings->input.overlay));
-   CONFIG_GET_BOOL_BASE(conf, settings, input.overlay_enable, "input_overlay_enable");
-   CONFIG_GET_BOOL_BASE(conf, settings, input.overlay_enable_autopreferred, "input_overlay_enable_autopreferred");
-   CONFIG_GET_BOOL_BASE(conf, settings, input.overlay_hide_in_menu, "input_overlay_hide_in_menu");
-   CONFIG_GET_FLOAT_BASE(conf, settings, input.overlay_opacity, "input_overlay_opacity");
-   CONFIG_GET_FLOAT_BASE(conf, settings, input.overlay_scale, "input_overlay_scale");
-
-   config_get_path(conf, "osk_overlay_directory", global->dir.osk_overlay, sizeof(global->dir.osk_overlay));
+   CONFIG_INDEX_GET(&idx, "osk_overlay_directory",
+         CONFIG_SETTING_PATH, global->dir.osk_overlay);
    if (!strcmp(global->dir.osk_overlay, "default"))
       *global->dir.osk_overlay = '\0';
-
-   config_get_path(conf, "input_osk_overlay", settings->osk.overlay, sizeof(settings->osk.overlay));
-   CONFIG_GET_BOOL_BASE(conf, settings, osk.enable, "input_osk_overlay_enable");
 #endif
 
-   CONFIG_GET_BOOL_BASE(conf, settings, rewind_enable, "rewind_enable");
-
    {
       /* ugly hack around C89 not allowing mixing declarations and code */
       int buffer_size = 0;
-      if (config_get_int(conf, "rewind_buffer_size", &buffer_size))
+      if (CONFIG_INDEX_GET(&idx, "rewind_buffer_size",
+               CONFIG_SETTING_INT, buffer_size))
          settings->rewind_buffer_size = buffer_size * UINT64_C(1000000);
    }
 
-   CONFIG_GET_BOOL_BASE(conf, settings, bundle_assets_extract_enable, "bundle_assets_extract_enable");
-   CONFIG_GET_INT_BASE(conf, settings, bundle_assets_extract_version_current, "bundle_assets_extract_version_current");
-   CONFIG_GET_INT_BASE(conf, settings, bundle_assets_extract_last_version,    "bundle_assets_extract_last_version");
-   config_get_array(conf, "bundle_assets_src_path", settings->bundle_assets_src_path, sizeof(settings->bundle_assets_src_path));
-   config_get_array(conf, "bundle_assets_dst_path", settings->bundle_assets_dst_path, sizeof(settings->bundle_assets_dst_path));
-   config_get_array(conf, "bundle_assets_dst_path_subdir", settings->bundle_assets_dst_path_subdir, sizeof(settings->bundle_assets_dst_path_subdir));
-
-   CONFIG_GET_INT_BASE(conf, settings, rewind_granularity, "rewind_granularity");
-   CONFIG_GET_FLOAT_BASE(conf, settings, slowmotion_ratio, "slowmotion_ratio");
    if (settings->slowmotion_ratio < 1.0f)
       settings->slowmotion_ratio = 1.0f;
 
-   CONFIG_GET_FLOAT_BASE(conf, settings, fastforward_ratio, "fastforward_ratio");
-
    /* Sanitize fastforward_ratio value - previously range was -1
     * and up (with 0 being skipped) */
    if (settings->fastforward_ratio < 0.0f)
       settings->fastforward_ratio = 0.0f;
 
-   CONFIG_GET_BOOL_BASE(conf, settings, pause_nonactive, "pause_nonactive");
-   CONFIG_GET_INT_BASE(conf, settings, autosave_interval, "autosave_interval");
-
-   config_get_path(conf, "content_database_path",
-         settings->content_database, sizeof(settings->content_database));
-   config_get_path(conf, "cheat_database_path",
-         settings->cheat_database, sizeof(settings->cheat_database));
-   config_get_path(conf, "cursor_directory",
-         settings->cursor_directory, sizeof(settings->cursor_directory));
-   config_get_path(conf, "cheat_settings_path",
-         settings->cheat_settings_path, sizeof(settings->cheat_settings_path));
-
-   CONFIG_GET_BOOL_BASE(conf, settings, block_sram_overwrite, "block_sram_overwrite");
-   CONFIG_GET_BOOL_BASE(conf, settings, savestate_auto_index, "savestate_auto_index");
-   CONFIG_GET_BOOL_BASE(conf, settings, savestate_auto_save, "savestate_auto_save");
-   CONFIG_GET_BOOL_BASE(conf, settings, savestate_auto_load, "savestate_auto_load");
-
-#ifdef HAVE_COMMAND
-   CONFIG_GET_BOOL_BASE(conf, settings, network_cmd_enable, "network_cmd_enable");
-   CONFIG_GET_INT_BASE(conf, settings, network_cmd_port, "network_cmd_port");
-   CONFIG_GET_BOOL_BASE(conf, settings, stdin_cmd_enable, "stdin_cmd_enable");
-#endif
-
 #ifdef HAVE_NETWORK_GAMEPAD
-   CONFIG_GET_BOOL_BASE(conf, settings, network_remote_enable, "network_remote_enable");
    for (i = 0; i < MAX_USERS; i++)
    {
       char tmp[64] = {0};
       snprintf(tmp, sizeof(tmp), "network_remote_enable_user_p%u", i + 1);
-      config_get_bool(conf, tmp, &settings->network_remote_enable_user[i]);
+      CONFIG_INDEX_GET(&idx, tmp, CONFIG_SETTING_BOOL,
+            settings->network_remote_enable_user[i]);
    }
-   CONFIG_GET_INT_BASE(conf, settings, network_remote_base_port, "network_remote_base_port");
-   
 #endif
 
-   CONFIG_GET_BOOL_BASE(conf, settings, debug_panel_enable, "debug_panel_enable");
-
-   config_get_path(conf, "content_history_dir", settings->content_history_directory,
-         sizeof(settings->content_history_directory));
-
-   CONFIG_GET_BOOL_BASE(conf, settings, history_list_enable, "history_list_enable");
-
-   config_get_path(conf, "content_history_path", settings->content_history_path,
-         sizeof(settings->content_history_path));
-   CONFIG_GET_INT_BASE(conf, settings, content_history_size, "content_history_size");
-
-   CONFIG_GET_INT_BASE(conf, settings, input.turbo_period, "input_turbo_period");
-   CONFIG_GET_INT_BASE(conf, settings, input.turbo_duty_cycle, "input_duty_cycle");
-
-   CONFIG_GET_BOOL_BASE(conf, settings, input.autodetect_enable, "input_autodetect_enable");
-   config_get_path(conf, "joypad_autoconfig_dir",
-         settings->input.autoconfig_dir, sizeof(settings->input.autoconfig_dir));
-
    if (!global->has_set.username)
-      config_get_path(conf, "netplay_nickname",  settings->username, sizeof(settings->username));
-   CONFIG_GET_INT_BASE(conf, settings, user_language, "user_language");
+      CONFIG_INDEX_GET(&idx, "netplay_nickname",
+            CONFIG_SETTING_PATH, settings->username);
 #ifdef HAVE_NETPLAY
    if (!global->has_set.netplay_mode)
-      CONFIG_GET_BOOL_BASE(conf, global, netplay.is_spectate,
-            "netplay_spectator_mode_enable");
+      CONFIG_INDEX_GET(&idx, "netplay_spectator_mode_enable",
+            CONFIG_SETTING_BOOL, global->netplay.is_spectate);
    if (!global->has_set.netplay_mode)
-      CONFIG_GET_BOOL_BASE(conf, global, netplay.is_client, "netplay_mode");
+      CONFIG_INDEX_GET(&idx, "netplay_mode",
+            CONFIG_SETTING_BOOL, global->netplay.is_client);
    if (!global->has_set.netplay_ip_address)
-      config_get_path(conf, "netplay_ip_address", global->netplay.server, sizeof(global->netplay.server));
+      CONFIG_INDEX_GET(&idx, "netplay_ip_address",
+            CONFIG_SETTING_PATH, global->netplay.server);
    if (!global->has_set.netplay_delay_frames)
-      CONFIG_GET_INT_BASE(conf, global, netplay.sync_frames, "netplay_delay_frames");
+      CONFIG_INDEX_GET(&idx, "netplay_delay_frames",
+            CONFIG_SETTING_UINT, global->netplay.sync_frames);
    if (!global->has_set.netplay_ip_port)
-      CONFIG_GET_INT_BASE(conf, global, netplay.port, "netplay_ip_port");
+      CONFIG_INDEX_GET(&idx, "netplay_ip_port",
+            CONFIG_SETTING_UINT, global->netplay.port);
 #endif
 
-   CONFIG_GET_BOOL_BASE(conf, settings, config_save_on_exit, "config_save_on_exit");
-
    if (!global->has_set.save_path &&
-         config_get_path(conf, "savefile_directory", tmp_str, sizeof(tmp_str)))
+         CONFIG_INDEX_GET(&idx, "savefile_directory",
+            CONFIG_SETTING_PATH, tmp_str))
    {
       if (!strcmp(tmp_str, "default"))
          strlcpy(global->dir.savefile, g_defaults.dir.sram,
@@ -1767,7 +2509,8 @@ static bool config_load_file(const char *path, bool set_defaults)
    }
 
    if (!global->has_set.state_path &&
-         config_get_path(conf, "savestate_directory", tmp_str, sizeof(tmp_str)))
+         CONFIG_INDEX_GET(&idx, "savestate_directory",
+            CONFIG_SETTING_PATH, tmp_str))
    {
       if (!strcmp(tmp_str, "default"))
          strlcpy(global->dir.savestate, g_defaults.dir.savestate,
@@ -1802,8 +2545,8 @@ static bool config_load_file(const char *path, bool set_defaults)
       }
    }
 
-   if (!config_get_path(conf, "system_directory",
-            settings->system_directory, sizeof(settings->system_directory)))
+   if (!CONFIG_INDEX_GET(&idx, "system_directory",
+            CONFIG_SETTING_PATH, settings->system_directory))
    {
       RARCH_WARN("SYSTEM DIR is empty, assume CONTENT DIR\n");
       *settings->system_directory = '\0';
@@ -1815,26 +2558,12 @@ static bool config_load_file(const char *path, bool set_defaults)
       *settings->system_directory = '\0';
    }
 
-   config_read_keybinds_conf(conf);
-
-   CONFIG_GET_BOOL_BASE(conf, settings, core_specific_config, "core_specific_config");
-   CONFIG_GET_BOOL_BASE(conf, settings, game_specific_options, "game_specific_options");
-   CONFIG_GET_BOOL_BASE(conf, settings, auto_overrides_enable, "auto_overrides_enable");
-   CONFIG_GET_BOOL_BASE(conf, settings, auto_remaps_enable, "auto_remaps_enable");
+   config_read_keybinds_conf(conf, &idx);
 
-   CONFIG_GET_BOOL_BASE(conf, settings, sort_savefiles_enable, "sort_savefiles_enable");
-   CONFIG_GET_BOOL_BASE(conf, settings, sort_savestates_enable, "sort_savestates_enable");
-
-   CONFIG_GET_INT_BASE(conf, settings, menu_ok_btn,          "menu_ok_btn");
-   CONFIG_GET_INT_BASE(conf, settings, menu_cancel_btn,      "menu_cancel_btn");
-   CONFIG_GET_INT_BASE(conf, settings, menu_search_btn,      "menu_search_btn");
-   CONFIG_GET_INT_BASE(conf, settings, menu_info_btn,        "menu_info_btn");
-   CONFIG_GET_INT_BASE(conf, settings, menu_default_btn,     "menu_default_btn");
-   CONFIG_GET_INT_BASE(conf, settings, menu_cancel_btn,      "menu_cancel_btn");
-   CONFIG_GET_INT_BASE(conf, settings, menu_scroll_down_btn, "menu_scroll_down_btn");
-   CONFIG_GET_INT_BASE(conf, settings, menu_scroll_up_btn,   "menu_scroll_up_btn");
+   config_index_free(&idx);
 
    config_file_free(conf);
+   config_layers_applied = signature;
    return true;
 }
 
@@ -1911,24 +2640,40 @@ static void config_load_core_specific(void)
  * configuration file exists at respective locations.
  *
  * core-specific: $CONFIG_DIR/$CORE_NAME/$CORE_NAME.cfg fallback: $CURRENT_CFG_LOCATION/$CORE_NAME/$CORE_NAME.cfg
+ * content dir-specific: $CONFIG_DIR/$CORE_NAME/$CONTENT_DIR_NAME.cfg fallback: $CURRENT_CFG_LOCATION/$CORE_NAME/$CONTENT_DIR_NAME.cfg
  * game-specific: $CONFIG_DIR/$CORE_NAME/$ROM_NAME.cfg fallback: $CURRENT_CFG_LOCATION/$CORE_NAME/$GAME_NAME.cfg
  *
+ * Overrides are stacked in that order on top of the base config.
+ * Parsed files are cached, and nothing is reloaded if the same
+ * overrides are already applied.
+ *
  * Returns: false if there was an error or no action was performed.
  *
  */
 bool config_load_override(void)
 {
+   size_t i;
    char buf[PATH_MAX_LENGTH]              = {0};
    char config_directory[PATH_MAX_LENGTH] = {0}; /* path to the directory containing retroarch.cfg (prefix)    */
+   char content_dir[PATH_MAX_LENGTH]      = {0}; /* directory holding the content                            */
    char core_path[PATH_MAX_LENGTH]        = {0}; /* final path for core-specific configuration (prefix+suffix) */
+   char content_dir_path[PATH_MAX_LENGTH] = {0}; /* final path for content dir-specific configuration        */
    char game_path[PATH_MAX_LENGTH]        = {0}; /* final path for game-specific configuration (prefix+suffix) */
-   config_file_t *new_conf                = NULL;
+   const char *override_paths[3];
+   config_layer_t *layer                  = NULL;
+   size_t len                             = 0;
    const char *core_name                  = NULL;
    const char *game_name                  = NULL;
+   const char *content_dir_name           = NULL;
    bool should_append                     = false;
    global_t *global                       = global_get_ptr();
    settings_t *settings                   = config_get_ptr();
    rarch_system_info_t *system            = NULL;
+   static const enum config_layer_type override_types[3] = {
+      CONFIG_LAYER_CORE,
+      CONFIG_LAYER_CONTENT_DIR,
+      CONFIG_LAYER_GAME
+   };
    
    runloop_ctl(RUNLOOP_CTL_SYSTEM_INFO_GET, &system);
 
@@ -1948,6 +2693,15 @@ bool config_load_override(void)
    if (string_is_empty(core_name) || string_is_empty(game_name))
       return false;
 
+   /* Name of the directory the content lives in. */
+   fill_pathname_basedir(content_dir, global->name.base, sizeof(content_dir));
+   len = strlen(content_dir);
+   if (len > 1 && (content_dir[len - 1] == '/' || content_dir[len - 1] == '\\'))
+      content_dir[len - 1] = '\0';
+   content_dir_name = path_basename(content_dir);
+   if (!strcmp(content_dir_name, "."))
+      content_dir_name = NULL;
+
    RARCH_LOG("Overrides: core name: %s\n", core_name);
    RARCH_LOG("Overrides: game name: %s\n", game_name);
 
@@ -1966,57 +2720,63 @@ bool config_load_override(void)
 
    RARCH_LOG("Overrides: config directory: %s\n", config_directory);
 
-   /* Concatenate strings into full paths for core_path, game_path */
+   /* Concatenate strings into full paths for core_path, content_dir_path, game_path */
    fill_pathname_join(core_path, config_directory, core_name, PATH_MAX_LENGTH);
    fill_pathname_join(core_path, core_path, core_name, PATH_MAX_LENGTH);
    strlcat(core_path, ".cfg", PATH_MAX_LENGTH);
 
+   if (!string_is_empty(content_dir_name))
+   {
+      fill_pathname_join(content_dir_path, config_directory, core_name, PATH_MAX_LENGTH);
+      fill_pathname_join(content_dir_path, content_dir_path, content_dir_name, PATH_MAX_LENGTH);
+      strlcat(content_dir_path, ".cfg", PATH_MAX_LENGTH);
+   }
+
    fill_pathname_join(game_path, config_directory, core_name, PATH_MAX_LENGTH);
    fill_pathname_join(game_path, game_path, game_name, PATH_MAX_LENGTH);
    strlcat(game_path, ".cfg", PATH_MAX_LENGTH);
 
-   /* Create a new config file from core_path */
-   new_conf = config_file_new(core_path);
+   /* Overrides are appended in order of precedence, lowest first. */
+   override_paths[0] = core_path;
+   override_paths[1] = content_dir_path;
+   override_paths[2] = game_path;
 
-   /* If a core override exists, add its location to append_config_path */
-   if (new_conf)
+   for (i = 0; i < ARRAY_SIZE(override_paths); i++)
    {
-      config_file_free(new_conf);
+      const char *name = config_layer_names[override_types[i]];
+
+      if (string_is_empty(override_paths[i]))
+         continue;
+
+      /* Parsed once and kept, so config_load_file() below
+       * doesn't have to read it again. */
+      layer = config_layer_get(override_paths[i], override_types[i]);
 
-      if (settings->core_specific_config)
+      if (!layer || !layer->conf)
+      {
+         RARCH_LOG("Overrides: no %s found at %s\n", name, override_paths[i]);
+         continue;
+      }
+
+      if (override_types[i] == CONFIG_LAYER_CORE
+            && settings->core_specific_config)
       {
          RARCH_LOG("Overrides: can't use overrides with with per-core configs, disabling overrides\n");
          return false;
       }
-      RARCH_LOG("Overrides: core-specific overrides found at %s\n", core_path);
-      strlcpy(global->path.append_config, core_path, sizeof(global->path.append_config));
-
-      should_append = true;
-   }
-   else
-      RARCH_LOG("Overrides: no core-specific overrides found at %s\n", core_path);
 
-   /* Create a new config file from game_path */
-   new_conf = config_file_new(game_path);
+      RARCH_LOG("Overrides: %s found at %s\n", name, override_paths[i]);
 
-   /* If a game override exists, add it's location to append_config_path */
-   if (new_conf)
-   {
-      config_file_free(new_conf);
-
-      RARCH_LOG("Overrides: game-specific overrides found at %s\n", game_path);
       if (should_append)
       {
          strlcat(global->path.append_config, "|", sizeof(global->path.append_config));
-         strlcat(global->path.append_config, game_path, sizeof(global->path.append_config));
+         strlcat(global->path.append_config, override_paths[i], sizeof(global->path.append_config));
       }
       else
-         strlcpy(global->path.append_config, game_path, sizeof(global->path.append_config));
+         strlcpy(global->path.append_config, override_paths[i], sizeof(global->path.append_config));
 
       should_append = true;
    }
-   else
-      RARCH_LOG("Overrides: no game-specific overrides found at %s\n", game_path);
 
    if (!should_append)
       return false;
@@ -2037,6 +2797,12 @@ bool config_load_override(void)
    }
 #endif
 
+   if (config_layers_unchanged(global->path.config))
+   {
+      RARCH_LOG("Overrides: configuration overrides already applied\n");
+      return true;
+   }
+
    /* Store the libretro_path we're using since it will be overwritten by the override when reloading */
    strlcpy(buf,settings->libretro,sizeof(buf));
 
@@ -2075,6 +2841,12 @@ bool config_load_override(void)
 
    *global->path.append_config = '\0';
 
+   if (config_layers_unchanged(global->path.config))
+   {
+      RARCH_LOG("Overrides: original configuration still active\n");
+      return true;
+   }
+
    /* Toggle has_save_path to false so it resets */
    global->has_set.save_path  = false;
    global->has_set.state_path = false;
@@ -2109,6 +2881,7 @@ bool config_load_override(void)
 bool config_load_remap(void)
 {
    config_file_t *new_conf                 = NULL;
+   config_layer_t *layer                   = NULL;
    const char *core_name                   = NULL;
    const char *game_name                   = NULL;
    char remap_directory[PATH_MAX_LENGTH]   = {0};    /* path to the directory containing retroarch.cfg (prefix)    */
@@ -2153,14 +2926,14 @@ bool config_load_remap(void)
    fill_pathname_join(game_path, game_path, game_name, PATH_MAX_LENGTH);
    strlcat(game_path, ".rmp", PATH_MAX_LENGTH);
 
-   /* Create a new config file from game_path */
-   new_conf = config_file_new(game_path);
-
    /* If a game remap file exists, load it. */
-   if (new_conf)
+   layer = config_layer_get(game_path, CONFIG_LAYER_REMAP);
+   if (layer && layer->conf)
    {
       RARCH_LOG("Remaps: game-specific remap found at %s\n", game_path);
-      if (input_remapping_load_file(new_conf, game_path))
+      /* input_remapping_load_file() takes ownership, hand it a copy. */
+      new_conf = config_layers_merge(&layer, 1);
+      if (new_conf && input_remapping_load_file(new_conf, game_path))
       {
          runloop_msg_queue_push("Game remap file loaded", 1, 100, true);
          return true;
@@ -2173,14 +2946,13 @@ bool config_load_remap(void)
       input_remapping_set_defaults();
    }
 
-   /* Create a new config file from core_path */
-   new_conf = config_file_new(core_path);
-
    /* If a core remap file exists, load it. */
-   if (new_conf)
+   layer = config_layer_get(core_path, CONFIG_LAYER_REMAP);
+   if (layer && layer->conf)
    {
       RARCH_LOG("Remaps: core-specific remap found at %s\n", core_path);
-      if (input_remapping_load_file(new_conf, core_path))
+      new_conf = config_layers_merge(&layer, 1);
+      if (new_conf && input_remapping_load_file(new_conf, core_path))
       {
          runloop_msg_queue_push("Core remap file loaded", 1, 100, true);
          return true;
@@ -2226,19 +2998,22 @@ static void parse_config_file(void)
 #if 0
 static bool config_read_keybinds(const char *path)
 {
+   config_index_t idx;
    config_file_t *conf = (config_file_t*)config_file_new(path);
 
    if (!conf)
       return false;
 
-   config_read_keybinds_conf(conf);
+   config_index_init(&idx, conf);
+   config_read_keybinds_conf(conf, &idx);
+   config_index_free(&idx);
    config_file_free(conf);
 
    return true;
 }
 #endif
 
-static void save_keybind_key(config_file_t *conf, const char *prefix,
+static void save_keybind_key(config_index_t *idx, const char *prefix,
       const char *base, const struct retro_keybind *bind)
 {
    char key[64] = {0};
@@ -2247,10 +3022,10 @@ static void save_keybind_key(config_file_t *conf, const char *prefix,
    fill_pathname_join_delim(key, prefix, base, '_', sizeof(key));
 
    input_keymaps_translate_rk_to_str(bind->key, btn, sizeof(btn));
-   config_set_string(conf, key, btn);
+   config_index_set(idx, key, btn);
 }
 
-static void save_keybind_hat(config_file_t *conf, const char *key,
+static void save_keybind_hat(config_index_t *idx, const char *key,
       const struct retro_keybind *bind)
 {
    char config[16]  = {0};
@@ -2281,10 +3056,10 @@ static void save_keybind_hat(config_file_t *conf, const char *key,
    }
 
    snprintf(config, sizeof(config), "h%u%s", hat, dir);
-   config_set_string(conf, key, config);
+   config_index_set(idx, key, config);
 }
 
-static void save_keybind_joykey(config_file_t *conf, const char *prefix,
+static void save_keybind_joykey(config_index_t *idx, const char *prefix,
       const char *base, const struct retro_keybind *bind, bool save_empty)
 {
    char key[64] = {0};
@@ -2295,15 +3070,19 @@ static void save_keybind_joykey(config_file_t *conf, const char *prefix,
    if (bind->joykey == NO_BTN)
    {
        if (save_empty)
-         config_set_string(conf, key, "nul");
+         config_index_set(idx, key, "nul");
    }
    else if (GET_HAT_DIR(bind->joykey))
-      save_keybind_hat(conf, key, bind);
+      save_keybind_hat(idx, key, bind);
    else
-      config_set_uint64(conf, key, bind->joykey);
+   {
+      char config[32] = {0};
+      snprintf(config, sizeof(config), "%u", (unsigned)bind->joykey);
+      config_index_set(idx, key, config);
+   }
 }
 
-static void save_keybind_axis(config_file_t *conf, const char *prefix,
+static void save_keybind_axis(config_index_t *idx, const char *prefix,
       const char *base, const struct retro_keybind *bind, bool save_empty)
 {
    char key[64]    = {0};
@@ -2316,7 +3095,7 @@ static void save_keybind_axis(config_file_t *conf, const char *prefix,
    if (bind->joyaxis == AXIS_NONE)
    {
       if (save_empty)
-         config_set_string(conf, key, "nul");
+         config_index_set(idx, key, "nul");
    }
    else if (AXIS_NEG_GET(bind->joyaxis) != AXIS_DIR_NONE)
    {
@@ -2333,13 +3112,13 @@ static void save_keybind_axis(config_file_t *conf, const char *prefix,
    {
       char config[16];
       snprintf(config, sizeof(config), "%c%u", dir, axis);
-      config_set_string(conf, key, config);
+      config_index_set(idx, key, config);
    }
 }
 
 /**
  * save_keybind:
- * @conf               : pointer to config file object
+ * @idx                : index of the config file
  * @prefix             : prefix name of keybind
  * @base               : base name   of keybind
  * @bind               : pointer to key binding object
@@ -2347,25 +3126,25 @@ static void save_keybind_axis(config_file_t *conf, const char *prefix,
  *
  * Save a key binding to the config file.
  */
-static void save_keybind(config_file_t *conf, const char *prefix,
+static void save_keybind(config_index_t *idx, const char *prefix,
       const char *base, const struct retro_keybind *bind, bool save_kb, bool save_empty)
 {
    if (!bind->valid)
       return;
    if (save_kb)
-      save_keybind_key(conf, prefix, base, bind);
-   save_keybind_joykey(conf, prefix, base, bind, save_empty);
-   save_keybind_axis(conf, prefix, base, bind, save_empty);
+      save_keybind_key(idx, prefix, base, bind);
+   save_keybind_joykey(idx, prefix, base, bind, save_empty);
+   save_keybind_axis(idx, prefix, base, bind, save_empty);
 }
 
 /**
  * save_keybinds_user:
- * @conf               : pointer to config file object
+ * @idx                : index of the config file
  * @user               : user number
  *
- * Save the current keybinds of a user (@user) to the config file (@conf).
+ * Save the current keybinds of a user (@user) to the config file.
  */
-static void save_keybinds_user(config_file_t *conf, unsigned user)
+static void save_keybinds_user(config_index_t *idx, unsigned user)
 {
    unsigned i = 0;
    settings_t *settings = config_get_ptr();
@@ -2376,7 +3155,7 @@ static void save_keybinds_user(config_file_t *conf, unsigned user)
             input_config_bind_map_get_meta(i));
 
       if (prefix)
-         save_keybind(conf, prefix, input_config_bind_map_get_base(i),
+         save_keybind(idx, prefix, input_config_bind_map_get_base(i),
                &settings->input.binds[user][i], true, true);
    }
 }
@@ -2408,6 +3187,49 @@ void config_load(void)
 
    /* Per-core config handling. */
    config_load_core_specific();
+
+   msg_hash_set_language(settings->user_language);
+   retro_main_log_set_level(settings->frontend_log_level);
+}
+
+/**
+ * config_file_write_atomic:
+ * @conf            : Config file to write.
+ * @path            : Path that shall be written to.
+ *
+ * Writes @conf to a temporary file next to @path and
+ * renames it over @path, so an interrupted save never
+ * leaves a truncated config file behind.
+ *
+ * Returns: true (1) on success, otherwise returns false (0).
+ **/
+bool config_file_write_atomic(config_file_t *conf, const char *path)
+{
+   char tmp_path[PATH_MAX_LENGTH] = {0};
+
+   if (!conf || !path || !*path)
+      return false;
+
+   snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+   if (!config_file_write(conf, tmp_path))
+      goto error;
+
+#ifdef _WIN32
+   /* rename() does not replace existing files on Windows. */
+   remove(path);
+#endif
+   if (rename(tmp_path, path) != 0)
+   {
+      remove(tmp_path);
+      goto error;
+   }
+
+   return true;
+
+error:
+   RARCH_ERR("Failed to write config file: \"%s\".\n", path);
+   return false;
 }
 
 /**
@@ -2422,6 +3244,7 @@ bool config_save_keybinds_file(const char *path)
 {
    unsigned          i = 0;
    bool            ret = false;
+   config_index_t  idx;
    config_file_t *conf = config_file_new(path);
 
    if (!conf)
@@ -2432,10 +3255,14 @@ bool config_save_keybinds_file(const char *path)
 
    RARCH_LOG("Saving keybinds config at path: \"%s\"\n", path);
 
+   config_index_init(&idx, conf);
+
    for (i = 0; i < MAX_USERS; i++)
-      save_keybinds_user(conf, i);
+      save_keybinds_user(&idx, i);
 
-   ret = config_file_write(conf, path);
+   config_index_free(&idx);
+
+   ret = config_file_write_atomic(conf, path);
    config_file_free(conf);
    return ret;
 }
@@ -2451,6 +3278,7 @@ bool config_save_autoconf_profile(const char *path, unsigned user)
 {
    unsigned i;
    int ret = false;
+   config_index_t idx;
    char buf[PATH_MAX_LENGTH]            = {0};
    char autoconf_file[PATH_MAX_LENGTH]  = {0};
    config_file_t *conf                  = NULL;
@@ -2490,12 +3318,16 @@ bool config_save_autoconf_profile(const char *path, unsigned user)
       config_set_int(conf, "input_product_id", settings->input.pid[user]);
    }
 
+   config_index_init(&idx, conf);
+
    for (i = 0; i < RARCH_FIRST_META_KEY; i++)
    {
-      save_keybind(conf, "input", input_config_bind_map_get_base(i),
+      save_keybind(&idx, "input", input_config_bind_map_get_base(i),
             &settings->input.binds[user][i], false, false);
    }
-   ret = config_file_write(conf, autoconf_file);
+
+   config_index_free(&idx);
+   ret = config_file_write_atomic(conf, autoconf_file);
    config_file_free(conf);
 
    return ret;
@@ -2505,7 +3337,9 @@ bool config_save_autoconf_profile(const char *path, unsigned user)
  * config_save_file:
  * @path            : Path that shall be written to.
  *
- * Writes a config file to disk.
+ * Writes a config file to disk. Keys not known to
+ * RetroArch are kept. If no setting changed since the
+ * file was last written, the file is left untouched.
  *
  * Returns: true (1) on success, otherwise returns false (0).
  **/
@@ -2513,345 +3347,98 @@ bool config_save_file(const char *path)
 {
    unsigned i           = 0;
    bool ret             = false;
+   bool exists          = true;
+   uint32_t checksum    = 0;
+   config_index_t idx;
    config_file_t *conf  = config_file_new(path);
    settings_t *settings = config_get_ptr();
    global_t   *global   = global_get_ptr();
 
    if (!conf)
-      conf = config_file_new(NULL);
+   {
+      exists = false;
+      conf   = config_file_new(NULL);
+   }
 
    if (!conf || runloop_ctl(RUNLOOP_CTL_IS_OVERRIDES_ACTIVE, NULL))
       return false;
 
-   RARCH_LOG("Saving config at path: \"%s\"\n", path);
-
-   config_set_int(conf, "input_turbo_period", settings->input.turbo_period);
-   config_set_int(conf, "input_duty_cycle", settings->input.turbo_duty_cycle);
-   config_set_int(conf, "input_max_users", settings->input.max_users);
-   config_set_int(conf, "input_menu_toggle_gamepad_combo", settings->input.menu_toggle_gamepad_combo);
-   config_set_float(conf, "input_axis_threshold",
-         settings->input.axis_threshold);
-   config_set_bool(conf, "ui_companion_start_on_boot", settings->ui.companion_start_on_boot);
-   config_set_bool(conf, "video_gpu_record", settings->video.gpu_record);
-   config_set_bool(conf, "input_remap_binds_enable",
-         settings->input.remap_binds_enable);
-   config_set_bool(conf, "back_as_menu_toggle_enable",
-         settings->input.back_as_menu_toggle_enable);
-   config_set_bool(conf, "netplay_client_swap_input",
-         settings->input.netplay_client_swap_input);
-   config_set_bool(conf, "input_descriptor_label_show",
-         settings->input.input_descriptor_label_show);
-   config_set_bool(conf, "input_descriptor_hide_unbound",
-         settings->input.input_descriptor_hide_unbound);
-   config_set_bool(conf,  "load_dummy_on_core_shutdown",
-         settings->load_dummy_on_core_shutdown);
-   config_set_bool(conf,  "builtin_mediaplayer_enable",
-         settings->multimedia.builtin_mediaplayer_enable);
-   config_set_bool(conf,  "builtin_imageviewer_enable",
-         settings->multimedia.builtin_imageviewer_enable);
-   config_set_bool(conf,  "fps_show", settings->fps_show);
-   config_set_bool(conf,  "ui_menubar_enable", settings->ui.menubar_enable);
-   config_set_path(conf,  "libretro_path", settings->libretro);
-   config_set_path(conf,  "core_options_path", settings->core_options_path);
-
-   config_set_path(conf,  "recording_output_directory", global->record.output_dir);
-   config_set_path(conf,  "recording_config_directory", global->record.config_dir);
-
-   config_set_bool(conf,  "suspend_screensaver_enable", settings->ui.suspend_screensaver_enable);
-   config_set_path(conf,  "libretro_directory", settings->libretro_directory);
-   config_set_path(conf,  "libretro_info_path", settings->libretro_info_path);
-   config_set_path(conf,  "content_database_path", settings->content_database);
-   config_set_path(conf,  "cheat_database_path", settings->cheat_database);
-   config_set_path(conf,  "cursor_directory", settings->cursor_directory);
-   config_set_path(conf,  "content_history_dir", settings->content_history_directory);
-   config_set_bool(conf,  "rewind_enable", settings->rewind_enable);
-   config_set_int(conf,   "audio_latency", settings->audio.latency);
-   config_set_bool(conf,  "audio_sync",    settings->audio.sync);
-   config_set_int(conf,   "audio_block_frames", settings->audio.block_frames);
-   config_set_int(conf,   "rewind_granularity", settings->rewind_granularity);
-   config_set_path(conf,  "video_shader", settings->video.shader_path);
-   config_set_bool(conf,  "video_shader_enable",
-         settings->video.shader_enable);
-   config_set_float(conf, "video_aspect_ratio", settings->video.aspect_ratio);
-   config_set_bool(conf,  "video_aspect_ratio_auto", settings->video.aspect_ratio_auto);
-   config_set_bool(conf,  "video_windowed_fullscreen",
-         settings->video.windowed_fullscreen);
-   config_set_float(conf, "video_scale", settings->video.scale);
-   config_set_int(conf,   "autosave_interval", settings->autosave_interval);
-   config_set_bool(conf,  "video_crop_overscan", settings->video.crop_overscan);
-   config_set_bool(conf,  "video_scale_integer", settings->video.scale_integer);
-#ifdef GEKKO
-   config_set_int(conf,   "video_viwidth", settings->video.viwidth);
-   config_set_bool(conf,  "video_vfilter", settings->video.vfilter);
-#endif
-   config_set_bool(conf,  "video_smooth", settings->video.smooth);
-   config_set_bool(conf,  "video_threaded", settings->video.threaded);
-   config_set_bool(conf,  "video_shared_context",
-         settings->video.shared_context);
-   config_set_bool(conf,  "video_force_srgb_disable",
-         settings->video.force_srgb_disable);
-   config_set_bool(conf,  "video_fullscreen", settings->video.fullscreen);
-   config_set_bool(conf,  "bundle_assets_extract_enable", settings->bundle_assets_extract_enable);
-   config_set_int(conf,  "bundle_assets_extract_version_current", settings->bundle_assets_extract_version_current);
-   config_set_int(conf,  "bundle_assets_extract_last_version", settings->bundle_assets_extract_last_version);
-   config_set_string(conf,  "bundle_assets_src_path", settings->bundle_assets_src_path);
-   config_set_string(conf,  "bundle_assets_dst_path", settings->bundle_assets_dst_path);
-   config_set_string(conf,  "bundle_assets_dst_path_subdir", settings->bundle_assets_dst_path_subdir);
-   config_set_string(conf,  "playlist_names", settings->playlist_names);
-   config_set_string(conf,  "playlist_cores", settings->playlist_cores);
-   config_set_float(conf, "video_refresh_rate", settings->video.refresh_rate);
-   config_set_int(conf,   "video_monitor_index",
-         settings->video.monitor_index);
-   config_set_int(conf,    "video_fullscreen_x", settings->video.fullscreen_x);
-   config_set_int(conf,    "video_fullscreen_y", settings->video.fullscreen_y);
-   config_set_string(conf, "video_driver", settings->video.driver);
-   config_set_string(conf, "record_driver", settings->record.driver);
-   config_set_string(conf, "camera_driver", settings->camera.driver);
-   config_set_string(conf, "location_driver", settings->location.driver);
-#ifdef HAVE_MENU
-#ifdef HAVE_THREADS
-   config_set_bool(conf,"threaded_data_runloop_enable",
-         settings->threaded_data_runloop_enable);
-#endif
-
-   config_set_bool(conf, "dpi_override_enable", settings->menu.dpi.override_enable);
-   config_set_int (conf, "dpi_override_value", settings->menu.dpi.override_value);
-   config_set_string(conf,"menu_driver", settings->menu.driver);
-   config_set_bool(conf,"menu_pause_libretro", settings->menu.pause_libretro);
-   config_set_bool(conf,"menu_mouse_enable", settings->menu.mouse.enable);
-   config_set_bool(conf,"menu_pointer_enable", settings->menu.pointer.enable);
-   config_set_bool(conf,"menu_timedate_enable", settings->menu.timedate_enable);
-   config_set_bool(conf,"menu_core_enable", settings->menu.core_enable);
-   config_set_bool(conf,"menu_dynamic_wallpaper_enable",
-         settings->menu.dynamic_wallpaper_enable);
-   config_set_bool(conf,"menu_boxart_enable", settings->menu.boxart_enable);
-   config_set_path(conf, "menu_wallpaper", settings->menu.wallpaper);
-#endif
-   config_set_bool(conf,  "video_vsync", settings->video.vsync);
-   config_set_bool(conf,  "video_hard_sync", settings->video.hard_sync);
-   config_set_int(conf,   "video_hard_sync_frames",
-         settings->video.hard_sync_frames);
-   config_set_int(conf,   "video_frame_delay", settings->video.frame_delay);
-   config_set_bool(conf,  "video_black_frame_insertion",
-         settings->video.black_frame_insertion);
-   config_set_bool(conf,  "video_disable_composition",
-         settings->video.disable_composition);
-   config_set_bool(conf,  "pause_nonactive", settings->pause_nonactive);
-   config_set_int(conf, "video_swap_interval", settings->video.swap_interval);
-   config_set_bool(conf, "video_gpu_screenshot", settings->video.gpu_screenshot);
-   config_set_int(conf, "video_rotation", settings->video.rotation);
-   config_set_path(conf, "screenshot_directory",
-         *settings->screenshot_directory ?
-         settings->screenshot_directory : "default");
-   config_set_int(conf, "aspect_ratio_index", settings->video.aspect_ratio_idx);
-   config_set_string(conf, "audio_device", settings->audio.device);
-   config_set_string(conf, "video_filter", settings->video.softfilter_plugin);
-   config_set_string(conf, "audio_dsp_plugin", settings->audio.dsp_plugin);
-   config_set_string(conf, "core_updater_buildbot_url",
-         settings->network.buildbot_url);
-   config_set_string(conf, "core_updater_buildbot_assets_url",
-         settings->network.buildbot_assets_url);
-   config_set_bool(conf, "core_updater_auto_extract_archive",
-         settings->network.buildbot_auto_extract_archive);
-   config_set_string(conf, "camera_device", settings->camera.device);
-   config_set_bool(conf, "camera_allow", settings->camera.allow);
-
-#ifdef HAVE_CHEEVOS
-   config_set_bool(conf, "cheevos_enable", settings->cheevos.enable);
-   config_set_bool(conf, "cheevos_test_unofficial", settings->cheevos.test_unofficial);
-   config_set_string(conf, "cheevos_username", settings->cheevos.username);
-   config_set_string(conf, "cheevos_password", settings->cheevos.password);
-#endif
-
-   config_set_bool(conf, "audio_rate_control", settings->audio.rate_control);
-   config_set_float(conf, "audio_rate_control_delta",
-         settings->audio.rate_control_delta);
-   config_set_float(conf, "audio_max_timing_skew",
-         settings->audio.max_timing_skew);
-   config_set_float(conf, "audio_volume", settings->audio.volume);
-   config_set_string(conf, "video_context_driver", settings->video.context_driver);
-   config_set_string(conf, "audio_driver", settings->audio.driver);
-   config_set_bool(conf, "audio_enable", settings->audio.enable);
-   config_set_bool(conf, "audio_mute_enable", settings->audio.mute_enable);
-   config_set_int(conf, "audio_out_rate", settings->audio.out_rate);
-
-   config_set_bool(conf, "location_allow", settings->location.allow);
+   config_index_init(&idx, conf);
+   config_settings_save(&idx, settings);
 
-   config_set_float(conf, "video_font_size", settings->video.font_size);
-   config_set_bool(conf,  "video_font_enable", settings->video.font_enable);
+   CONFIG_INDEX_SET(&idx, "video_fullscreen",
+         CONFIG_SETTING_BOOL, settings->video.fullscreen);
+   CONFIG_INDEX_SET(&idx, "libretro_path",
+         CONFIG_SETTING_PATH, settings->libretro);
+   CONFIG_INDEX_SET(&idx, "libretro_directory",
+         CONFIG_SETTING_PATH, settings->libretro_directory);
+   CONFIG_INDEX_SET(&idx, "recording_output_directory",
+         CONFIG_SETTING_PATH, global->record.output_dir);
+   CONFIG_INDEX_SET(&idx, "recording_config_directory",
+         CONFIG_SETTING_PATH, global->record.config_dir);
 
    if (!global->has_set.ups_pref)
-      config_set_bool(conf, "ups_pref", global->patch.ups_pref);
+      CONFIG_INDEX_SET(&idx, "ups_pref", CONFIG_SETTING_BOOL, global->patch.ups_pref);
    if (!global->has_set.bps_pref)
-      config_set_bool(conf, "bps_pref", global->patch.bps_pref);
+      CONFIG_INDEX_SET(&idx, "bps_pref", CONFIG_SETTING_BOOL, global->patch.bps_pref);
    if (!global->has_set.ips_pref)
-      config_set_bool(conf, "ips_pref", global->patch.ips_pref);
-
-   config_set_path(conf, "system_directory",
-         *settings->system_directory ?
-         settings->system_directory : "default");
-   config_set_path(conf, "cache_directory",
-         settings->cache_directory);
-   config_set_path(conf, "input_remapping_directory",
-         settings->input_remapping_directory);
-   config_set_path(conf, "input_remapping_path",
-        settings->input.remapping_path);
-   config_set_path(conf, "resampler_directory",
-         settings->resampler_directory);
-   config_set_string(conf, "audio_resampler", settings->audio.resampler);
-   config_set_path(conf, "savefile_directory",
-         *global->dir.savefile ? global->dir.savefile : "default");
-   config_set_path(conf, "savestate_directory",
-         *global->dir.savestate ? global->dir.savestate : "default");
-   config_set_path(conf, "video_shader_dir",
-         *settings->video.shader_dir ?
-         settings->video.shader_dir : "default");
-   config_set_path(conf, "video_filter_dir",
-         *settings->video.filter_dir ?
-         settings->video.filter_dir : "default");
-   config_set_path(conf, "audio_filter_dir",
-         *settings->audio.filter_dir ?
-         settings->audio.filter_dir : "default");
-
-   config_set_path(conf, "core_assets_directory",
-         *settings->core_assets_directory ?
-         settings->core_assets_directory : "default");
-   config_set_path(conf, "assets_directory",
-         *settings->assets_directory ?
-         settings->assets_directory : "default");
-   config_set_path(conf, "dynamic_wallpapers_directory",
-         *settings->dynamic_wallpapers_directory ?
-         settings->dynamic_wallpapers_directory : "default");
-   config_set_path(conf, "boxarts_directory",
-         *settings->boxarts_directory ?
-         settings->boxarts_directory : "default");
-   config_set_path(conf, "playlist_directory",
-         *settings->playlist_directory ?
-         settings->playlist_directory : "default");
-#ifdef HAVE_MENU
-   config_set_path(conf, "rgui_browser_directory",
-         *settings->menu_content_directory ?
-         settings->menu_content_directory : "default");
-   config_set_path(conf, "rgui_config_directory",
-         *settings->menu_config_directory ?
-         settings->menu_config_directory : "default");
-   config_set_bool(conf, "rgui_show_start_screen",
-         settings->menu_show_start_screen);
-   config_set_bool(conf, "menu_navigation_wraparound_enable",
-         settings->menu.navigation.wraparound.enable);
-   config_set_bool(conf,
-         "menu_navigation_browser_filter_supported_extensions_enable",
-         settings->menu.navigation.browser.filter.supported_extensions_enable);
-   config_set_bool(conf, "menu_show_advanced_settings",
-         settings->menu.show_advanced_settings);
-   config_set_hex(conf, "menu_entry_normal_color",
-         settings->menu.entry_normal_color);
-   config_set_hex(conf, "menu_entry_hover_color",
-         settings->menu.entry_hover_color);
-   config_set_hex(conf, "menu_title_color",
-         settings->menu.title_color);
-#endif
-
-   config_set_path(conf, "content_history_path", settings->content_history_path);
-   config_set_int(conf, "content_history_size", settings->content_history_size);
-   config_set_path(conf, "joypad_autoconfig_dir",
-         settings->input.autoconfig_dir);
-   config_set_bool(conf, "input_autodetect_enable",
-         settings->input.autodetect_enable);
-
+      CONFIG_INDEX_SET(&idx, "ips_pref", CONFIG_SETTING_BOOL, global->patch.ips_pref);
+
+   config_index_put(&idx, "system_directory", CONFIG_SETTING_PATH,
+         settings->system_directory, sizeof(settings->system_directory),
+         CONFIG_SETTING_FLAG_SAVE_DEFAULT);
+   config_index_put(&idx, "savefile_directory", CONFIG_SETTING_PATH,
+         global->dir.savefile, sizeof(global->dir.savefile),
+         CONFIG_SETTING_FLAG_SAVE_DEFAULT);
+   config_index_put(&idx, "savestate_directory", CONFIG_SETTING_PATH,
+         global->dir.savestate, sizeof(global->dir.savestate),
+         CONFIG_SETTING_FLAG_SAVE_DEFAULT);
 #ifdef HAVE_OVERLAY
-   config_set_path(conf, "overlay_directory",
-         *settings->overlay_directory ? settings->overlay_directory : "default");
-   config_set_path(conf, "input_overlay", settings->input.overlay);
-   config_set_bool(conf, "input_overlay_enable", settings->input.overlay_enable);
-   config_set_bool(conf, "input_overlay_enable_autopreferred", settings->input.overlay_enable_autopreferred);
-   config_set_bool(conf, "input_overlay_hide_in_menu", settings->input.overlay_hide_in_menu);
-   config_set_float(conf, "input_overlay_opacity",
-         settings->input.overlay_opacity);
-   config_set_float(conf, "input_overlay_scale",
-         settings->input.overlay_scale);
-
-   config_set_path(conf, "osk_overlay_directory",
-         *global->dir.osk_overlay ? global->dir.osk_overlay : "default");
-   config_set_path(conf, "input_osk_overlay", settings->osk.overlay);
-   config_set_bool(conf, "input_osk_overlay_enable", settings->osk.enable);
+   config_index_put(&idx, "osk_overlay_directory", CONFIG_SETTING_PATH,
+         global->dir.osk_overlay, sizeof(global->dir.osk_overlay),
+         CONFIG_SETTING_FLAG_SAVE_DEFAULT);
 #endif
 
-   config_set_path(conf, "video_font_path", settings->video.font_path);
-   config_set_float(conf, "video_message_pos_x", settings->video.msg_pos_x);
-   config_set_float(conf, "video_message_pos_y", settings->video.msg_pos_y);
-
-   config_set_int(conf, "custom_viewport_width",
-         settings->video_viewport_custom.width);
-   config_set_int(conf, "custom_viewport_height",
-         settings->video_viewport_custom.height);
-   config_set_int(conf, "custom_viewport_x",
-         settings->video_viewport_custom.x);
-   config_set_int(conf, "custom_viewport_y",
-         settings->video_viewport_custom.y);
-
+   /* The video driver writes to the config file directly. */
+   checksum = config_file_checksum(conf);
    video_driver_ctl(RARCH_DISPLAY_CTL_SAVE_SETTINGS, conf);
-
-   config_set_float(conf, "video_font_size", settings->video.font_size);
-
-   config_set_bool(conf, "block_sram_overwrite",
-         settings->block_sram_overwrite);
-   config_set_bool(conf, "savestate_auto_index",
-         settings->savestate_auto_index);
-   config_set_bool(conf, "savestate_auto_save",
-         settings->savestate_auto_save);
-   config_set_bool(conf, "savestate_auto_load",
-         settings->savestate_auto_load);
-   config_set_bool(conf, "history_list_enable",
-         settings->history_list_enable);
-
-#ifdef HAVE_COMMAND
-   config_set_bool(conf, "network_cmd_enable",
-         settings->network_cmd_enable);
-   config_set_bool(conf, "stdin_cmd_enable",
-         settings->stdin_cmd_enable);
-   config_set_int(conf, "network_cmd_port",
-         settings->network_cmd_port);
-#endif
-
-   config_set_float(conf, "fastforward_ratio", settings->fastforward_ratio);
-   config_set_float(conf, "slowmotion_ratio", settings->slowmotion_ratio);
-
-   config_set_bool(conf, "config_save_on_exit",
-         settings->config_save_on_exit);
-   config_set_int(conf, "state_slot", settings->state_slot);
+   if (config_file_checksum(conf) != checksum)
+      idx.dirty = true;
 
 #ifdef HAVE_NETPLAY
-   config_set_bool(conf, "netplay_spectator_mode_enable",
-         global->netplay.is_spectate);
-   config_set_bool(conf, "netplay_mode", global->netplay.is_client);
-   config_set_string(conf, "netplay_ip_address", global->netplay.server);
-   config_set_int(conf, "netplay_ip_port", global->netplay.port);
-   config_set_int(conf, "netplay_delay_frames", global->netplay.sync_frames);
+   CONFIG_INDEX_SET(&idx, "netplay_spectator_mode_enable",
+         CONFIG_SETTING_BOOL, global->netplay.is_spectate);
+   CONFIG_INDEX_SET(&idx, "netplay_mode",
+         CONFIG_SETTING_BOOL, global->netplay.is_client);
+   CONFIG_INDEX_SET(&idx, "netplay_ip_address",
+         CONFIG_SETTING_ARRAY, global->netplay.server);
+   CONFIG_INDEX_SET(&idx, "netplay_ip_port",
+         CONFIG_SETTING_UINT, global->netplay.port);
+   CONFIG_INDEX_SET(&idx, "netplay_delay_frames",
+         CONFIG_SETTING_UINT, global->netplay.sync_frames);
 #endif
-   config_set_string(conf, "netplay_nickname", settings->username);
-   config_set_int(conf, "user_language", settings->user_language);
+   CONFIG_INDEX_SET(&idx, "netplay_nickname",
+         CONFIG_SETTING_ARRAY, settings->username);
 
-   config_set_bool(conf, "custom_bgm_enable",
-         global->console.sound.system_bgm_enable);
+   CONFIG_INDEX_SET(&idx, "custom_bgm_enable",
+         CONFIG_SETTING_BOOL, global->console.sound.system_bgm_enable);
 
-   config_set_string(conf, "input_driver", settings->input.driver);
-   config_set_string(conf, "input_joypad_driver",
-         settings->input.joypad_driver);
-   config_set_string(conf, "input_keyboard_layout",
-         settings->input.keyboard_layout);
    for (i = 0; i < MAX_USERS; i++)
    {
       char cfg[64] = {0};
 
       snprintf(cfg, sizeof(cfg), "input_device_p%u", i + 1);
-      config_set_int(conf, cfg, settings->input.device[i]);
+      CONFIG_INDEX_SET(&idx, cfg, CONFIG_SETTING_UINT,
+            settings->input.device[i]);
       snprintf(cfg, sizeof(cfg), "input_player%u_joypad_index", i + 1);
-      config_set_int(conf, cfg, settings->input.joypad_map[i]);
+      CONFIG_INDEX_SET(&idx, cfg, CONFIG_SETTING_UINT,
+            settings->input.joypad_map[i]);
       snprintf(cfg, sizeof(cfg), "input_libretro_device_p%u", i + 1);
-      config_set_int(conf, cfg, settings->input.libretro_device[i]);
+      CONFIG_INDEX_SET(&idx, cfg, CONFIG_SETTING_UINT,
+            settings->input.libretro_device[i]);
       snprintf(cfg, sizeof(cfg), "input_player%u_analog_dpad_mode", i + 1);
-      config_set_int(conf, cfg, settings->input.analog_dpad_mode[i]);
+      CONFIG_INDEX_SET(&idx, cfg, CONFIG_SETTING_UINT,
+            settings->input.analog_dpad_mode[i]);
    }
 
 #ifdef HAVE_NETWORK_GAMEPAD
@@ -2859,53 +3446,32 @@ bool config_save_file(const char *path)
    {
       char tmp[64] = {0};
       snprintf(tmp, sizeof(tmp), "network_remote_enable_user_p%u", i + 1);
-      config_set_bool(conf, tmp, settings->network_remote_enable_user[i]);
+      CONFIG_INDEX_SET(&idx, tmp, CONFIG_SETTING_BOOL,
+            settings->network_remote_enable_user[i]);
    }
-   config_set_bool(conf, "network_remote_enable", settings->network_remote_enable);
-   config_set_int(conf, "network_remote_base_port", settings->network_remote_base_port);
-
 #endif
+
    for (i = 0; i < MAX_USERS; i++)
-      save_keybinds_user(conf, i);
+      save_keybinds_user(&idx, i);
+
+   config_index_set(&idx, "log_verbosity",
+         *retro_main_verbosity() ? "true" : "false");
+   config_index_set(&idx, "perfcnt_enable",
+         runloop_ctl(RUNLOOP_CTL_IS_PERFCNT_ENABLE, NULL) ? "true" : "false");
 
-   config_set_bool(conf, "core_specific_config",
-         settings->core_specific_config);
-   config_set_bool(conf, "game_specific_options",
-         settings->game_specific_options);
-   config_set_bool(conf, "auto_overrides_enable",
-         settings->auto_overrides_enable);
-   config_set_bool(conf, "auto_remaps_enable",
-         settings->auto_remaps_enable);
-   config_set_bool(conf, "sort_savefiles_enable",
-         settings->sort_savefiles_enable);
-   config_set_bool(conf, "sort_savestates_enable",
-         settings->sort_savestates_enable);
-   config_set_int(conf, "libretro_log_level", settings->libretro_log_level);
-   config_set_bool(conf, "log_verbosity", *retro_main_verbosity());
+   config_index_free(&idx);
 
+   if (exists && !idx.dirty)
    {
-      bool perfcnt_enable = runloop_ctl(RUNLOOP_CTL_IS_PERFCNT_ENABLE, NULL);
-      config_set_bool(conf, "perfcnt_enable", perfcnt_enable);
+      RARCH_LOG("Config at path: \"%s\" is up to date.\n", path);
+      config_file_free(conf);
+      return true;
    }
 
-#if TARGET_OS_IPHONE
-   config_set_bool(conf, "small_keyboard_enable",   settings->input.small_keyboard_enable);
-#endif
-   config_set_bool(conf, "keyboard_gamepad_enable", settings->input.keyboard_gamepad_enable);
-   config_set_int(conf, "keyboard_gamepad_mapping_type", settings->input.keyboard_gamepad_mapping_type);
-
-   config_set_bool(conf, "core_set_supports_no_game_enable",
-         settings->core.set_supports_no_game_enable);
-
-   config_set_int(conf, "menu_ok_btn",          settings->menu_ok_btn);
-   config_set_int(conf, "menu_cancel_btn",      settings->menu_cancel_btn);
-   config_set_int(conf, "menu_search_btn",      settings->menu_search_btn);
-   config_set_int(conf, "menu_info_btn",        settings->menu_info_btn);
-   config_set_int(conf, "menu_default_btn",     settings->menu_default_btn);
-   config_set_int(conf, "menu_scroll_down_btn", settings->menu_scroll_down_btn);
-   config_set_int(conf, "menu_scroll_up_btn",   settings->menu_scroll_up_btn);
+   RARCH_LOG("Saving config at path: \"%s\"\n", path);
 
-   ret = config_file_write(conf, path);
+   ret = config_file_write_atomic(conf, path);
    config_file_free(conf);
+   config_layer_invalidate(path);
    return ret;
 }
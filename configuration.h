@@ -20,6 +20,7 @@
 #include <stdint.h>
 
 #include <boolean.h>
+#include <file/config_file.h>
 
 #include "gfx/video_driver.h"
 #include "driver.h"
@@ -32,6 +33,33 @@
 extern "C" {
 #endif
 
+/* Subsystems a setting feeds into. A changed setting only takes
+ * effect once the subsystems it is tagged with are restarted,
+ * see event_reinit(). */
+enum config_subsystem
+{
+   CONFIG_SUBSYSTEM_NONE       = 0,
+   CONFIG_SUBSYSTEM_AUDIO      = 1 << 0,
+   CONFIG_SUBSYSTEM_VIDEO      = 1 << 1,
+   CONFIG_SUBSYSTEM_INPUT      = 1 << 2,
+   CONFIG_SUBSYSTEM_MENU       = 1 << 3,
+   CONFIG_SUBSYSTEM_CAMERA     = 1 << 4,
+   CONFIG_SUBSYSTEM_LOCATION   = 1 << 5,
+   CONFIG_SUBSYSTEM_OVERLAY    = 1 << 6,
+   CONFIG_SUBSYSTEM_DSP_FILTER = 1 << 7,
+   CONFIG_SUBSYSTEM_REWIND     = 1 << 8,
+   CONFIG_SUBSYSTEM_AUTOSAVE   = 1 << 9
+};
+
+/* Everything EVENT_CMD_REINIT restarts. */
+#define CONFIG_SUBSYSTEM_DRIVERS \
+      ( CONFIG_SUBSYSTEM_AUDIO \
+      | CONFIG_SUBSYSTEM_VIDEO \
+      | CONFIG_SUBSYSTEM_INPUT \
+      | CONFIG_SUBSYSTEM_MENU \
+      | CONFIG_SUBSYSTEM_CAMERA \
+      | CONFIG_SUBSYSTEM_LOCATION )
+
 /* All config related settings go here. */
 
 typedef struct settings
@@ -295,6 +323,19 @@ typedef struct settings
       bool builtin_imageviewer_enable;
    } multimedia;
 
+   /* Synthetic core started with --benchmark. */
+   struct
+   {
+      unsigned width;
+      unsigned height;
+      char pixel_format[32];
+      unsigned audio_batch;
+      unsigned serialize_size;
+      float dirty_ratio;
+      unsigned sram_size;
+      char memory_map[256];
+   } benchmark;
+
 #ifdef HAVE_CHEEVOS
    struct
    {
@@ -322,6 +363,12 @@ typedef struct settings
    char libretro[PATH_MAX_LENGTH];
    char libretro_directory[PATH_MAX_LENGTH];
    unsigned libretro_log_level;
+   unsigned frontend_log_level;
+   unsigned perfcnt_reset_interval;
+   bool perfcnt_hw_enable;
+   unsigned perf_trace_frames;
+   unsigned perf_trace_start_frame;
+   char perf_trace_path[PATH_MAX_LENGTH];
    char libretro_info_path[PATH_MAX_LENGTH];
    char content_database[PATH_MAX_LENGTH];
    char cheat_database[PATH_MAX_LENGTH];
@@ -542,14 +589,53 @@ bool config_save_autoconf_profile(const char *path, unsigned user);
  * config_save_file:
  * @path            : Path that shall be written to.
  *
- * Writes a config file to disk.
+ * Writes a config file to disk. Keys not known to
+ * RetroArch are kept. If no setting changed since the
+ * file was last written, the file is left untouched.
  *
  * Returns: true (1) on success, otherwise returns false (0).
  **/
 bool config_save_file(const char *path);
 
+/**
+ * config_file_write_atomic:
+ * @conf            : Config file to write.
+ * @path            : Path that shall be written to.
+ *
+ * Writes @conf to a temporary file next to @path and
+ * renames it over @path, so an interrupted save never
+ * leaves a truncated config file behind.
+ *
+ * Returns: true (1) on success, otherwise returns false (0).
+ **/
+bool config_file_write_atomic(config_file_t *conf, const char *path);
+
 bool config_realloc(void);
 
+/**
+ * config_get_cache_file_path:
+ * @name            : File name of the cache.
+ * @s               : Output buffer.
+ * @len             : Size of @s.
+ *
+ * Gets the path of a cache file called @name.
+ *
+ * Returns: true (1) if a location is known, otherwise false (0).
+ **/
+bool config_get_cache_file_path(const char *name, char *s, size_t len);
+
+/**
+ * config_get_subsystems:
+ * @key             : Config key of a setting.
+ *
+ * Gets the subsystems that have to be restarted before a
+ * new value of @key takes effect. Settings which are read
+ * on the fly map to CONFIG_SUBSYSTEM_NONE.
+ *
+ * Returns: bitmask of enum config_subsystem.
+ **/
+unsigned config_get_subsystems(const char *key);
+
 void config_free(void);
 
 settings_t *config_get_ptr(void);
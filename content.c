@@ -42,6 +42,7 @@
 #include "general.h"
 #include "dynamic.h"
 #include "movie.h"
+#include "mem_account.h"
 #include "patch.h"
 #include "system.h"
 #include "verbosity.h"
@@ -378,6 +379,7 @@ static bool load_content_dont_need_fullpath(
    }
 
    info->size = len;
+   mem_account_add(MEM_TAG_CONTENT, info->size);
 
    return true;
 }
@@ -528,7 +530,11 @@ static bool load_content(const struct retro_subsystem_info *special,
 
 end:
    for (i = 0; i < content->size; i++)
+   {
+      if (info[i].data)
+         mem_account_sub(MEM_TAG_CONTENT, info[i].size);
       free((void*)info[i].data);
+   }
 
    string_list_free(additional_path_allocs);
    if (info)
@@ -15,11 +15,21 @@
  *  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <ctype.h>
+#include <string.h>
+#include <time.h>
+
 #include <file/file_path.h>
 #include <file/file_extract.h>
+#include <file/config_file.h>
 
 #include "core_info.h"
+#include "core_info_cache.h"
+#include "file_ops.h"
 #include "general.h"
+#include "mem_account.h"
+#include "msg_hash.h"
+#include "performance.h"
 #include "dir_list_special.h"
 #include "config.def.h"
 
@@ -27,6 +37,14 @@
 #include "config.h"
 #endif
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#ifndef CORE_INFO_MAX_THREADS
+#define CORE_INFO_MAX_THREADS 8
+#endif
+
 static void core_info_list_resolve_all_extensions(
       core_info_list_t *core_info_list)
 {
@@ -59,127 +77,554 @@ static void core_info_list_resolve_all_extensions(
    }
 }
 
-static void core_info_list_resolve_all_firmware(
-      core_info_list_t *core_info_list)
+/* Longest extension that gets indexed, anything longer
+ * is not a file extension any core would declare. */
+#define CORE_INFO_EXT_MAX 32
+
+typedef struct core_info_ext
+{
+   char *ext;
+   uint32_t hash;
+   /* Bitset over core_info_list_t::list. */
+   uint32_t *cores;
+} core_info_ext_t;
+
+struct core_info_ext_index
+{
+   core_info_ext_t *slots;
+   size_t cap;
+   /* Size of each bitset in 32-bit words. */
+   size_t words;
+   /* Scratch bitset of the current query. */
+   uint32_t *query;
+   /* Cores ordered by display name. */
+   const core_info_t **sorted;
+   /* Shallow copies of the cores returned by the last query. */
+   core_info_t *supported;
+};
+
+static bool core_info_ext_normalize(const char *ext, char *s)
 {
    size_t i;
-   unsigned c;
 
-   if (!core_info_list)
+   if (!ext)
+      return false;
+
+   if (*ext == '.')
+      ext++;
+
+   for (i = 0; ext[i]; i++)
+   {
+      if (i + 1 >= CORE_INFO_EXT_MAX)
+         return false;
+      s[i] = tolower((unsigned char)ext[i]);
+   }
+
+   s[i] = '\0';
+   return i > 0;
+}
+
+static core_info_ext_t *core_info_ext_index_slot(
+      struct core_info_ext_index *index, const char *ext, uint32_t hash)
+{
+   size_t pos = hash & (index->cap - 1);
+
+   while (index->slots[pos].ext)
+   {
+      if (index->slots[pos].hash == hash
+            && !strcmp(index->slots[pos].ext, ext))
+         break;
+      pos = (pos + 1) & (index->cap - 1);
+   }
+
+   return &index->slots[pos];
+}
+
+static int core_info_display_name_cmp(const void *a_, const void *b_)
+{
+   const core_info_t *a = *(const core_info_t**)a_;
+   const core_info_t *b = *(const core_info_t**)b_;
+
+   if (!a->display_name || !b->display_name)
+      return !a->display_name - !b->display_name;
+   return strcasecmp(a->display_name, b->display_name);
+}
+
+static void core_info_ext_index_free(struct core_info_ext_index *index)
+{
+   size_t i;
+
+   if (!index)
       return;
 
-   for (i = 0; i < core_info_list->count; i++)
+   for (i = 0; i < index->cap; i++)
    {
-      unsigned count        = 0;
-      core_info_t *info     = (core_info_t*)&core_info_list->list[i];
-      config_file_t *config = (config_file_t*)info->config_data;
+      free(index->slots[i].ext);
+      free(index->slots[i].cores);
+   }
 
-      if (!info || !config)
-         continue;
+   free(index->slots);
+   free(index->query);
+   free(index->sorted);
+   free(index->supported);
+   free(index);
+}
 
-      if (!config_get_uint(config, "firmware_count", &count))
-         continue;
+/**
+ * core_info_ext_index_new:
+ * @core_info_list      : Core info list.
+ *
+ * Maps every (lowercase) supported extension to the set of cores
+ * supporting it, so supported cores can be looked up without
+ * walking every core's extension list.
+ *
+ * Returns: new index, or NULL on error.
+ **/
+static struct core_info_ext_index *core_info_ext_index_new(
+      const core_info_list_t *core_info_list)
+{
+   size_t i, j;
+   size_t num_ext                     = 0;
+   struct core_info_ext_index *index  = (struct core_info_ext_index*)
+      calloc(1, sizeof(*index));
 
-      info->firmware = (core_info_firmware_t*)
-         calloc(count, sizeof(*info->firmware));
+   if (!index)
+      return NULL;
 
-      if (!info->firmware)
-         continue;
+   for (i = 0; i < core_info_list->count; i++)
+      if (core_info_list->list[i].supported_extensions_list)
+         num_ext += core_info_list->list[i].supported_extensions_list->size;
+
+   /* Keep the load factor below 1/2, the table never grows. */
+   index->cap = 16;
+   while (index->cap < num_ext * 2)
+      index->cap *= 2;
+
+   index->words     = (core_info_list->count + 31) / 32;
+   index->slots     = (core_info_ext_t*)calloc(index->cap,
+         sizeof(*index->slots));
+   index->query     = (uint32_t*)calloc(index->words + 1,
+         sizeof(*index->query));
+   index->sorted    = (const core_info_t**)calloc(
+         core_info_list->count + 1, sizeof(*index->sorted));
+   index->supported = (core_info_t*)calloc(
+         core_info_list->count + 1, sizeof(*index->supported));
+
+   if (!index->slots || !index->query || !index->sorted || !index->supported)
+      goto error;
 
-      for (c = 0; c < count; c++)
+   for (i = 0; i < core_info_list->count; i++)
+   {
+      const struct string_list *exts =
+         core_info_list->list[i].supported_extensions_list;
+
+      index->sorted[i] = &core_info_list->list[i];
+
+      for (j = 0; exts && j < exts->size; j++)
       {
-         char path_key[64] = {0};
-         char desc_key[64] = {0};
-         char opt_key[64]  = {0};
+         uint32_t hash;
+         core_info_ext_t *slot       = NULL;
+         char ext[CORE_INFO_EXT_MAX] = {0};
+
+         if (!core_info_ext_normalize(exts->elems[j].data, ext))
+            continue;
+
+         hash = msg_hash_calculate(ext);
+         slot = core_info_ext_index_slot(index, ext, hash);
 
-         snprintf(path_key, sizeof(path_key), "firmware%u_path", c);
-         snprintf(desc_key, sizeof(desc_key), "firmware%u_desc", c);
-         snprintf(opt_key, sizeof(opt_key), "firmware%u_opt", c);
+         if (!slot->ext)
+         {
+            slot->cores = (uint32_t*)calloc(index->words,
+                  sizeof(*slot->cores));
+            slot->ext   = strdup(ext);
+            slot->hash  = hash;
 
-         config_get_string(config, path_key, &info->firmware[c].path);
-         config_get_string(config, desc_key, &info->firmware[c].desc);
-         config_get_bool(config, opt_key , &info->firmware[c].optional);
+            if (!slot->cores || !slot->ext)
+               goto error;
+         }
+
+         slot->cores[i / 32] |= 1u << (i % 32);
       }
    }
+
+   qsort(index->sorted, core_info_list->count, sizeof(*index->sorted),
+         core_info_display_name_cmp);
+
+   return index;
+
+error:
+   core_info_ext_index_free(index);
+   return NULL;
 }
 
-void core_info_get_name(const char *path, char *s, size_t len)
+static void core_info_ext_index_union(struct core_info_ext_index *index,
+      const char *ext)
 {
    size_t i;
-   core_info_t *core_info = NULL;
-   core_info_list_t *core_info_list = NULL;
-   settings_t *settings = config_get_ptr();
-   struct string_list *contents = dir_list_new_special(NULL, DIR_LIST_CORES, NULL);
+   const core_info_ext_t *slot = NULL;
+   char norm[CORE_INFO_EXT_MAX] = {0};
 
-   if (!contents)
+   if (!core_info_ext_normalize(ext, norm))
       return;
 
-   core_info_list = (core_info_list_t*)calloc(1, sizeof(*core_info_list));
-   if (!core_info_list)
-      goto error;
+   slot = core_info_ext_index_slot(index, norm, msg_hash_calculate(norm));
+   if (!slot->ext)
+      return;
 
-   core_info = (core_info_t*)calloc(contents->size, sizeof(*core_info));
-   if (!core_info)
-      goto error;
+   for (i = 0; i < index->words; i++)
+      index->query[i] |= slot->cores[i];
+}
 
-   core_info_list->list = core_info;
-   core_info_list->count = contents->size;
+static void core_info_resolve_firmware(core_info_t *info,
+      config_file_t *conf)
+{
+   unsigned c;
+   unsigned count = 0;
 
-   for (i = 0; i < contents->size; i++)
+   if (!config_get_uint(conf, "firmware_count", &count) || !count)
+      return;
+
+   info->firmware = (core_info_firmware_t*)
+      calloc(count, sizeof(*info->firmware));
+
+   if (!info->firmware)
+      return;
+
+   info->firmware_count = count;
+
+   for (c = 0; c < count; c++)
    {
-      config_file_t *conf                  = NULL;
-      char info_path_base[PATH_MAX_LENGTH] = {0};
-      char info_path[PATH_MAX_LENGTH]      = {0};
+      char path_key[64] = {0};
+      char desc_key[64] = {0};
+      char opt_key[64]  = {0};
 
-      core_info[i].path = strdup(contents->elems[i].data);
+      snprintf(path_key, sizeof(path_key), "firmware%u_path", c);
+      snprintf(desc_key, sizeof(desc_key), "firmware%u_desc", c);
+      snprintf(opt_key, sizeof(opt_key), "firmware%u_opt", c);
 
-      if (!core_info[i].path)
-         break;
+      config_get_string(conf, path_key, &info->firmware[c].path);
+      config_get_string(conf, desc_key, &info->firmware[c].desc);
+      config_get_bool(conf, opt_key , &info->firmware[c].optional);
+   }
+}
 
-      if (strcmp(core_info[i].path, path) != 0)
-            continue;
+/**
+ * core_info_parse_config:
+ * @info                : Core info to fill in.
+ * @conf                : Parsed .info file of the core.
+ *
+ * Copies everything we need out of the .info file, so
+ * the config file can be freed right afterwards.
+ **/
+static void core_info_parse_config(core_info_t *info, config_file_t *conf)
+{
+   config_get_string(conf, "display_name",
+         &info->display_name);
+   config_get_string(conf, "corename",
+         &info->core_name);
+   config_get_string(conf, "systemname",
+         &info->systemname);
+   config_get_string(conf, "manufacturer",
+         &info->system_manufacturer);
+   config_get_string(conf, "supported_extensions",
+         &info->supported_extensions);
+   config_get_string(conf, "authors",
+         &info->authors);
+   config_get_string(conf, "permissions",
+         &info->permissions);
+   config_get_string(conf, "license",
+         &info->licenses);
+   config_get_string(conf, "categories",
+         &info->categories);
+   config_get_string(conf, "database",
+         &info->databases);
+   config_get_string(conf, "notes",
+         &info->notes);
+   config_get_bool(conf, "supports_no_game",
+         &info->supports_no_game);
+
+   core_info_resolve_firmware(info, conf);
+}
 
-      fill_pathname_base(info_path_base, contents->elems[i].data,
-            sizeof(info_path_base));
-      path_remove_extension(info_path_base);
+static void core_info_resolve_lists(core_info_t *info)
+{
+   if (info->supported_extensions)
+      info->supported_extensions_list =
+         string_split(info->supported_extensions, "|");
+   if (info->authors)
+      info->authors_list     = string_split(info->authors, "|");
+   if (info->permissions)
+      info->permissions_list = string_split(info->permissions, "|");
+   if (info->licenses)
+      info->licenses_list    = string_split(info->licenses, "|");
+   if (info->categories)
+      info->categories_list  = string_split(info->categories, "|");
+   if (info->databases)
+      info->databases_list   = string_split(info->databases, "|");
+   if (info->notes)
+      info->note_list        = string_split(info->notes, "|");
+}
+
+static const char *core_info_get_info_dir(void)
+{
+   settings_t *settings = config_get_ptr();
+   return (*settings->libretro_info_path) ?
+      settings->libretro_info_path : settings->libretro_directory;
+}
 
+/**
+ * core_info_get_info_path:
+ * @core_path           : Path to the core.
+ * @s                   : Output buffer.
+ * @len                 : Size of @s.
+ *
+ * Builds the path of the .info file describing @core_path.
+ **/
+static void core_info_get_info_path(const char *core_path,
+      char *s, size_t len)
+{
+   char info_path_base[PATH_MAX_LENGTH] = {0};
 #if defined(RARCH_MOBILE) || (defined(RARCH_CONSOLE) && !defined(PSP))
-      char *substr = strrchr(info_path_base, '_');
-      if (substr)
-         *substr = '\0';
+   char *substr                         = NULL;
 #endif
 
-      strlcat(info_path_base, ".info", sizeof(info_path_base));
+   fill_pathname_base(info_path_base, core_path, sizeof(info_path_base));
+   path_remove_extension(info_path_base);
+
+#if defined(RARCH_MOBILE) || (defined(RARCH_CONSOLE) && !defined(PSP))
+   substr = strrchr(info_path_base, '_');
+   if (substr)
+      *substr = '\0';
+#endif
 
-      fill_pathname_join(info_path, (*settings->libretro_info_path) ?
-            settings->libretro_info_path : settings->libretro_directory,
-            info_path_base, sizeof(info_path));
+   strlcat(info_path_base, ".info", sizeof(info_path_base));
+
+   fill_pathname_join(s, core_info_get_info_dir(),
+         info_path_base, len);
+}
+
+void core_info_get_name(const char *path, char *s, size_t len)
+{
+   size_t i;
+   struct string_list *contents = dir_list_new_special(NULL, DIR_LIST_CORES, NULL);
+
+   if (!contents)
+      return;
+
+   for (i = 0; i < contents->size; i++)
+   {
+      config_file_t *conf             = NULL;
+      char *core_name                 = NULL;
+      char info_path[PATH_MAX_LENGTH] = {0};
+
+      if (strcmp(contents->elems[i].data, path) != 0)
+            continue;
+
+      core_info_get_info_path(contents->elems[i].data,
+            info_path, sizeof(info_path));
 
       conf = config_file_new(info_path);
 
-      if (conf)
+      if (!conf)
+         continue;
+
+      if (config_get_string(conf, "corename", &core_name) && core_name)
       {
-         config_get_string(conf, "corename",
-               &core_info[i].core_name);
-         core_info[i].config_data = (void*)conf;
+         strlcpy(s, core_name, len);
+         free(core_name);
       }
 
-      strlcpy(s, core_info[i].core_name, len);
+      config_file_free(conf);
    }
 
-error:
-   if (contents)
-      dir_list_free(contents);
-   contents = NULL;
-   core_info_list_free(core_info_list);
+   dir_list_free(contents);
 }
 
+struct core_info_parse_pool
+{
+   core_info_t *list;
+   /* .info path of every core to parse, NULL for the others. */
+   char **info_paths;
+   size_t count;
+   size_t next;
+#ifdef HAVE_THREADS
+   slock_t *lock;
+#endif
+};
+
+static void core_info_parse_worker(void *data)
+{
+   struct core_info_parse_pool *pool = (struct core_info_parse_pool*)data;
+
+   for (;;)
+   {
+      size_t i;
+      config_file_t *conf = NULL;
+
+#ifdef HAVE_THREADS
+      /* No lock when the calling thread is the only worker. */
+      if (pool->lock)
+         slock_lock(pool->lock);
+#endif
+      while (pool->next < pool->count && !pool->info_paths[pool->next])
+         pool->next++;
+      i = pool->next++;
+#ifdef HAVE_THREADS
+      if (pool->lock)
+         slock_unlock(pool->lock);
+#endif
+
+      if (i >= pool->count)
+         break;
+
+      /* Each slot is only written by the worker that claimed it. */
+      conf = config_file_new(pool->info_paths[i]);
+      if (!conf)
+         continue;
+
+      core_info_parse_config(&pool->list[i], conf);
+      pool->list[i].has_info = true;
+      config_file_free(conf);
+   }
+}
+
+/**
+ * core_info_parse_all:
+ * @list                : Preallocated core info slots.
+ * @info_paths          : .info path for every slot that needs to be
+ *                        parsed, NULL for the others.
+ * @count               : Number of slots.
+ * @num_parse           : Number of non-NULL entries in @info_paths.
+ *
+ * Parses .info files on a worker pool. Every file goes into its
+ * own slot, so the result does not depend on scheduling.
+ **/
+static void core_info_parse_all(core_info_t *list, char **info_paths,
+      size_t count, size_t num_parse)
+{
+   struct core_info_parse_pool pool = {0};
+#ifdef HAVE_THREADS
+   unsigned j;
+   unsigned num_threads             = 1;
+   sthread_t *threads[CORE_INFO_MAX_THREADS] = {NULL};
+#endif
+
+   pool.list       = list;
+   pool.info_paths = info_paths;
+   pool.count      = count;
+
+#ifdef HAVE_THREADS
+   /* Not worth a thread for a couple of files. */
+   num_threads = MIN(retro_get_cpu_cores(), CORE_INFO_MAX_THREADS);
+   num_threads = MIN(num_threads, num_parse / 4);
+
+   if (num_threads > 1)
+      pool.lock = slock_new();
+
+   /* The calling thread is one of the workers. */
+   for (j = 1; pool.lock && j < num_threads; j++)
+      threads[j] = sthread_create(core_info_parse_worker, &pool);
+#endif
+
+   core_info_parse_worker(&pool);
+
+#ifdef HAVE_THREADS
+   for (j = 1; j < num_threads; j++)
+      if (threads[j])
+         sthread_join(threads[j]);
+   if (pool.lock)
+      slock_free(pool.lock);
+#endif
+}
+
+static size_t core_info_strsize(const char *s)
+{
+   return s ? strlen(s) + 1 : 0;
+}
+
+static size_t core_info_string_list_size(const struct string_list *list)
+{
+   size_t i;
+   size_t size = 0;
+
+   if (!list)
+      return 0;
+
+   for (i = 0; i < list->size; i++)
+      size += core_info_strsize(list->elems[i].data);
+   return size + list->cap * sizeof(*list->elems);
+}
+
+/* Approximate heap footprint of the parsed core info,
+ * accounted to MEM_TAG_CORE_INFO. */
+static size_t core_info_list_footprint(const core_info_list_t *core_info_list)
+{
+   size_t i, j;
+   size_t size = sizeof(*core_info_list)
+      + (core_info_list->count + 1) * sizeof(core_info_t)
+      + core_info_strsize(core_info_list->all_ext);
+
+   for (i = 0; i < core_info_list->count; i++)
+   {
+      const core_info_t *info = &core_info_list->list[i];
+
+      size += core_info_strsize(info->path)
+         + core_info_strsize(info->display_name)
+         + core_info_strsize(info->core_name)
+         + core_info_strsize(info->system_manufacturer)
+         + core_info_strsize(info->systemname)
+         + core_info_strsize(info->supported_extensions)
+         + core_info_strsize(info->authors)
+         + core_info_strsize(info->permissions)
+         + core_info_strsize(info->licenses)
+         + core_info_strsize(info->categories)
+         + core_info_strsize(info->databases)
+         + core_info_strsize(info->notes)
+         + core_info_string_list_size(info->categories_list)
+         + core_info_string_list_size(info->databases_list)
+         + core_info_string_list_size(info->note_list)
+         + core_info_string_list_size(info->supported_extensions_list)
+         + core_info_string_list_size(info->authors_list)
+         + core_info_string_list_size(info->permissions_list)
+         + core_info_string_list_size(info->licenses_list)
+         + info->firmware_count * sizeof(*info->firmware);
+
+      for (j = 0; j < info->firmware_count; j++)
+         size += core_info_strsize(info->firmware[j].path)
+            + core_info_strsize(info->firmware[j].desc);
+   }
+
+   return size;
+}
+
+/**
+ * core_info_list_new:
+ *
+ * Builds the list of installed cores along with their metadata.
+ * Parsed .info files are kept in a binary cache; a core whose .info
+ * file did not change (size, mtime) since the cache was written
+ * is filled in from the cache without parsing anything. If the
+ * info directory itself did not change, cores without a .info file
+ * are not even looked up on disk.
+ *
+ * Returns: new core info list, or NULL on error.
+ **/
 core_info_list_t *core_info_list_new(void)
 {
    size_t i;
-   core_info_t *core_info = NULL;
-   core_info_list_t *core_info_list = NULL;
-   settings_t *settings = config_get_ptr();
+   size_t num_parse                     = 0;
+   int64_t info_dir_mtime               = 0;
+   bool check_missing                   = true;
+   bool cache_dirty                     = true;
+   const char *info_dir                 = core_info_get_info_dir();
+   char **info_paths                    = NULL;
+   uint64_t *info_sizes                 = NULL;
+   int64_t *info_mtimes                 = NULL;
+   core_info_cache_t *cache             = NULL;
+   core_info_cache_t *new_cache         = NULL;
+   core_info_t *core_info               = NULL;
+   core_info_list_t *core_info_list     = NULL;
+   char cache_path[PATH_MAX_LENGTH]     = {0};
    struct string_list *contents = dir_list_new_special(NULL, DIR_LIST_CORES, NULL);
 
    if (!contents)
@@ -189,118 +634,374 @@ core_info_list_t *core_info_list_new(void)
    if (!core_info_list)
       goto error;
 
-   core_info = (core_info_t*)calloc(contents->size, sizeof(*core_info));
+   core_info = (core_info_t*)calloc(contents->size + 1, sizeof(*core_info));
    if (!core_info)
       goto error;
 
    core_info_list->list = core_info;
    core_info_list->count = contents->size;
 
+   info_paths  = (char**)calloc(contents->size + 1, sizeof(*info_paths));
+   info_sizes  = (uint64_t*)calloc(contents->size + 1, sizeof(*info_sizes));
+   info_mtimes = (int64_t*)calloc(contents->size + 1, sizeof(*info_mtimes));
+
+   if (!info_paths || !info_sizes || !info_mtimes)
+      goto error;
+
+   file_get_stat(info_dir, NULL, &info_dir_mtime);
+   config_get_cache_file_path(CORE_INFO_CACHE_FILE,
+         cache_path, sizeof(cache_path));
+
+   cache = core_info_cache_load(cache_path, info_dir);
+
+   if (cache && info_dir_mtime
+         && core_info_cache_get_info_dir_mtime(cache) == info_dir_mtime)
+   {
+      check_missing = false;
+      cache_dirty   = core_info_cache_size(cache) != contents->size;
+   }
+
+   /* Fill in everything the cache knows about, and queue
+    * the remaining .info files for parsing. */
    for (i = 0; i < contents->size; i++)
    {
-      config_file_t *conf                  = NULL;
-      char info_path_base[PATH_MAX_LENGTH] = {0};
-      char info_path[PATH_MAX_LENGTH]      = {0};
+      char info_path[PATH_MAX_LENGTH] = {0};
+
       core_info[i].path = strdup(contents->elems[i].data);
 
       if (!core_info[i].path)
          break;
 
-      fill_pathname_base(info_path_base, contents->elems[i].data,
-            sizeof(info_path_base));
-      path_remove_extension(info_path_base);
+      core_info_get_info_path(core_info[i].path,
+            info_path, sizeof(info_path));
 
-#if defined(RARCH_MOBILE) || (defined(RARCH_CONSOLE) && !defined(PSP))
-      char *substr = strrchr(info_path_base, '_');
-      if (substr)
-         *substr = '\0';
-#endif
+      switch (core_info_cache_lookup(cache, info_path, i, check_missing,
+               &info_sizes[i], &info_mtimes[i], &core_info[i]))
+      {
+         case CORE_INFO_CACHE_HIT:
+            core_info[i].has_info = true;
+            break;
+         case CORE_INFO_CACHE_MISS:
+            info_paths[i] = strdup(info_path);
+            num_parse++;
+            cache_dirty   = true;
+            break;
+         case CORE_INFO_CACHE_HIT_NO_INFO:
+            break;
+      }
+   }
 
-      strlcat(info_path_base, ".info", sizeof(info_path_base));
+   core_info_cache_free(cache);
 
-      fill_pathname_join(info_path, (*settings->libretro_info_path) ?
-            settings->libretro_info_path : settings->libretro_directory,
-            info_path_base, sizeof(info_path));
+   if (num_parse)
+      core_info_parse_all(core_info, info_paths, contents->size, num_parse);
 
-      conf = config_file_new(info_path);
+   new_cache = cache_dirty && *cache_path
+      ? core_info_cache_new(info_dir, info_dir_mtime) : NULL;
+
+   for (i = 0; i < contents->size; i++)
+   {
+      if (!core_info[i].path)
+         continue;
 
-      if (conf)
+      if (new_cache)
       {
-         unsigned count = 0;
-         config_get_string(conf, "display_name",
-               &core_info[i].display_name);
-         config_get_string(conf, "corename",
-               &core_info[i].core_name);
-         config_get_string(conf, "systemname",
-               &core_info[i].systemname);
-         config_get_string(conf, "manufacturer",
-               &core_info[i].system_manufacturer);
-         config_get_uint(conf, "firmware_count", &count);
-         core_info[i].firmware_count = count;
-         if (config_get_string(conf, "supported_extensions",
-                  &core_info[i].supported_extensions) &&
-               core_info[i].supported_extensions)
-            core_info[i].supported_extensions_list =
-               string_split(core_info[i].supported_extensions, "|");
-
-         if (config_get_string(conf, "authors",
-                  &core_info[i].authors) &&
-               core_info[i].authors)
-            core_info[i].authors_list =
-               string_split(core_info[i].authors, "|");
-
-         if (config_get_string(conf, "permissions",
-                  &core_info[i].permissions) &&
-               core_info[i].permissions)
-            core_info[i].permissions_list =
-               string_split(core_info[i].permissions, "|");
-
-         if (config_get_string(conf, "license",
-                  &core_info[i].licenses) &&
-               core_info[i].licenses)
-            core_info[i].licenses_list =
-               string_split(core_info[i].licenses, "|");
-
-         if (config_get_string(conf, "categories",
-                  &core_info[i].categories) &&
-               core_info[i].categories)
-            core_info[i].categories_list =
-               string_split(core_info[i].categories, "|");
-
-         if (config_get_string(conf, "database",
-                  &core_info[i].databases) &&
-               core_info[i].databases)
-            core_info[i].databases_list =
-               string_split(core_info[i].databases, "|");
-
-         if (config_get_string(conf, "notes",
-                  &core_info[i].notes) &&
-               core_info[i].notes)
-            core_info[i].note_list = string_split(core_info[i].notes, "|");
-
-         config_get_bool(conf, "supports_no_game",
-               &core_info[i].supports_no_game);
-
-         core_info[i].config_data = conf;
+         char info_path[PATH_MAX_LENGTH] = {0};
+
+         core_info_get_info_path(core_info[i].path,
+               info_path, sizeof(info_path));
+         core_info_cache_add(new_cache, info_path,
+               info_sizes[i], info_mtimes[i],
+               core_info[i].has_info ? &core_info[i] : NULL);
       }
 
+      core_info_resolve_lists(&core_info[i]);
+
       if (!core_info[i].display_name)
          core_info[i].display_name = strdup(path_basename(core_info[i].path));
    }
 
+   if (new_cache)
+      core_info_cache_write(new_cache, cache_path);
+   core_info_cache_free(new_cache);
+
    core_info_list_resolve_all_extensions(core_info_list);
-   core_info_list_resolve_all_firmware(core_info_list);
+   core_info_list->ext_index = core_info_ext_index_new(core_info_list);
 
+   core_info_list->accounted = core_info_list_footprint(core_info_list);
+   mem_account_add(MEM_TAG_CORE_INFO, core_info_list->accounted);
+
+   for (i = 0; i < contents->size; i++)
+      free(info_paths[i]);
+   free(info_paths);
+   free(info_sizes);
+   free(info_mtimes);
    dir_list_free(contents);
    return core_info_list;
 
 error:
+   free(info_paths);
+   free(info_sizes);
+   free(info_mtimes);
    if (contents)
       dir_list_free(contents);
    core_info_list_free(core_info_list);
    return NULL;
 }
 
+/* Listing of one directory below the system directory, used to
+ * answer firmware presence checks without a stat per file. */
+typedef struct core_info_dir_snapshot
+{
+   char *dir;
+   int64_t mtime;
+   /* Taken within the same second the directory was last
+    * modified, so mtime alone can't tell whether it is stale. */
+   bool racy;
+   bool exists;
+   /* Batch the directory was last validated in. */
+   unsigned generation;
+   struct core_info_dir_entry *entries;
+   size_t count;
+   struct string_list *files;
+} core_info_dir_snapshot_t;
+
+struct core_info_dir_entry
+{
+   uint32_t hash;
+   const char *name;
+};
+
+struct core_info_firmware_cache
+{
+   core_info_dir_snapshot_t *snapshots;
+   size_t count;
+   size_t cap;
+   unsigned generation;
+};
+
+static void core_info_firmware_name_normalize(char *s)
+{
+#ifdef _WIN32
+   /* File names are case insensitive. */
+   for (; *s; s++)
+      *s = tolower((unsigned char)*s);
+#endif
+}
+
+static int core_info_dir_entry_cmp(const void *a_, const void *b_)
+{
+   const struct core_info_dir_entry *a = (const struct core_info_dir_entry*)a_;
+   const struct core_info_dir_entry *b = (const struct core_info_dir_entry*)b_;
+
+   if (a->hash != b->hash)
+      return a->hash < b->hash ? -1 : 1;
+   return 0;
+}
+
+static void core_info_dir_snapshot_clear(core_info_dir_snapshot_t *snap)
+{
+   if (snap->files)
+      string_list_free(snap->files);
+   free(snap->entries);
+   snap->files   = NULL;
+   snap->entries = NULL;
+   snap->count   = 0;
+   snap->exists  = false;
+}
+
+static void core_info_dir_snapshot_fill(core_info_dir_snapshot_t *snap,
+      int64_t mtime)
+{
+   size_t i;
+
+   core_info_dir_snapshot_clear(snap);
+
+   snap->mtime  = mtime;
+   snap->racy   = (int64_t)time(NULL) <= mtime;
+   snap->exists = true;
+   snap->files  = dir_list_new(snap->dir, NULL, false, false);
+
+   if (!snap->files || !snap->files->size)
+      return;
+
+   snap->entries = (struct core_info_dir_entry*)
+      calloc(snap->files->size, sizeof(*snap->entries));
+   if (!snap->entries)
+      return;
+
+   for (i = 0; i < snap->files->size; i++)
+   {
+      char *name = snap->files->elems[i].data;
+
+      /* Keep only the base name, in place. */
+      memmove(name, path_basename(name), strlen(path_basename(name)) + 1);
+      core_info_firmware_name_normalize(name);
+      snap->entries[i].hash = msg_hash_calculate(name);
+      snap->entries[i].name = name;
+   }
+
+   snap->count = snap->files->size;
+   qsort(snap->entries, snap->count, sizeof(*snap->entries),
+         core_info_dir_entry_cmp);
+}
+
+static bool core_info_dir_snapshot_has(const core_info_dir_snapshot_t *snap,
+      const char *name)
+{
+   size_t lo = 0;
+   size_t hi = snap->count;
+   uint32_t hash = msg_hash_calculate(name);
+
+   /* Lower bound of hash, then check every entry sharing it. */
+   while (lo < hi)
+   {
+      size_t mid = lo + (hi - lo) / 2;
+      if (snap->entries[mid].hash < hash)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+
+   for (; lo < snap->count && snap->entries[lo].hash == hash; lo++)
+      if (!strcmp(snap->entries[lo].name, name))
+         return true;
+
+   return false;
+}
+
+static core_info_dir_snapshot_t *core_info_firmware_cache_get(
+      struct core_info_firmware_cache *cache, const char *dir)
+{
+   size_t i;
+   int64_t mtime                  = 0;
+   core_info_dir_snapshot_t *snap = NULL;
+
+   for (i = 0; i < cache->count; i++)
+      if (!strcmp(cache->snapshots[i].dir, dir))
+         snap = &cache->snapshots[i];
+
+   if (!snap)
+   {
+      if (cache->count == cache->cap)
+      {
+         size_t new_cap = cache->cap ? cache->cap * 2 : 4;
+         core_info_dir_snapshot_t *new_ptr = (core_info_dir_snapshot_t*)
+            realloc(cache->snapshots, new_cap * sizeof(*new_ptr));
+
+         if (!new_ptr)
+            return NULL;
+
+         cache->snapshots = new_ptr;
+         cache->cap       = new_cap;
+      }
+
+      snap = &cache->snapshots[cache->count];
+      memset(snap, 0, sizeof(*snap));
+
+      if (!(snap->dir = strdup(dir)))
+         return NULL;
+
+      /* Make sure it gets validated below. */
+      snap->generation = cache->generation - 1;
+      cache->count++;
+   }
+
+   /* Stat every directory once per batch of checks. */
+   if (snap->generation == cache->generation)
+      return snap;
+
+   snap->generation = cache->generation;
+
+   if (!file_get_stat(dir, NULL, &mtime))
+      core_info_dir_snapshot_clear(snap);
+   else if (!snap->exists || snap->racy || snap->mtime != mtime)
+      core_info_dir_snapshot_fill(snap, mtime);
+
+   return snap;
+}
+
+static void core_info_firmware_cache_free(
+      struct core_info_firmware_cache *cache)
+{
+   size_t i;
+
+   if (!cache)
+      return;
+
+   for (i = 0; i < cache->count; i++)
+   {
+      core_info_dir_snapshot_clear(&cache->snapshots[i]);
+      free(cache->snapshots[i].dir);
+   }
+
+   free(cache->snapshots);
+   free(cache);
+}
+
+/**
+ * core_info_firmware_exists:
+ * @core_info_list      : Core info list.
+ * @systemdir           : System directory.
+ * @firmware            : Firmware path, relative to @systemdir.
+ *
+ * Looks @firmware up in the listing of its directory. Listings
+ * are only taken again once the directory's mtime changes.
+ * Call core_info_firmware_begin_batch() first.
+ *
+ * Returns: true (1) if @firmware exists, otherwise false (0).
+ **/
+static bool core_info_firmware_exists(core_info_list_t *core_info_list,
+      const char *systemdir, const char *firmware)
+{
+   core_info_dir_snapshot_t *snap  = NULL;
+   char path[PATH_MAX_LENGTH]      = {0};
+   char dir[PATH_MAX_LENGTH]       = {0};
+   char name[PATH_MAX_LENGTH]      = {0};
+
+   fill_pathname_join(path, systemdir, firmware, sizeof(path));
+
+   if (core_info_list->firmware_cache)
+   {
+      fill_pathname_basedir(dir, path, sizeof(dir));
+      snap = core_info_firmware_cache_get(
+            core_info_list->firmware_cache, dir);
+   }
+
+   if (!snap)
+      return path_file_exists(path);
+
+   strlcpy(name, path_basename(path), sizeof(name));
+   core_info_firmware_name_normalize(name);
+   return core_info_dir_snapshot_has(snap, name);
+}
+
+static void core_info_firmware_begin_batch(core_info_list_t *core_info_list)
+{
+   if (!core_info_list->firmware_cache)
+      core_info_list->firmware_cache = (struct core_info_firmware_cache*)
+         calloc(1, sizeof(*core_info_list->firmware_cache));
+
+   if (core_info_list->firmware_cache)
+      core_info_list->firmware_cache->generation++;
+}
+
+static void core_info_update_missing_firmware(
+      core_info_list_t *core_info_list, core_info_t *info,
+      const char *systemdir)
+{
+   size_t i;
+
+   for (i = 0; i < info->firmware_count; i++)
+   {
+      if (!info->firmware[i].path)
+         continue;
+
+      info->firmware[i].missing = !core_info_firmware_exists(
+            core_info_list, systemdir, info->firmware[i].path);
+   }
+}
+
 void core_info_list_free(core_info_list_t *core_info_list)
 {
    size_t i, j;
@@ -308,6 +1009,8 @@ void core_info_list_free(core_info_list_t *core_info_list)
    if (!core_info_list)
       return;
 
+   mem_account_sub(MEM_TAG_CORE_INFO, core_info_list->accounted);
+
    for (i = 0; i < core_info_list->count; i++)
    {
       core_info_t *info = (core_info_t*)&core_info_list->list[i];
@@ -335,7 +1038,6 @@ void core_info_list_free(core_info_list_t *core_info_list)
       string_list_free(info->licenses_list);
       string_list_free(info->categories_list);
       string_list_free(info->databases_list);
-      config_file_free((config_file_t*)info->config_data);
 
       for (j = 0; j < info->firmware_count; j++)
       {
@@ -345,6 +1047,8 @@ void core_info_list_free(core_info_list_t *core_info_list)
       free(info->firmware);
    }
 
+   core_info_ext_index_free(core_info_list->ext_index);
+   core_info_firmware_cache_free(core_info_list->firmware_cache);
    free(core_info_list->all_ext);
    free(core_info_list->list);
    free(core_info_list);
@@ -358,10 +1062,7 @@ size_t core_info_list_num_info_files(core_info_list_t *core_info_list)
       return 0;
 
    for (i = 0; i < core_info_list->count; i++)
-   {
-      config_file_t *conf = (config_file_t*)core_info_list->list[i].config_data;
-      num += !!conf;
-   }
+      num += core_info_list->list[i].has_info;
 
    return num;
 }
@@ -481,72 +1182,55 @@ const char *core_info_list_get_all_extensions(void)
    return list->all_ext;
 }
 
-/* qsort_r() is not in standard C, sadly. */
-static const char *core_info_tmp_path;
-static const struct string_list *core_info_tmp_list;
-
-static int core_info_qsort_cmp(const void *a_, const void *b_)
-{
-   const core_info_t *a = (const core_info_t*)a_;
-   const core_info_t *b = (const core_info_t*)b_;
-   int support_a        = core_info_does_support_any_file(a, core_info_tmp_list) ||
-      core_info_does_support_file(a, core_info_tmp_path);
-   int support_b        = core_info_does_support_any_file(b, core_info_tmp_list) ||
-      core_info_does_support_file(b, core_info_tmp_path);
-
-   if (support_a != support_b)
-      return support_b - support_a;
-   return strcasecmp(a->display_name, b->display_name);
-}
-
+/**
+ * core_info_list_get_supported_cores:
+ * @core_info_list      : Core info list.
+ * @path                : Path to the content.
+ * @infos               : Out: cores supporting @path, by display name.
+ * @num_infos           : Out: number of cores in @infos.
+ *
+ * Finds every core supporting either @path itself or, if @path
+ * is an archive, any of the files inside. Answered from the
+ * extension index, the core list itself is left untouched.
+ **/
 void core_info_list_get_supported_cores(core_info_list_t *core_info_list,
       const char *path, const core_info_t **infos, size_t *num_infos)
 {
-   struct string_list *list = NULL;
-   size_t supported = 0, i;
-
-   if (!core_info_list)
-      return;
+   size_t i;
+   size_t supported                   = 0;
+   struct core_info_ext_index *index  = NULL;
+   struct string_list *list           = NULL;
 
-   (void)list;
+   *infos     = NULL;
+   *num_infos = 0;
 
-   core_info_tmp_path = path;
+   if (!core_info_list || !core_info_list->ext_index || !path)
+      return;
 
-#ifdef HAVE_ZLIB
-   if (!strcasecmp(path_get_extension(path), "zip"))
-      list = zlib_get_file_list(path, NULL);
-   core_info_tmp_list = list;
-#endif
+   index = core_info_list->ext_index;
+   memset(index->query, 0, index->words * sizeof(*index->query));
 
-   /* Let supported core come first in list so we can return 
-    * a pointer to them. */
-   qsort(core_info_list->list, core_info_list->count,
-         sizeof(core_info_t), core_info_qsort_cmp);
+   core_info_ext_index_union(index, path_get_extension(path));
 
-   for (i = 0; i < core_info_list->count; i++, supported++)
-   {
-      const core_info_t *core = &core_info_list->list[i];
+   if (path_is_compressed_file(path))
+      list = compressed_file_list_new(path, NULL);
 
-      if (!core)
-         continue;
+   for (i = 0; list && i < list->size; i++)
+      core_info_ext_index_union(index,
+            path_get_extension(list->elems[i].data));
 
-      if (core_info_does_support_file(core, path))
-         continue;
+   if (list)
+      string_list_free(list);
 
-#ifdef HAVE_ZLIB
-      if (core_info_does_support_any_file(core, list))
-         continue;
-#endif
+   for (i = 0; i < core_info_list->count; i++)
+   {
+      size_t idx = index->sorted[i] - core_info_list->list;
 
-      break;
+      if (index->query[idx / 32] & (1u << (idx % 32)))
+         index->supported[supported++] = *index->sorted[i];
    }
 
-#ifdef HAVE_ZLIB
-   if (list)
-      string_list_free(list);
-#endif
-
-   *infos = core_info_list->list;
+   *infos     = index->supported;
    *num_infos = supported;
 }
 
@@ -597,9 +1281,7 @@ static int core_info_firmware_cmp(const void *a_, const void *b_)
 void core_info_list_update_missing_firmware(core_info_list_t *core_info_list,
       const char *core, const char *systemdir)
 {
-   size_t i;
-   char path[PATH_MAX_LENGTH] = {0};
-   core_info_t          *info = NULL;
+   core_info_t *info = NULL;
 
    if (!core_info_list || !core)
       return;
@@ -607,15 +1289,23 @@ void core_info_list_update_missing_firmware(core_info_list_t *core_info_list,
    if (!(info = core_info_find(core_info_list, core)))
       return;
 
-   for (i = 0; i < info->firmware_count; i++)
-   {
-      if (!info->firmware[i].path)
-         continue;
+   core_info_firmware_begin_batch(core_info_list);
+   core_info_update_missing_firmware(core_info_list, info, systemdir);
+}
 
-      fill_pathname_join(path, systemdir,
-            info->firmware[i].path, sizeof(path));
-      info->firmware[i].missing = !path_file_exists(path);
-   }
+void core_info_list_update_all_missing_firmware(
+      core_info_list_t *core_info_list, const char *systemdir)
+{
+   size_t i;
+
+   if (!core_info_list)
+      return;
+
+   core_info_firmware_begin_batch(core_info_list);
+
+   for (i = 0; i < core_info_list->count; i++)
+      core_info_update_missing_firmware(core_info_list,
+            &core_info_list->list[i], systemdir);
 }
 
 void core_info_list_get_missing_firmware(core_info_list_t *core_info_list,
@@ -623,7 +1313,6 @@ void core_info_list_get_missing_firmware(core_info_list_t *core_info_list,
       const core_info_firmware_t **firmware, size_t *num_firmware)
 {
    size_t i;
-   char path[PATH_MAX_LENGTH] = {0};
    core_info_t          *info = NULL;
 
    if (!core_info_list || !core)
@@ -637,10 +1326,12 @@ void core_info_list_get_missing_firmware(core_info_list_t *core_info_list,
 
    *firmware = info->firmware;
 
+   core_info_firmware_begin_batch(core_info_list);
+
    for (i = 1; i < info->firmware_count; i++)
    {
-      fill_pathname_join(path, systemdir, info->firmware[i].path, sizeof(path));
-      info->firmware[i].missing = !path_file_exists(path);
+      info->firmware[i].missing = !core_info_firmware_exists(
+            core_info_list, systemdir, info->firmware[i].path);
       *num_firmware += info->firmware[i].missing;
    }
 
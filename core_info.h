@@ -37,7 +37,6 @@ typedef struct
 typedef struct
 {
    char *path;
-   void *config_data;
    char *display_name;
    char *core_name;
    char *system_manufacturer;
@@ -59,15 +58,26 @@ typedef struct
 
    core_info_firmware_t *firmware;
    size_t firmware_count;
+   /* Set if a .info file was found for this core. */
+   bool has_info;
    bool supports_no_game;
    void *userdata;
 } core_info_t;
 
+struct core_info_ext_index;
+struct core_info_firmware_cache;
+
 typedef struct
 {
    core_info_t *list;
    size_t count;
    char *all_ext;
+   /* Supported extension to cores lookup. */
+   struct core_info_ext_index *ext_index;
+   /* System directory listings for firmware checks. */
+   struct core_info_firmware_cache *firmware_cache;
+   /* Bytes accounted to MEM_TAG_CORE_INFO. */
+   size_t accounted;
 } core_info_list_t;
 
 core_info_list_t *core_info_list_new(void);
@@ -81,7 +91,8 @@ bool core_info_does_support_file(const core_info_t *info,
 bool core_info_does_support_any_file(const core_info_t *info,
       const struct string_list *list);
 
-/* Non-reentrant, does not allocate. Returns pointer to internal state. */
+/* Non-reentrant. Returns pointer to internal state, valid until the
+ * next call. Does not reorder the core list. */
 void core_info_list_get_supported_cores(core_info_list_t *list,
       const char *path, const core_info_t **infos, size_t *num_infos);
 
@@ -92,6 +103,11 @@ void core_info_list_get_missing_firmware(core_info_list_t *list,
 
 void core_info_list_update_missing_firmware(core_info_list_t *list,
       const char *core, const char *systemdir);	  
+
+/* Updates the missing flag of every firmware of every core,
+ * listing each directory at most once. */
+void core_info_list_update_all_missing_firmware(core_info_list_t *list,
+      const char *systemdir);
 	  
 /* Shallow-copies internal state. Data in *info is invalidated when the
  * core_info_list is freed. */
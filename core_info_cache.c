@@ -0,0 +1,510 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2016 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <compat/strl.h>
+#include <retro_miscellaneous.h>
+#include <retro_file.h>
+
+#include "core_info_cache.h"
+#include "file_ops.h"
+#include "verbosity.h"
+
+/* Layout (native byte order, the cache never leaves the machine):
+ *
+ * header : u32 magic, u32 version, i64 info dir mtime,
+ *          u32 record count, str info dir
+ * record : str info path, u64 size, i64 mtime, u8 flags,
+ *          and if CORE_INFO_CACHE_HAS_INFO is set:
+ *          str fields[CORE_INFO_CACHE_NUM_FIELDS], u32 firmware count,
+ *          firmware count * (str path, str desc, u8 optional)
+ * str    : u32 length (CORE_INFO_CACHE_NULL for NULL), bytes, '\0'
+ */
+#define CORE_INFO_CACHE_MAGIC      0x43494152 /* "RAIC" */
+#define CORE_INFO_CACHE_VERSION    1
+#define CORE_INFO_CACHE_NULL       0xffffffff
+#define CORE_INFO_CACHE_NUM_FIELDS 11
+
+#define CORE_INFO_CACHE_HAS_INFO          (1 << 0)
+#define CORE_INFO_CACHE_SUPPORTS_NO_GAME  (1 << 1)
+
+typedef struct core_info_cache_record
+{
+   const char *info_path;
+   uint64_t size;
+   int64_t mtime;
+   uint8_t flags;
+   /* Start of the string fields inside the cache buffer. */
+   size_t data;
+} core_info_cache_record_t;
+
+struct core_info_cache
+{
+   /* Serialized cache, read from disk or being built. */
+   uint8_t *buf;
+   size_t len;
+   size_t cap;
+   bool error;
+
+   int64_t info_dir_mtime;
+
+   core_info_cache_record_t *records;
+   size_t count;
+};
+
+typedef struct core_info_cache_reader
+{
+   const uint8_t *buf;
+   size_t pos;
+   size_t len;
+   bool error;
+} core_info_cache_reader_t;
+
+static void core_info_cache_fields(core_info_t *info,
+      char **fields[CORE_INFO_CACHE_NUM_FIELDS])
+{
+   fields[0]  = &info->display_name;
+   fields[1]  = &info->core_name;
+   fields[2]  = &info->systemname;
+   fields[3]  = &info->system_manufacturer;
+   fields[4]  = &info->supported_extensions;
+   fields[5]  = &info->authors;
+   fields[6]  = &info->permissions;
+   fields[7]  = &info->licenses;
+   fields[8]  = &info->categories;
+   fields[9]  = &info->databases;
+   fields[10] = &info->notes;
+}
+
+static bool core_info_cache_read(core_info_cache_reader_t *r,
+      void *data, size_t size)
+{
+   if (r->error || size > r->len - r->pos)
+   {
+      r->error = true;
+      return false;
+   }
+
+   memcpy(data, r->buf + r->pos, size);
+   r->pos += size;
+   return true;
+}
+
+static uint32_t core_info_cache_read_u32(core_info_cache_reader_t *r)
+{
+   uint32_t val = 0;
+   core_info_cache_read(r, &val, sizeof(val));
+   return val;
+}
+
+static uint8_t core_info_cache_read_u8(core_info_cache_reader_t *r)
+{
+   uint8_t val = 0;
+   core_info_cache_read(r, &val, sizeof(val));
+   return val;
+}
+
+/* Returns a pointer into the buffer, strings are stored
+ * NUL-terminated so they can be used in place. */
+static const char *core_info_cache_read_str(core_info_cache_reader_t *r)
+{
+   const char *str = NULL;
+   uint32_t    len = core_info_cache_read_u32(r);
+
+   if (r->error || len == CORE_INFO_CACHE_NULL)
+      return NULL;
+
+   if (len >= r->len - r->pos || r->buf[r->pos + len] != '\0')
+   {
+      r->error = true;
+      return NULL;
+   }
+
+   str     = (const char*)r->buf + r->pos;
+   r->pos += len + 1;
+   return str;
+}
+
+static void core_info_cache_write_data(core_info_cache_t *cache,
+      const void *data, size_t size)
+{
+   if (cache->len + size > cache->cap)
+   {
+      size_t   new_cap = cache->cap ? cache->cap * 2 : 4096;
+      uint8_t *new_buf = NULL;
+
+      if (cache->error)
+         return;
+
+      while (new_cap < cache->len + size)
+         new_cap *= 2;
+
+      new_buf = (uint8_t*)realloc(cache->buf, new_cap);
+      if (!new_buf)
+      {
+         cache->error = true;
+         return;
+      }
+
+      cache->buf = new_buf;
+      cache->cap = new_cap;
+   }
+
+   memcpy(cache->buf + cache->len, data, size);
+   cache->len += size;
+}
+
+static void core_info_cache_write_u32(core_info_cache_t *cache, uint32_t val)
+{
+   core_info_cache_write_data(cache, &val, sizeof(val));
+}
+
+static void core_info_cache_write_u8(core_info_cache_t *cache, uint8_t val)
+{
+   core_info_cache_write_data(cache, &val, sizeof(val));
+}
+
+static void core_info_cache_write_str(core_info_cache_t *cache,
+      const char *str)
+{
+   uint32_t len;
+
+   if (!str)
+   {
+      core_info_cache_write_u32(cache, CORE_INFO_CACHE_NULL);
+      return;
+   }
+
+   len = strlen(str);
+   core_info_cache_write_u32(cache, len);
+   core_info_cache_write_data(cache, str, len + 1);
+}
+
+/* Walks over the string fields and firmware of a record. If @info
+ * is non-NULL, the strings are copied into it. */
+static bool core_info_cache_read_info(core_info_cache_reader_t *r,
+      core_info_t *info)
+{
+   unsigned i;
+   uint32_t firmware_count;
+   char **fields[CORE_INFO_CACHE_NUM_FIELDS];
+
+   if (info)
+      core_info_cache_fields(info, fields);
+
+   for (i = 0; i < CORE_INFO_CACHE_NUM_FIELDS; i++)
+   {
+      const char *str = core_info_cache_read_str(r);
+      if (info && str)
+         *fields[i] = strdup(str);
+   }
+
+   firmware_count = core_info_cache_read_u32(r);
+   if (r->error)
+      return false;
+
+   if (info && firmware_count)
+   {
+      info->firmware = (core_info_firmware_t*)
+         calloc(firmware_count, sizeof(*info->firmware));
+      if (info->firmware)
+         info->firmware_count = firmware_count;
+   }
+
+   for (i = 0; i < firmware_count; i++)
+   {
+      const char *path = core_info_cache_read_str(r);
+      const char *desc = core_info_cache_read_str(r);
+      bool    optional = core_info_cache_read_u8(r);
+
+      if (r->error)
+         return false;
+
+      if (!info || !info->firmware)
+         continue;
+
+      info->firmware[i].path     = path ? strdup(path) : NULL;
+      info->firmware[i].desc     = desc ? strdup(desc) : NULL;
+      info->firmware[i].optional = optional;
+   }
+
+   return !r->error;
+}
+
+core_info_cache_t *core_info_cache_new(const char *info_dir,
+      int64_t info_dir_mtime)
+{
+   core_info_cache_t *cache = (core_info_cache_t*)
+      calloc(1, sizeof(*cache));
+
+   if (!cache)
+      return NULL;
+
+   cache->info_dir_mtime = info_dir_mtime;
+
+   core_info_cache_write_u32(cache, CORE_INFO_CACHE_MAGIC);
+   core_info_cache_write_u32(cache, CORE_INFO_CACHE_VERSION);
+   core_info_cache_write_data(cache, &info_dir_mtime, sizeof(info_dir_mtime));
+   /* Record count, patched in core_info_cache_write(). */
+   core_info_cache_write_u32(cache, 0);
+   core_info_cache_write_str(cache, info_dir);
+
+   if (cache->error)
+   {
+      free(cache->buf);
+      free(cache);
+      return NULL;
+   }
+
+   return cache;
+}
+
+core_info_cache_t *core_info_cache_load(const char *path,
+      const char *info_dir)
+{
+   size_t i;
+   uint32_t count;
+   ssize_t len                = 0;
+   const char *dir            = NULL;
+   uint8_t *buf               = NULL;
+   core_info_cache_t *cache   = NULL;
+   core_info_cache_reader_t r = {0};
+
+   if (!path || !*path)
+      return NULL;
+
+   if (!retro_read_file(path, (void**)&buf, &len) || !buf)
+      return NULL;
+
+   cache = (core_info_cache_t*)calloc(1, sizeof(*cache));
+   if (!cache)
+      goto error;
+
+   cache->buf = buf;
+   cache->len = len;
+   cache->cap = len;
+
+   r.buf      = buf;
+   r.len      = len;
+
+   if (core_info_cache_read_u32(&r) != CORE_INFO_CACHE_MAGIC)
+      goto error;
+   if (core_info_cache_read_u32(&r) != CORE_INFO_CACHE_VERSION)
+      goto error;
+
+   core_info_cache_read(&r, &cache->info_dir_mtime,
+         sizeof(cache->info_dir_mtime));
+   count = core_info_cache_read_u32(&r);
+   dir   = core_info_cache_read_str(&r);
+
+   if (r.error || !dir || strcmp(dir, info_dir))
+      goto error;
+
+   /* Every record takes at least 21 bytes, don't trust
+    * a count the file cannot possibly hold. */
+   if (count > len / 21)
+      goto error;
+
+   if (count)
+   {
+      cache->records = (core_info_cache_record_t*)
+         calloc(count, sizeof(*cache->records));
+      if (!cache->records)
+         goto error;
+   }
+
+   for (i = 0; i < count; i++)
+   {
+      core_info_cache_record_t *rec = &cache->records[i];
+
+      rec->info_path = core_info_cache_read_str(&r);
+      core_info_cache_read(&r, &rec->size, sizeof(rec->size));
+      core_info_cache_read(&r, &rec->mtime, sizeof(rec->mtime));
+      rec->flags     = core_info_cache_read_u8(&r);
+      rec->data      = r.pos;
+
+      if (r.error || !rec->info_path)
+         goto error;
+
+      if ((rec->flags & CORE_INFO_CACHE_HAS_INFO)
+            && !core_info_cache_read_info(&r, NULL))
+         goto error;
+   }
+
+   cache->count = count;
+   return cache;
+
+error:
+   RARCH_WARN("Ignoring invalid core info cache: %s.\n", path);
+   if (cache)
+      core_info_cache_free(cache);
+   else
+      free(buf);
+   return NULL;
+}
+
+int64_t core_info_cache_get_info_dir_mtime(const core_info_cache_t *cache)
+{
+   if (!cache)
+      return 0;
+   return cache->info_dir_mtime;
+}
+
+size_t core_info_cache_size(const core_info_cache_t *cache)
+{
+   if (!cache)
+      return 0;
+   return cache->count;
+}
+
+enum core_info_cache_lookup core_info_cache_lookup(
+      const core_info_cache_t *cache, const char *info_path,
+      size_t hint, bool check_missing,
+      uint64_t *size, int64_t *mtime, core_info_t *info)
+{
+   size_t i;
+   core_info_cache_reader_t r          = {0};
+   const core_info_cache_record_t *rec = NULL;
+
+   *size  = 0;
+   *mtime = 0;
+
+   if (cache)
+   {
+      if (hint < cache->count
+            && !strcmp(cache->records[hint].info_path, info_path))
+         rec = &cache->records[hint];
+
+      for (i = 0; !rec && i < cache->count; i++)
+         if (!strcmp(cache->records[i].info_path, info_path))
+            rec = &cache->records[i];
+   }
+
+   /* A .info file can't appear without touching the info directory.
+    * A file that existed but failed to parse is checked every time. */
+   if (rec && !(rec->flags & CORE_INFO_CACHE_HAS_INFO)
+         && !rec->mtime && !check_missing)
+      return CORE_INFO_CACHE_HIT_NO_INFO;
+
+   if (!file_get_stat(info_path, size, mtime))
+      return CORE_INFO_CACHE_HIT_NO_INFO;
+
+   if (!rec || !(rec->flags & CORE_INFO_CACHE_HAS_INFO))
+      return CORE_INFO_CACHE_MISS;
+
+   if (rec->size != *size || rec->mtime != *mtime)
+      return CORE_INFO_CACHE_MISS;
+
+   r.buf = cache->buf;
+   r.pos = rec->data;
+   r.len = cache->len;
+
+   if (!core_info_cache_read_info(&r, info))
+      return CORE_INFO_CACHE_MISS;
+
+   info->supports_no_game =
+      (rec->flags & CORE_INFO_CACHE_SUPPORTS_NO_GAME) ? true : false;
+
+   return CORE_INFO_CACHE_HIT;
+}
+
+bool core_info_cache_add(core_info_cache_t *cache, const char *info_path,
+      uint64_t size, int64_t mtime, const core_info_t *info)
+{
+   size_t i;
+   uint8_t flags = 0;
+   char **fields[CORE_INFO_CACHE_NUM_FIELDS];
+
+   if (!cache || !info_path)
+      return false;
+
+   if (info)
+      flags |= CORE_INFO_CACHE_HAS_INFO;
+   if (info && info->supports_no_game)
+      flags |= CORE_INFO_CACHE_SUPPORTS_NO_GAME;
+
+   core_info_cache_write_str(cache, info_path);
+   core_info_cache_write_data(cache, &size, sizeof(size));
+   core_info_cache_write_data(cache, &mtime, sizeof(mtime));
+   core_info_cache_write_u8(cache, flags);
+
+   if (info)
+   {
+      core_info_cache_fields((core_info_t*)info, fields);
+
+      for (i = 0; i < CORE_INFO_CACHE_NUM_FIELDS; i++)
+         core_info_cache_write_str(cache, *fields[i]);
+
+      core_info_cache_write_u32(cache, info->firmware_count);
+
+      for (i = 0; i < info->firmware_count; i++)
+      {
+         core_info_cache_write_str(cache, info->firmware[i].path);
+         core_info_cache_write_str(cache, info->firmware[i].desc);
+         core_info_cache_write_u8(cache, info->firmware[i].optional);
+      }
+   }
+
+   cache->count++;
+   return true;
+}
+
+bool core_info_cache_write(core_info_cache_t *cache, const char *path)
+{
+   uint32_t count;
+   char tmp_path[PATH_MAX_LENGTH] = {0};
+
+   if (!cache || !path || !*path || cache->error)
+      return false;
+
+   /* Record count follows magic, version and info dir mtime. */
+   count = cache->count;
+   memcpy(cache->buf + 2 * sizeof(uint32_t) + sizeof(int64_t),
+         &count, sizeof(count));
+
+   snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+   if (!retro_write_file(tmp_path, cache->buf, cache->len))
+      goto error;
+
+#ifdef _WIN32
+   /* rename() does not replace existing files on Windows. */
+   remove(path);
+#endif
+   if (rename(tmp_path, path) != 0)
+   {
+      remove(tmp_path);
+      goto error;
+   }
+
+   return true;
+
+error:
+   RARCH_WARN("Failed to write core info cache: %s.\n", path);
+   return false;
+}
+
+void core_info_cache_free(core_info_cache_t *cache)
+{
+   if (!cache)
+      return;
+
+   free(cache->buf);
+   free(cache->records);
+   free(cache);
+}
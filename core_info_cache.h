@@ -0,0 +1,131 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2016 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CORE_INFO_CACHE_H_
+#define CORE_INFO_CACHE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <boolean.h>
+
+#include "core_info.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CORE_INFO_CACHE_FILE "core_info.cache"
+
+enum core_info_cache_lookup
+{
+   /* No usable record, the .info file has to be parsed. */
+   CORE_INFO_CACHE_MISS = 0,
+   /* Record found, core info has been filled in. */
+   CORE_INFO_CACHE_HIT,
+   /* Record found, the core has no .info file. */
+   CORE_INFO_CACHE_HIT_NO_INFO
+};
+
+typedef struct core_info_cache core_info_cache_t;
+
+/**
+ * core_info_cache_new:
+ * @info_dir            : Directory holding the .info files.
+ * @info_dir_mtime      : Modification time of @info_dir.
+ *
+ * Creates an empty cache, to be filled with core_info_cache_add()
+ * and written out with core_info_cache_write().
+ *
+ * Returns: new cache handle, or NULL on error.
+ **/
+core_info_cache_t *core_info_cache_new(const char *info_dir,
+      int64_t info_dir_mtime);
+
+/**
+ * core_info_cache_load:
+ * @path                : Path to the cache file.
+ * @info_dir            : Directory holding the .info files.
+ *
+ * Reads a cache written by core_info_cache_write() with a single
+ * read. Caches written by another version or for another info
+ * directory are rejected.
+ *
+ * Returns: cache handle, or NULL if @path does not hold a valid cache.
+ **/
+core_info_cache_t *core_info_cache_load(const char *path,
+      const char *info_dir);
+
+int64_t core_info_cache_get_info_dir_mtime(const core_info_cache_t *cache);
+
+size_t core_info_cache_size(const core_info_cache_t *cache);
+
+/**
+ * core_info_cache_lookup:
+ * @cache               : Cache handle.
+ * @info_path           : Path to the .info file of the core.
+ * @hint                : Record index to try first. Records are
+ *                        stored in core list order, so passing the
+ *                        index of the core usually hits right away.
+ * @check_missing       : If false, a record saying the .info file
+ *                        does not exist is trusted without touching
+ *                        the file system. Only pass false if the
+ *                        info directory did not change.
+ * @size                : Out: size of the .info file, if it exists.
+ * @mtime               : Out: modification time of the .info file.
+ * @info                : Core info to fill in.
+ *
+ * Looks up the record of @info_path and fills in @info if the
+ * .info file was not modified since the record was written.
+ *
+ * Returns: see enum core_info_cache_lookup.
+ **/
+enum core_info_cache_lookup core_info_cache_lookup(
+      const core_info_cache_t *cache, const char *info_path,
+      size_t hint, bool check_missing,
+      uint64_t *size, int64_t *mtime, core_info_t *info);
+
+/**
+ * core_info_cache_add:
+ * @cache               : Cache handle.
+ * @info_path           : Path to the .info file of the core.
+ * @size                : Size of the .info file.
+ * @mtime               : Modification time of the .info file.
+ * @info                : Parsed core info, or NULL if the core
+ *                        has no .info file.
+ *
+ * Appends the record of one core.
+ **/
+bool core_info_cache_add(core_info_cache_t *cache, const char *info_path,
+      uint64_t size, int64_t mtime, const core_info_t *info);
+
+/**
+ * core_info_cache_write:
+ * @cache               : Cache handle.
+ * @path                : Path to the cache file.
+ *
+ * Writes the cache to a temporary file next to @path and renames
+ * it over @path, so a reader never sees a partially written cache.
+ *
+ * Returns: true (1) on success, otherwise false (0).
+ **/
+bool core_info_cache_write(core_info_cache_t *cache, const char *path);
+
+void core_info_cache_free(core_info_cache_t *cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -22,26 +22,98 @@
 #include <compat/strl.h>
 #include <retro_miscellaneous.h>
 
+#include "configuration.h"
 #include "core_options.h"
+#include "msg_hash.h"
 
 struct core_option
 {
    char *desc;
    char *key;
+   uint32_t key_hash;
    struct string_list *vals;
    size_t index;
+   /* vals->elems[index].data, kept in sync whenever index changes. */
+   const char *val;
 };
 
 struct core_option_manager
 {
    config_file_t *conf;
    char conf_path[PATH_MAX_LENGTH];
+   /* conf holds values not yet written to conf_path. */
+   bool dirty;
 
    struct core_option *opts;
    size_t size;
    bool updated;
+
+   /* Open addressed key hash to option lookup. Holds option
+    * index + 1, 0 marks an empty slot. */
+   size_t *map;
+   size_t map_size;
 };
 
+static void core_option_update_val(struct core_option *option)
+{
+   option->val = option->vals->elems[option->index].data;
+}
+
+static struct core_option *core_option_find(core_option_manager_t *opt,
+      const char *key)
+{
+   size_t pos;
+   uint32_t hash;
+
+   if (!opt->map)
+      return NULL;
+
+   hash = msg_hash_calculate(key);
+   pos  = hash & (opt->map_size - 1);
+
+   while (opt->map[pos])
+   {
+      struct core_option *option = &opt->opts[opt->map[pos] - 1];
+
+      if (option->key_hash == hash && !strcmp(option->key, key))
+         return option;
+
+      pos = (pos + 1) & (opt->map_size - 1);
+   }
+
+   return NULL;
+}
+
+static bool core_option_map_init(core_option_manager_t *opt)
+{
+   size_t i;
+
+   opt->map_size = 16;
+   while (opt->map_size < opt->size * 2)
+      opt->map_size *= 2;
+
+   opt->map = (size_t*)calloc(opt->map_size, sizeof(*opt->map));
+   if (!opt->map)
+      return false;
+
+   for (i = 0; i < opt->size; i++)
+   {
+      size_t pos;
+
+      /* Duplicate keys resolve to the first option, as before. */
+      if (core_option_find(opt, opt->opts[i].key))
+         continue;
+
+      pos = opt->opts[i].key_hash & (opt->map_size - 1);
+      while (opt->map[pos])
+         pos = (pos + 1) & (opt->map_size - 1);
+
+      opt->map[pos] = i + 1;
+   }
+
+   return true;
+}
+
 /**
  * core_option_free:
  * @opt              : options manager handle
@@ -64,29 +136,30 @@ void core_option_free(core_option_manager_t *opt)
 
    if (opt->conf)
       config_file_free(opt->conf);
+   free(opt->map);
    free(opt->opts);
    free(opt);
 }
 
+/**
+ * core_option_get:
+ * @opt              : options manager handle
+ * @var              : variable to look up, value is set to NULL
+ *                     if the key is unknown.
+ *
+ * Called for RETRO_ENVIRONMENT_GET_VARIABLE, often several
+ * times per frame, so this is a single hash lookup.
+ **/
 void core_option_get(core_option_manager_t *opt, struct retro_variable *var)
 {
-   size_t i;
+   struct core_option *option = NULL;
 
    if (!opt)
       return;
 
    opt->updated = false;
-
-   for (i = 0; i < opt->size; i++)
-   {
-      if (!strcmp(opt->opts[i].key, var->key))
-      {
-         var->value = core_option_get_val(opt, i);
-         return;
-      }
-   }
-
-   var->value = NULL;
+   option       = var->key ? core_option_find(opt, var->key) : NULL;
+   var->value   = option ? option->val : NULL;
 }
 
 static bool parse_variable(core_option_manager_t *opt, size_t idx,
@@ -101,8 +174,9 @@ static bool parse_variable(core_option_manager_t *opt, size_t idx,
    if (!option)
       return false;
 
-   option->key = strdup(var->key);
-   value       = strdup(var->value);
+   option->key      = strdup(var->key);
+   option->key_hash = msg_hash_calculate(var->key);
+   value            = strdup(var->value);
    desc_end    = strstr(value, "; ");
 
    if (!desc_end)
@@ -139,6 +213,8 @@ static bool parse_variable(core_option_manager_t *opt, size_t idx,
       free(config_val);
    }
 
+   core_option_update_val(option);
+
    free(value);
 
    return true;
@@ -166,6 +242,7 @@ core_option_manager_t *core_option_new(const char *conf_path,
 
    if (*conf_path)
       opt->conf = config_file_new(conf_path);
+   opt->dirty = !opt->conf;
    if (!opt->conf)
       opt->conf = config_file_new(NULL);
 
@@ -190,6 +267,9 @@ core_option_manager_t *core_option_new(const char *conf_path,
          goto error;
    }
 
+   if (!core_option_map_init(opt))
+      goto error;
+
    return opt;
 
 error:
@@ -214,27 +294,68 @@ bool core_option_updated(core_option_manager_t *opt)
 }
 
 /**
- * core_option_flush:
+ * core_option_sync_conf:
  * @opt              : options manager handle
  *
- * Writes core option key-pair values to file.
+ * Copies the current option values into the config file,
+ * leaving every other key of the file alone.
  *
- * Returns: true (1) if core option values could be
- * successfully saved to disk, otherwise false (0).
+ * Returns: true (1) if any value in the config file changed,
+ * otherwise false (0).
  **/
-bool core_option_flush(core_option_manager_t *opt)
+static bool core_option_sync_conf(core_option_manager_t *opt)
 {
    size_t i;
+   bool changed = false;
 
    for (i = 0; i < opt->size; i++)
    {
+      char *config_val           = NULL;
       struct core_option *option = (struct core_option*)&opt->opts[i];
+      const char *val            = core_option_get_val(opt, i);
+
+      if (!option || !val)
+         continue;
+
+      if (config_get_string(opt->conf, option->key, &config_val))
+      {
+         bool same = !strcmp(config_val, val);
+
+         free(config_val);
+         if (same)
+            continue;
+      }
 
-      if (option)
-         config_set_string(opt->conf, option->key, core_option_get_val(opt, i));
+      config_set_string(opt->conf, option->key, val);
+      changed = true;
    }
 
-   return config_file_write(opt->conf, opt->conf_path);
+   return changed;
+}
+
+/**
+ * core_option_flush:
+ * @opt              : options manager handle
+ *
+ * Writes core option key-pair values to file. Nothing is
+ * written if the file already holds the current values.
+ *
+ * Returns: true (1) if core option values could be
+ * successfully saved to disk, otherwise false (0).
+ **/
+bool core_option_flush(core_option_manager_t *opt)
+{
+   if (core_option_sync_conf(opt))
+      opt->dirty = true;
+
+   if (!opt->dirty)
+      return true;
+
+   if (!config_file_write_atomic(opt->conf, opt->conf_path))
+      return false;
+
+   opt->dirty = false;
+   return true;
 }
 
 /**
@@ -249,16 +370,9 @@ bool core_option_flush(core_option_manager_t *opt)
  **/
 bool core_option_flush_game_specific(core_option_manager_t *opt, char* path)
 {
-   size_t i;
-   for (i = 0; i < opt->size; i++)
-   {
-      struct core_option *option = (struct core_option*)&opt->opts[i];
-
-      if (option)
-         config_set_string(opt->conf, option->key, core_option_get_val(opt, i));
-}
-
-   return config_file_write(opt->conf, path);
+   if (core_option_sync_conf(opt))
+      opt->dirty = true;
+   return config_file_write_atomic(opt->conf, path);
 }
 
 /**
@@ -309,7 +423,7 @@ const char *core_option_get_val(core_option_manager_t *opt, size_t idx)
    option = (struct core_option*)&opt->opts[idx];
    if (!option)
       return NULL;
-   return option->vals->elems[option->index].data;
+   return option->val;
 }
 
 /**
@@ -345,6 +459,7 @@ void core_option_set_val(core_option_manager_t *opt,
 
    option->index = val_idx % option->vals->size;
    opt->updated  = true;
+   core_option_update_val(option);
 }
 
 /**
@@ -369,6 +484,7 @@ void core_option_next(core_option_manager_t *opt, size_t idx)
 
    option->index = (option->index + 1) % option->vals->size;
    opt->updated  = true;
+   core_option_update_val(option);
 }
 
 /**
@@ -395,6 +511,7 @@ void core_option_prev(core_option_manager_t *opt, size_t idx)
    option->index = (option->index + option->vals->size - 1) %
       option->vals->size;
    opt->updated  = true;
+   core_option_update_val(option);
 }
 
 /**
@@ -411,4 +528,5 @@ void core_option_set_default(core_option_manager_t *opt, size_t idx)
 
    opt->opts[idx].index = 0;
    opt->updated         = true;
+   core_option_update_val(&opt->opts[idx]);
 }
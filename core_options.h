@@ -55,7 +55,8 @@ bool core_option_updated(core_option_manager_t *opt);
  * core_option_flush:
  * @opt              : options manager handle
  *
- * Writes core option key-pair values to file.
+ * Writes core option key-pair values to file. Nothing is
+ * written if the file already holds the current values.
  *
  * Returns: true (1) if core option values could be
  * successfully saved to disk, otherwise false (0).
@@ -0,0 +1,509 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2016 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Deterministic synthetic core. It needs neither content nor a
+ * GPU and only exists to put a configurable load on the frontend:
+ * video frames, audio batches, savestates that change by a given
+ * fraction per frame, SRAM and a memory map. The same input always
+ * yields the same frames and states, so runs can be compared. */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "benchmark_core.h"
+
+#define BENCHMARK_FPS               60.0
+/* Frame counter and PRNG state, stored in front of the state. */
+#define BENCHMARK_HEADER_SIZE       16
+#define BENCHMARK_BLOCK_SIZE        64
+#define BENCHMARK_MAX_DESCRIPTORS   16
+
+static retro_environment_t         benchmark_environ_cb;
+static retro_video_refresh_t       benchmark_video_cb;
+static retro_audio_sample_batch_t  benchmark_audio_batch_cb;
+static retro_input_poll_t          benchmark_input_poll_cb;
+static retro_input_state_t         benchmark_input_state_cb;
+
+static struct benchmark_core_config benchmark_config = {
+   320, 240, RETRO_PIXEL_FORMAT_XRGB8888, 800, 64 * 1024, 0.05f, 8 * 1024, ""
+};
+
+static struct
+{
+   /* Configuration in effect for the loaded game. */
+   struct benchmark_core_config config;
+   unsigned bpp;
+
+   uint8_t *frame;
+   int16_t *audio;
+   uint8_t *state;
+   uint8_t *sram;
+
+   uint64_t frame_count;
+   uint64_t rng;
+   uint32_t phase;
+
+   struct retro_memory_descriptor descriptors[BENCHMARK_MAX_DESCRIPTORS];
+   unsigned num_descriptors;
+} benchmark;
+
+/* xorshift64*, good enough to scatter writes, and reproducible. */
+static uint64_t benchmark_next(void)
+{
+   benchmark.rng ^= benchmark.rng >> 12;
+   benchmark.rng ^= benchmark.rng << 25;
+   benchmark.rng ^= benchmark.rng >> 27;
+   return benchmark.rng * UINT64_C(2685821657736338717);
+}
+
+static void benchmark_write_header(void)
+{
+   memcpy(benchmark.state,     &benchmark.frame_count, sizeof(uint64_t));
+   memcpy(benchmark.state + 8, &benchmark.rng,         sizeof(uint64_t));
+}
+
+static void benchmark_read_header(void)
+{
+   memcpy(&benchmark.frame_count, benchmark.state,     sizeof(uint64_t));
+   memcpy(&benchmark.rng,         benchmark.state + 8, sizeof(uint64_t));
+   if (!benchmark.rng)
+      benchmark.rng = 1;
+}
+
+static void benchmark_reset_state(void)
+{
+   size_t i;
+
+   benchmark.frame_count = 0;
+   benchmark.rng         = UINT64_C(0x9e3779b97f4a7c15);
+   benchmark.phase       = 0;
+
+   /* Start from a pattern rather than zeroes, so the first
+    * savestates don't compress unrealistically well. */
+   for (i = BENCHMARK_HEADER_SIZE; i < benchmark.config.serialize_size; i++)
+      benchmark.state[i] = (uint8_t)benchmark_next();
+   memset(benchmark.sram, 0, benchmark.config.sram_size);
+
+   benchmark_write_header();
+}
+
+static void benchmark_init_memory_map(void)
+{
+   struct retro_memory_map map;
+   size_t offset      = 0;
+   const char *cur    = benchmark.config.memory_map;
+   size_t state_size  = benchmark.config.serialize_size;
+
+   benchmark.num_descriptors = 0;
+   memset(benchmark.descriptors, 0, sizeof(benchmark.descriptors));
+
+   while (*cur && benchmark.num_descriptors < BENCHMARK_MAX_DESCRIPTORS)
+   {
+      char *end;
+      struct retro_memory_descriptor *desc = NULL;
+      size_t start = strtoul(cur, &end, 16);
+      size_t len   = 0;
+
+      if (*end != ':')
+         break;
+      len = strtoul(end + 1, &end, 16);
+
+      if (offset + len > state_size)
+         offset = 0;
+      if (len > state_size)
+         len = state_size;
+
+      if (len)
+      {
+         desc         = &benchmark.descriptors[benchmark.num_descriptors++];
+         desc->ptr    = benchmark.state;
+         desc->offset = offset;
+         desc->start  = start;
+         desc->len    = len;
+         offset      += len;
+      }
+
+      if (*end != ',')
+         break;
+      cur = end + 1;
+   }
+
+   if (!benchmark.num_descriptors)
+   {
+      benchmark.descriptors[0].ptr = benchmark.state;
+      benchmark.descriptors[0].len = state_size;
+      benchmark.num_descriptors    = 1;
+   }
+
+   map.descriptors     = benchmark.descriptors;
+   map.num_descriptors = benchmark.num_descriptors;
+   benchmark_environ_cb(RETRO_ENVIRONMENT_SET_MEMORY_MAPS, &map);
+}
+
+static void benchmark_free(void)
+{
+   free(benchmark.frame);
+   free(benchmark.audio);
+   free(benchmark.state);
+   free(benchmark.sram);
+   memset(&benchmark, 0, sizeof(benchmark));
+}
+
+void libretro_benchmark_set_config(const struct benchmark_core_config *config)
+{
+   benchmark_config = *config;
+   benchmark_config.memory_map[sizeof(benchmark_config.memory_map) - 1] = '\0';
+}
+
+void libretro_benchmark_retro_init(void)
+{
+}
+
+void libretro_benchmark_retro_deinit(void)
+{
+   benchmark_free();
+}
+
+unsigned libretro_benchmark_retro_api_version(void)
+{
+   return RETRO_API_VERSION;
+}
+
+void libretro_benchmark_retro_set_controller_port_device(
+      unsigned port, unsigned device)
+{
+   (void)port;
+   (void)device;
+}
+
+void libretro_benchmark_retro_get_system_info(
+      struct retro_system_info *info)
+{
+   memset(info, 0, sizeof(*info));
+   info->library_name     = "Benchmark";
+   info->library_version  = "1";
+   info->need_fullpath    = true;
+   info->block_extract    = true;
+   info->valid_extensions = "";
+}
+
+void libretro_benchmark_retro_get_system_av_info(
+      struct retro_system_av_info *info)
+{
+   const struct benchmark_core_config *config = benchmark.frame
+      ? &benchmark.config : &benchmark_config;
+
+   info->timing.fps            = BENCHMARK_FPS;
+   info->timing.sample_rate    = config->audio_batch * BENCHMARK_FPS;
+
+   info->geometry.base_width   = config->width;
+   info->geometry.base_height  = config->height;
+   info->geometry.max_width    = config->width;
+   info->geometry.max_height   = config->height;
+   info->geometry.aspect_ratio = 0.0f;
+}
+
+void libretro_benchmark_retro_set_environment(retro_environment_t cb)
+{
+   bool no_game = true;
+
+   benchmark_environ_cb = cb;
+   cb(RETRO_ENVIRONMENT_SET_SUPPORT_NO_GAME, &no_game);
+}
+
+void libretro_benchmark_retro_set_audio_sample(retro_audio_sample_t cb)
+{
+   (void)cb;
+}
+
+void libretro_benchmark_retro_set_audio_sample_batch(
+      retro_audio_sample_batch_t cb)
+{
+   benchmark_audio_batch_cb = cb;
+}
+
+void libretro_benchmark_retro_set_input_poll(retro_input_poll_t cb)
+{
+   benchmark_input_poll_cb = cb;
+}
+
+void libretro_benchmark_retro_set_input_state(retro_input_state_t cb)
+{
+   benchmark_input_state_cb = cb;
+}
+
+void libretro_benchmark_retro_set_video_refresh(retro_video_refresh_t cb)
+{
+   benchmark_video_cb = cb;
+}
+
+void libretro_benchmark_retro_reset(void)
+{
+   if (benchmark.state)
+      benchmark_reset_state();
+}
+
+static void benchmark_run_state(uint16_t input)
+{
+   size_t i, blocks, nblocks;
+   size_t payload = benchmark.config.serialize_size - BENCHMARK_HEADER_SIZE;
+   size_t block   = payload < BENCHMARK_BLOCK_SIZE
+      ? payload : BENCHMARK_BLOCK_SIZE;
+
+   /* Input steers the PRNG, so movies and netplay replay
+    * the same state changes. */
+   benchmark.rng ^= (uint64_t)input << 32;
+   if (!benchmark.rng)
+      benchmark.rng = 1;
+
+   if (block)
+   {
+      nblocks = payload / block;
+      blocks  = (size_t)(benchmark.config.dirty_ratio * payload + block - 1)
+         / block;
+      if (blocks > nblocks)
+         blocks = nblocks;
+
+      for (i = 0; i < blocks; i++)
+      {
+         size_t j;
+         uint8_t *dst = benchmark.state + BENCHMARK_HEADER_SIZE
+            + (size_t)(benchmark_next() % nblocks) * block;
+
+         for (j = 0; j + sizeof(uint64_t) <= block; j += sizeof(uint64_t))
+         {
+            uint64_t value = benchmark_next();
+            memcpy(dst + j, &value, sizeof(value));
+         }
+         for (; j < block; j++)
+            dst[j] = (uint8_t)benchmark_next();
+      }
+   }
+
+   if (benchmark.config.sram_size)
+      benchmark.sram[benchmark.frame_count % benchmark.config.sram_size] =
+         (uint8_t)benchmark_next();
+
+   benchmark.frame_count++;
+   benchmark_write_header();
+}
+
+static void benchmark_run_video(void)
+{
+   unsigned x, y;
+   unsigned width  = benchmark.config.width;
+   unsigned height = benchmark.config.height;
+   size_t pitch    = width * benchmark.bpp;
+   uint32_t base   = (uint32_t)benchmark.frame_count;
+
+   /* Diagonal bands scrolling by one pixel per frame. */
+   for (y = 0; y < height; y++)
+   {
+      uint8_t *line = benchmark.frame + y * pitch;
+
+      if (benchmark.bpp == 4)
+      {
+         uint32_t *out = (uint32_t*)line;
+         for (x = 0; x < width; x++)
+            out[x] = ((base + x + y) & 0xff) * 0x010101u;
+      }
+      else
+      {
+         uint16_t *out = (uint16_t*)line;
+         for (x = 0; x < width; x++)
+            out[x] = (uint16_t)(((base + x + y) >> 3) & 0x1f) * 0x0421u;
+      }
+   }
+
+   benchmark_video_cb(benchmark.frame, width, height, pitch);
+}
+
+static void benchmark_run_audio(void)
+{
+   size_t i;
+   size_t frames        = benchmark.config.audio_batch;
+   const int16_t *audio = benchmark.audio;
+
+   /* Sawtooth, continuous across frames. */
+   for (i = 0; i < frames; i++)
+   {
+      int16_t sample = (int16_t)((benchmark.phase & 0xff) * 64 - 8192);
+
+      benchmark.audio[i * 2 + 0] = sample;
+      benchmark.audio[i * 2 + 1] = sample;
+      benchmark.phase           += 2;
+   }
+
+   /* The frontend may take a batch in several pieces. */
+   while (frames)
+   {
+      size_t written = benchmark_audio_batch_cb(audio, frames);
+
+      if (!written)
+         break;
+
+      frames -= written;
+      audio  += written * 2;
+   }
+}
+
+void libretro_benchmark_retro_run(void)
+{
+   unsigned i;
+   uint16_t input = 0;
+
+   benchmark_input_poll_cb();
+
+   for (i = 0; i <= RETRO_DEVICE_ID_JOYPAD_R3; i++)
+      if (benchmark_input_state_cb(0, RETRO_DEVICE_JOYPAD, 0, i))
+         input |= 1 << i;
+
+   benchmark_run_state(input);
+   benchmark_run_video();
+   if (benchmark.config.audio_batch)
+      benchmark_run_audio();
+}
+
+size_t libretro_benchmark_retro_serialize_size(void)
+{
+   return benchmark.config.serialize_size;
+}
+
+bool libretro_benchmark_retro_serialize(void *data, size_t size)
+{
+   if (!benchmark.state || size < benchmark.config.serialize_size)
+      return false;
+
+   memcpy(data, benchmark.state, benchmark.config.serialize_size);
+   return true;
+}
+
+bool libretro_benchmark_retro_unserialize(const void *data, size_t size)
+{
+   if (!benchmark.state || size < benchmark.config.serialize_size)
+      return false;
+
+   memcpy(benchmark.state, data, benchmark.config.serialize_size);
+   benchmark_read_header();
+   return true;
+}
+
+void libretro_benchmark_retro_cheat_reset(void)
+{
+}
+
+void libretro_benchmark_retro_cheat_set(unsigned index,
+      bool enabled, const char *code)
+{
+   (void)index;
+   (void)enabled;
+   (void)code;
+}
+
+bool libretro_benchmark_retro_load_game(const struct retro_game_info *game)
+{
+   struct benchmark_core_config *config = &benchmark.config;
+   enum retro_pixel_format fmt          = benchmark_config.pixel_format;
+
+   (void)game;
+
+   benchmark_free();
+   *config = benchmark_config;
+
+   if (!config->width)
+      config->width = 1;
+   if (!config->height)
+      config->height = 1;
+   if (config->serialize_size < BENCHMARK_HEADER_SIZE)
+      config->serialize_size = BENCHMARK_HEADER_SIZE;
+   if (config->dirty_ratio < 0.0f)
+      config->dirty_ratio = 0.0f;
+   if (config->dirty_ratio > 1.0f)
+      config->dirty_ratio = 1.0f;
+
+   if (!benchmark_environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &fmt))
+      fmt = RETRO_PIXEL_FORMAT_0RGB1555;
+   config->pixel_format = fmt;
+   benchmark.bpp        = fmt == RETRO_PIXEL_FORMAT_XRGB8888 ? 4 : 2;
+
+   benchmark.frame = (uint8_t*)calloc(
+         (size_t)config->width * config->height, benchmark.bpp);
+   benchmark.audio = (int16_t*)calloc(config->audio_batch + 1,
+         2 * sizeof(int16_t));
+   benchmark.state = (uint8_t*)calloc(1, config->serialize_size);
+   benchmark.sram  = (uint8_t*)calloc(1, config->sram_size + 1);
+
+   if (!benchmark.frame || !benchmark.audio
+         || !benchmark.state || !benchmark.sram)
+   {
+      benchmark_free();
+      return false;
+   }
+
+   benchmark_reset_state();
+   benchmark_init_memory_map();
+
+   return true;
+}
+
+bool libretro_benchmark_retro_load_game_special(unsigned game_type,
+      const struct retro_game_info *info, size_t num_info)
+{
+   (void)game_type;
+   (void)info;
+   (void)num_info;
+   return false;
+}
+
+void libretro_benchmark_retro_unload_game(void)
+{
+   benchmark_free();
+}
+
+unsigned libretro_benchmark_retro_get_region(void)
+{
+   return RETRO_REGION_NTSC;
+}
+
+void *libretro_benchmark_retro_get_memory_data(unsigned id)
+{
+   switch (id)
+   {
+      case RETRO_MEMORY_SAVE_RAM:
+         return benchmark.config.sram_size ? benchmark.sram : NULL;
+      case RETRO_MEMORY_SYSTEM_RAM:
+         return benchmark.state;
+      default:
+         break;
+   }
+
+   return NULL;
+}
+
+size_t libretro_benchmark_retro_get_memory_size(unsigned id)
+{
+   switch (id)
+   {
+      case RETRO_MEMORY_SAVE_RAM:
+         return benchmark.sram ? benchmark.config.sram_size : 0;
+      case RETRO_MEMORY_SYSTEM_RAM:
+         return benchmark.state ? benchmark.config.serialize_size : 0;
+      default:
+         break;
+   }
+
+   return 0;
+}
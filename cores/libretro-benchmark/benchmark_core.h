@@ -0,0 +1,89 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2016 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCHMARK_CORE_H__
+#define BENCHMARK_CORE_H__
+
+#include <stddef.h>
+
+#include <boolean.h>
+
+#include "../../libretro.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Longest memory map description, e.g. "0:2000,8000:8000". */
+#define BENCHMARK_CORE_MEMORY_MAP_LEN 256
+
+struct benchmark_core_config
+{
+   unsigned width;
+   unsigned height;
+   enum retro_pixel_format pixel_format;
+   /* Stereo frames passed to audio_sample_batch per frame. */
+   unsigned audio_batch;
+   size_t serialize_size;
+   /* Fraction of the state that changes every frame, 0.0 to 1.0. */
+   float dirty_ratio;
+   size_t sram_size;
+   /* Comma separated start:size pairs in hex, each one mapping the
+    * next part of the state into the memory map. Empty maps the
+    * whole state at address 0. */
+   char memory_map[BENCHMARK_CORE_MEMORY_MAP_LEN];
+};
+
+/**
+ * libretro_benchmark_set_config:
+ * @config              : Configuration of the next game.
+ *
+ * Configures the synthetic core. Takes effect at the next
+ * retro_load_game().
+ **/
+void libretro_benchmark_set_config(const struct benchmark_core_config *config);
+
+void libretro_benchmark_retro_init(void);
+void libretro_benchmark_retro_deinit(void);
+unsigned libretro_benchmark_retro_api_version(void);
+void libretro_benchmark_retro_get_system_info(struct retro_system_info *info);
+void libretro_benchmark_retro_get_system_av_info(struct retro_system_av_info *info);
+void libretro_benchmark_retro_set_environment(retro_environment_t cb);
+void libretro_benchmark_retro_set_video_refresh(retro_video_refresh_t cb);
+void libretro_benchmark_retro_set_audio_sample(retro_audio_sample_t cb);
+void libretro_benchmark_retro_set_audio_sample_batch(retro_audio_sample_batch_t cb);
+void libretro_benchmark_retro_set_input_poll(retro_input_poll_t cb);
+void libretro_benchmark_retro_set_input_state(retro_input_state_t cb);
+void libretro_benchmark_retro_set_controller_port_device(unsigned port, unsigned device);
+void libretro_benchmark_retro_reset(void);
+void libretro_benchmark_retro_run(void);
+size_t libretro_benchmark_retro_serialize_size(void);
+bool libretro_benchmark_retro_serialize(void *data, size_t size);
+bool libretro_benchmark_retro_unserialize(const void *data, size_t size);
+void libretro_benchmark_retro_cheat_reset(void);
+void libretro_benchmark_retro_cheat_set(unsigned index, bool enabled, const char *code);
+bool libretro_benchmark_retro_load_game(const struct retro_game_info *game);
+bool libretro_benchmark_retro_load_game_special(unsigned game_type,
+      const struct retro_game_info *info, size_t num_info);
+void libretro_benchmark_retro_unload_game(void);
+unsigned libretro_benchmark_retro_get_region(void);
+void *libretro_benchmark_retro_get_memory_data(unsigned id);
+size_t libretro_benchmark_retro_get_memory_size(unsigned id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
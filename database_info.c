@@ -16,14 +16,20 @@
  */
 
 #include <stdint.h>
+#include <string.h>
 
 #include <file/file_extract.h>
 #include <retro_endianness.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #include "dir_list_special.h"
 #include "database_info.h"
 #include "msg_hash.h"
 #include "general.h"
+#include "mem_account.h"
+#include "performance.h"
 #include "verbosity.h"
 
 #ifdef HAVE_CONFIG_H
@@ -76,6 +82,39 @@
 #define DB_CURSOR_SIZE                          0x7c9dede0U
 #define DB_CURSOR_SERIAL                        0x1b843ec5U
 
+#ifndef DATABASE_INFO_MAX_THREADS
+#define DATABASE_INFO_MAX_THREADS 8
+#endif
+
+#ifndef DATABASE_INFO_QUERY_CACHE_SIZE
+#define DATABASE_INFO_QUERY_CACHE_SIZE 8
+#endif
+
+struct database_info_cursor
+{
+   libretrodb_t *db;
+   libretrodb_cursor_t *cur;
+   size_t limit;
+   size_t count;
+   bool done;
+};
+
+/* Compiled queries, keyed by (database path, query string). */
+struct database_info_query_cache_entry
+{
+   char *rdb_path;
+   char *query;
+   libretrodb_query_t *q;
+   unsigned long last_used;
+};
+
+static struct database_info_query_cache_entry
+   database_info_query_cache[DATABASE_INFO_QUERY_CACHE_SIZE];
+static unsigned long database_info_query_cache_clock;
+#ifdef HAVE_THREADS
+static slock_t *database_info_query_cache_lock;
+#endif
+
 static void database_info_build_query_add_quote(char *s, size_t len)
 {
    strlcat(s, "\"", len);
@@ -345,45 +384,260 @@ static int database_cursor_iterate(libretrodb_cursor_t *cur,
    return 0;
 }
 
+/* The lock is created by database_info_init() before any scan
+ * thread can run, so it is never NULL while cursors are in use. */
+static void database_info_query_lock(void)
+{
+#ifdef HAVE_THREADS
+   slock_lock(database_info_query_cache_lock);
+#endif
+}
+
+static void database_info_query_unlock(void)
+{
+#ifdef HAVE_THREADS
+   slock_unlock(database_info_query_cache_lock);
+#endif
+}
+
+/**
+ * database_info_query_cache_get:
+ * @db                  : Opened database, needed for compiling.
+ * @rdb_path            : Path of @db.
+ * @query               : Query string.
+ *
+ * Looks up the compiled form of @query for @rdb_path, compiling
+ * and caching it on a miss. The least recently used entry is
+ * evicted once the cache is full. Has to be called with the
+ * query cache lock held.
+ *
+ * Returns: compiled query owned by the cache, or NULL on error.
+ **/
+static libretrodb_query_t *database_info_query_cache_get(
+      libretrodb_t *db, const char *rdb_path, const char *query)
+{
+   unsigned i;
+   const char *error                             = NULL;
+   libretrodb_query_t *q                         = NULL;
+   struct database_info_query_cache_entry *entry = NULL;
+
+   for (i = 0; i < DATABASE_INFO_QUERY_CACHE_SIZE; i++)
+   {
+      entry = &database_info_query_cache[i];
+
+      if (!entry->q)
+         continue;
+      if (strcmp(entry->query, query) || strcmp(entry->rdb_path, rdb_path))
+         continue;
+
+      entry->last_used = ++database_info_query_cache_clock;
+      return entry->q;
+   }
+
+   q = (libretrodb_query_t*)libretrodb_query_compile(db, query,
+         strlen(query), &error);
+
+   if (error || !q)
+   {
+      RARCH_ERR("Invalid database query \"%s\": %s\n",
+            query, error ? error : "");
+      if (q)
+         libretrodb_query_free(q);
+      return NULL;
+   }
+
+   entry = &database_info_query_cache[0];
+   for (i = 1; i < DATABASE_INFO_QUERY_CACHE_SIZE; i++)
+   {
+      if (!entry->q)
+         break;
+      if (!database_info_query_cache[i].q
+            || database_info_query_cache[i].last_used < entry->last_used)
+         entry = &database_info_query_cache[i];
+   }
+
+   /* Cursors still using an evicted query keep their own reference. */
+   if (entry->q)
+      libretrodb_query_free(entry->q);
+   free(entry->rdb_path);
+   free(entry->query);
+
+   entry->rdb_path  = strdup(rdb_path);
+   entry->query     = strdup(query);
+   entry->q         = q;
+   entry->last_used = ++database_info_query_cache_clock;
+
+   return q;
+}
+
+void database_info_query_cache_clear(void)
+{
+   unsigned i;
+
+   database_info_query_lock();
+
+   for (i = 0; i < DATABASE_INFO_QUERY_CACHE_SIZE; i++)
+   {
+      struct database_info_query_cache_entry *entry =
+         &database_info_query_cache[i];
+
+      if (entry->q)
+         libretrodb_query_free(entry->q);
+      free(entry->rdb_path);
+      free(entry->query);
+      memset(entry, 0, sizeof(*entry));
+   }
+
+   database_info_query_unlock();
+}
+
+void database_info_init(void)
+{
+#ifdef HAVE_THREADS
+   if (!database_info_query_cache_lock)
+      database_info_query_cache_lock = slock_new();
+#endif
+}
+
+void database_info_deinit(void)
+{
+   database_info_query_cache_clear();
+
+#ifdef HAVE_THREADS
+   slock_free(database_info_query_cache_lock);
+   database_info_query_cache_lock = NULL;
+#endif
+}
+
 static int database_cursor_open(libretrodb_t *db,
       libretrodb_cursor_t *cur, const char *path, const char *query)
 {
-   const char *error     = NULL;
+   int ret               = 0;
    libretrodb_query_t *q = NULL;
 
    if ((libretrodb_open(path, db)) != 0)
       return -1;
 
-   if (query) 
-      q = (libretrodb_query_t*)libretrodb_query_compile(db, query,
-      strlen(query), &error);
-    
-   if (error)
-      goto error;
-   if ((libretrodb_cursor_open(db, cur, q)) != 0)
-      goto error;
+   /* The cursor takes its own reference on the query, so this
+    * and closing the cursor have to happen under the cache lock. */
+   database_info_query_lock();
 
-   if (q)
-      libretrodb_query_free(q);
+   if (query)
+      q = database_info_query_cache_get(db, path, query);
 
-   return 0;
+   if (query && !q)
+      ret = -1;
+   else
+      ret = libretrodb_cursor_open(db, cur, q);
 
-error:
-   if (q)
-      libretrodb_query_free(q);
-   libretrodb_close(db);
+   database_info_query_unlock();
 
-   return -1;
+   if (ret != 0)
+   {
+      libretrodb_close(db);
+      return -1;
+   }
+
+   return 0;
 }
 
 static int database_cursor_close(libretrodb_t *db, libretrodb_cursor_t *cur)
 {
+   database_info_query_lock();
    libretrodb_cursor_close(cur);
+   database_info_query_unlock();
+
    libretrodb_close(db);
 
    return 0;
 }
 
+database_info_cursor_t *database_info_cursor_new(const char *rdb_path,
+      const char *query, size_t offset, size_t limit)
+{
+   database_info_cursor_t *cursor = (database_info_cursor_t*)
+      calloc(1, sizeof(*cursor));
+
+   if (!cursor)
+      return NULL;
+
+   cursor->db    = libretrodb_new();
+   cursor->cur   = libretrodb_cursor_new();
+   cursor->limit = limit;
+
+   if (!cursor->db || !cursor->cur)
+      goto error;
+
+   if (database_cursor_open(cursor->db, cursor->cur, rdb_path, query) != 0)
+      goto error;
+
+   /* Skipped records are only decoded, never converted. */
+   while (offset)
+   {
+      struct rmsgpack_dom_value item;
+
+      if (libretrodb_cursor_read_item(cursor->cur, &item) != 0)
+      {
+         cursor->done = true;
+         break;
+      }
+
+      if (item.type == RDT_MAP)
+         offset--;
+      rmsgpack_dom_value_free(&item);
+   }
+
+   return cursor;
+
+error:
+   if (cursor->cur)
+      libretrodb_cursor_free(cursor->cur);
+   if (cursor->db)
+      libretrodb_free(cursor->db);
+   free(cursor);
+   return NULL;
+}
+
+int database_info_cursor_next(database_info_cursor_t *cursor,
+      database_info_t *info)
+{
+   int ret = 1;
+
+   if (!cursor || !info)
+      return -1;
+
+   while (!cursor->done)
+   {
+      if (cursor->limit && cursor->count >= cursor->limit)
+         break;
+
+      memset(info, 0, sizeof(*info));
+      ret = database_cursor_iterate(cursor->cur, info);
+
+      if (ret == 0)
+      {
+         cursor->count++;
+         return 0;
+      }
+
+      if (ret == -1)
+         cursor->done = true;
+   }
+
+   return 1;
+}
+
+void database_info_cursor_free(database_info_cursor_t *cursor)
+{
+   if (!cursor)
+      return;
+
+   database_cursor_close(cursor->db, cursor->cur);
+   libretrodb_cursor_free(cursor->cur);
+   libretrodb_free(cursor->db);
+   free(cursor);
+}
+
 database_info_handle_t *database_info_dir_init(const char *dir,
       enum database_type type)
 {
@@ -450,18 +704,55 @@ void database_info_free(database_info_handle_t *db)
 database_info_list_t *database_info_list_new(
       const char *rdb_path, const char *query)
 {
-   int ret                                  = 0;
-   unsigned k                               = 0;
-   database_info_t *database_info           = NULL;
-   database_info_list_t *database_info_list = NULL;
-   libretrodb_t *db                         = libretrodb_new();
-   libretrodb_cursor_t *cur                 = libretrodb_cursor_new();
+   return database_info_list_new_range(rdb_path, query, 0, 0);
+}
 
-   if (!db || !cur)
-      goto end;
+static size_t database_info_strsize(const char *s)
+{
+   return s ? strlen(s) + 1 : 0;
+}
 
-   if ((database_cursor_open(db, cur, rdb_path, query) != 0))
-      goto end;
+/* Approximate heap footprint of a record held by a list,
+ * accounted to MEM_TAG_DATABASE. */
+static size_t database_info_entry_footprint(const database_info_t *info)
+{
+   size_t i;
+   size_t size = sizeof(*info)
+      + database_info_strsize(info->name)
+      + database_info_strsize(info->rom_name)
+      + database_info_strsize(info->serial)
+      + database_info_strsize(info->description)
+      + database_info_strsize(info->publisher)
+      + database_info_strsize(info->origin)
+      + database_info_strsize(info->franchise)
+      + database_info_strsize(info->edge_magazine_review)
+      + database_info_strsize(info->bbfc_rating)
+      + database_info_strsize(info->elspa_rating)
+      + database_info_strsize(info->esrb_rating)
+      + database_info_strsize(info->pegi_rating)
+      + database_info_strsize(info->cero_rating)
+      + database_info_strsize(info->enhancement_hw)
+      + database_info_strsize(info->sha1)
+      + database_info_strsize(info->md5);
+
+   if (info->developer)
+      for (i = 0; i < info->developer->size; i++)
+         size += database_info_strsize(info->developer->elems[i].data);
+
+   return size;
+}
+
+database_info_list_t *database_info_list_new_range(
+      const char *rdb_path, const char *query, size_t offset, size_t limit)
+{
+   size_t cap                               = 0;
+   database_info_t db_info                  = {0};
+   database_info_list_t *database_info_list = NULL;
+   database_info_cursor_t *cursor           = database_info_cursor_new(
+         rdb_path, query, offset, limit);
+
+   if (!cursor)
+      return NULL;
 
    database_info_list = (database_info_list_t*)
       calloc(1, sizeof(*database_info_list));
@@ -469,48 +760,207 @@ database_info_list_t *database_info_list_new(
    if (!database_info_list)
       goto end;
 
-   while (ret != -1)
+   while (database_info_cursor_next(cursor, &db_info) == 0)
    {
-      database_info_t db_info = {0};
-      ret = database_cursor_iterate(cur, &db_info);
-
-      if (ret == 0)
+      if (database_info_list->count == cap)
       {
-         database_info_t *db_ptr  = NULL;
+         size_t new_cap           = cap ? cap * 2 : 32;
          database_info_t *new_ptr = (database_info_t*)
-            realloc(database_info, (k+1) * sizeof(database_info_t));
+            realloc(database_info_list->list, new_cap * sizeof(database_info_t));
 
          if (!new_ptr)
          {
+            database_info_entry_free(&db_info);
             database_info_list_free(database_info_list);
             database_info_list = NULL;
             goto end;
          }
 
-         database_info = new_ptr;
-         db_ptr        = &database_info[k];
+         database_info_list->list = new_ptr;
+         cap                      = new_cap;
+      }
 
-         if (!db_ptr)
-            continue;
+      mem_account_add(MEM_TAG_DATABASE,
+            database_info_entry_footprint(&db_info));
+      memcpy(&database_info_list->list[database_info_list->count++],
+            &db_info, sizeof(db_info));
+   }
 
-         memcpy(db_ptr, &db_info, sizeof(*db_ptr));
+end:
+   database_info_cursor_free(cursor);
 
-         k++;
+   return database_info_list;
+}
+
+struct database_info_multi
+{
+   const struct string_list *rdb_paths;
+   const char *query;
+   database_info_list_t **results;
+   size_t next;
+#ifdef HAVE_THREADS
+   slock_t *lock;
+#endif
+};
+
+static void database_info_multi_worker(void *data)
+{
+   struct database_info_multi *multi = (struct database_info_multi*)data;
+
+   for (;;)
+   {
+      size_t i;
+
+#ifdef HAVE_THREADS
+      /* No lock when the calling thread is the only worker. */
+      if (multi->lock)
+         slock_lock(multi->lock);
+#endif
+      i = multi->next++;
+#ifdef HAVE_THREADS
+      if (multi->lock)
+         slock_unlock(multi->lock);
+#endif
+
+      if (i >= multi->rdb_paths->size)
+         break;
+
+      /* Each slot is only written by the worker that claimed it. */
+      multi->results[i] = database_info_list_new(
+            multi->rdb_paths->elems[i].data, multi->query);
+   }
+}
+
+database_info_list_t *database_info_list_new_multi(
+      const struct string_list *rdb_paths, const char *query,
+      unsigned num_threads)
+{
+   size_t i, count                 = 0;
+   struct database_info_multi multi = {0};
+   database_info_list_t *list      = NULL;
+#ifdef HAVE_THREADS
+   unsigned j;
+   sthread_t *threads[DATABASE_INFO_MAX_THREADS] = {NULL};
+#endif
+
+   if (!rdb_paths || !rdb_paths->size)
+      return NULL;
+
+   multi.rdb_paths = rdb_paths;
+   multi.query     = query;
+   multi.results   = (database_info_list_t**)
+      calloc(rdb_paths->size, sizeof(*multi.results));
+
+   if (!multi.results)
+      return NULL;
+
+   if (!num_threads)
+      num_threads = retro_get_cpu_cores();
+   num_threads = MAX(1, MIN(num_threads, DATABASE_INFO_MAX_THREADS));
+   if (num_threads > rdb_paths->size)
+      num_threads = rdb_paths->size;
+
+#ifdef HAVE_THREADS
+   if (num_threads > 1)
+      multi.lock = slock_new();
+
+   /* The calling thread is one of the workers. */
+   for (j = 1; multi.lock && j < num_threads; j++)
+      threads[j] = sthread_create(database_info_multi_worker, &multi);
+#endif
+
+   database_info_multi_worker(&multi);
+
+#ifdef HAVE_THREADS
+   for (j = 1; j < num_threads; j++)
+      if (threads[j])
+         sthread_join(threads[j]);
+   if (multi.lock)
+      slock_free(multi.lock);
+#endif
+
+   /* Merge in database order, records keep their order within
+    * each database, so the result does not depend on scheduling. */
+   for (i = 0; i < rdb_paths->size; i++)
+      if (multi.results[i])
+         count += multi.results[i]->count;
+
+   list = (database_info_list_t*)calloc(1, sizeof(*list));
+   if (list && count)
+      list->list = (database_info_t*)calloc(count, sizeof(database_info_t));
+
+   for (i = 0; i < rdb_paths->size; i++)
+   {
+      database_info_list_t *result = multi.results[i];
+
+      if (!result)
+         continue;
+
+      if (list && list->list)
+      {
+         memcpy(&list->list[list->count], result->list,
+               result->count * sizeof(database_info_t));
+         list->count += result->count;
+         /* Entries now belong to the merged list. */
+         result->count = 0;
       }
-   } 
 
-   database_info_list->list  = database_info;
-   database_info_list->count = k;
+      database_info_list_free(result);
+   }
 
-end:
-   database_cursor_close(db, cur);
+   if (list && count && !list->list)
+   {
+      free(list);
+      list = NULL;
+   }
 
-   if (db)
-      libretrodb_free(db);
-   if (cur)
-      libretrodb_cursor_free(cur);
+   free(multi.results);
+   return list;
+}
 
-   return database_info_list;
+void database_info_entry_free(database_info_t *info)
+{
+   if (!info)
+      return;
+
+   if (info->name)
+      free(info->name);
+   if (info->rom_name)
+      free(info->rom_name);
+   if (info->serial)
+      free(info->serial);
+   if (info->description)
+      free(info->description);
+   if (info->publisher)
+      free(info->publisher);
+   if (info->developer)
+      string_list_free(info->developer);
+   info->developer = NULL;
+   if (info->origin)
+      free(info->origin);
+   if (info->franchise)
+      free(info->franchise);
+   if (info->edge_magazine_review)
+      free(info->edge_magazine_review);
+
+   if (info->cero_rating)
+      free(info->cero_rating);
+   if (info->pegi_rating)
+      free(info->pegi_rating);
+   if (info->enhancement_hw)
+      free(info->enhancement_hw);
+   if (info->elspa_rating)
+      free(info->elspa_rating);
+   if (info->esrb_rating)
+      free(info->esrb_rating);
+   if (info->bbfc_rating)
+      free(info->bbfc_rating);
+   if (info->sha1)
+      free(info->sha1);
+   if (info->md5)
+      free(info->md5);
+
+   memset(info, 0, sizeof(*info));
 }
 
 void database_info_list_free(database_info_list_t *database_info_list)
@@ -522,47 +972,9 @@ void database_info_list_free(database_info_list_t *database_info_list)
 
    for (i = 0; i < database_info_list->count; i++)
    {
-      database_info_t *info = &database_info_list->list[i];
-
-      if (!info)
-         continue;
-
-      if (info->name)
-         free(info->name);
-      if (info->rom_name)
-         free(info->rom_name);
-      if (info->serial)
-         free(info->serial);
-      if (info->description)
-         free(info->description);
-      if (info->publisher)
-         free(info->publisher);
-      if (info->developer)
-         string_list_free(info->developer);
-      info->developer = NULL;
-      if (info->origin)
-         free(info->origin);
-      if (info->franchise)
-         free(info->franchise);
-      if (info->edge_magazine_review)
-         free(info->edge_magazine_review);
-
-      if (info->cero_rating)
-         free(info->cero_rating);
-      if (info->pegi_rating)
-         free(info->pegi_rating);
-      if (info->enhancement_hw)
-         free(info->enhancement_hw);
-      if (info->elspa_rating)
-         free(info->elspa_rating);
-      if (info->esrb_rating)
-         free(info->esrb_rating);
-      if (info->bbfc_rating)
-         free(info->bbfc_rating);
-      if (info->sha1)
-         free(info->sha1);
-      if (info->md5)
-         free(info->md5);
+      mem_account_sub(MEM_TAG_DATABASE,
+            database_info_entry_footprint(&database_info_list->list[i]));
+      database_info_entry_free(&database_info_list->list[i]);
    }
 
    free(database_info_list->list);
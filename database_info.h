@@ -97,9 +97,93 @@ typedef struct
    size_t count;
 } database_info_list_t;
 
+typedef struct database_info_cursor database_info_cursor_t;
+
+/**
+ * database_info_cursor_new:
+ * @rdb_path            : Path to the database.
+ * @query               : Query string, NULL matches every record.
+ * @offset              : Number of matching records to skip.
+ * @limit               : Maximum number of records to return, 0 for
+ *                        no limit.
+ *
+ * Opens a cursor that streams matching records one at a time.
+ * Compiled queries are cached per (@rdb_path, @query), so paging
+ * through a result set does not compile the query again. Freeing
+ * the cursor early stops the query.
+ *
+ * Returns: new cursor, or NULL on error.
+ **/
+database_info_cursor_t *database_info_cursor_new(const char *rdb_path,
+      const char *query, size_t offset, size_t limit);
+
+/**
+ * database_info_cursor_next:
+ * @cursor              : Cursor handle.
+ * @info                : Filled with the next record. The caller owns
+ *                        the record and frees it with
+ *                        database_info_entry_free().
+ *
+ * Returns: 0 if a record was read, 1 once the cursor is exhausted
+ * or the limit was reached, -1 on error.
+ **/
+int database_info_cursor_next(database_info_cursor_t *cursor,
+      database_info_t *info);
+
+void database_info_cursor_free(database_info_cursor_t *cursor);
+
+/* Drops every compiled query held by the cursor query cache. */
+void database_info_query_cache_clear(void);
+
+/**
+ * database_info_init:
+ *
+ * Sets up the cursor query cache. Must be called on the main
+ * thread before any database cursor is opened.
+ **/
+void database_info_init(void);
+
+/**
+ * database_info_deinit:
+ *
+ * Drops the cursor query cache. No database cursor may be in use.
+ **/
+void database_info_deinit(void);
+
 database_info_list_t *database_info_list_new(const char *rdb_path,
       const char *query);
 
+/**
+ * database_info_list_new_range:
+ * @rdb_path            : Path to the database.
+ * @query               : Query string, NULL matches every record.
+ * @offset              : Number of matching records to skip.
+ * @limit               : Maximum number of records, 0 for no limit.
+ *
+ * Like database_info_list_new(), restricted to one page of results.
+ **/
+database_info_list_t *database_info_list_new_range(const char *rdb_path,
+      const char *query, size_t offset, size_t limit);
+
+/**
+ * database_info_list_new_multi:
+ * @rdb_paths           : Databases to query.
+ * @query               : Query string, NULL matches every record.
+ * @num_threads         : Maximum number of databases queried at once,
+ *                        0 picks one per CPU core.
+ *
+ * Runs @query against every database in @rdb_paths concurrently.
+ * The results are merged in the order of @rdb_paths, keeping the
+ * record order of each database.
+ *
+ * Returns: merged list of records, or NULL on error.
+ **/
+database_info_list_t *database_info_list_new_multi(
+      const struct string_list *rdb_paths, const char *query,
+      unsigned num_threads);
+
+void database_info_entry_free(database_info_t *info);
+
 void database_info_list_free(database_info_list_t *list);
 
 database_info_handle_t *database_info_dir_init(const char *dir,
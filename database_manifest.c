@@ -0,0 +1,613 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2016 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <boolean.h>
+#include <retro_file.h>
+#include <file/file_path.h>
+
+#include "database_manifest.h"
+#include "file_ops.h"
+#include "msg_hash.h"
+#include "verbosity.h"
+
+/* The manifest is a line based text file:
+ *
+ *  RetroArch scan manifest 2
+ *  D <tab> size <tab> mtime <tab> database path
+ *  F <tab> size <tab> mtime <tab> content path
+ *  E <tab> crc32 (hex) <tab> matched (0/1) <tab> archive entry name
+ *  T <tab> number of 'F' lines <tab>
+ *
+ * 'E' lines belong to the preceding 'F' line. Plain files have
+ * a single 'E' line with an empty entry name. The 'T' line ends
+ * the file, so a truncated manifest is not mistaken for a
+ * smaller one.
+ */
+#define DATABASE_MANIFEST_HEADER "RetroArch scan manifest 2"
+
+#ifdef _WIN32
+#define DATABASE_MANIFEST_FMT_STAT "%c\t%I64u\t%I64d\t%s\n"
+#else
+#define DATABASE_MANIFEST_FMT_STAT "%c\t%llu\t%lld\t%s\n"
+#endif
+
+struct database_manifest_db
+{
+   char *path;
+   uint64_t size;
+   int64_t mtime;
+};
+
+struct database_manifest
+{
+   /* Records in insertion order, so written manifests are stable. */
+   database_manifest_file_t **files;
+   size_t count;
+   size_t cap;
+
+   /* Open addressing table, holds file index + 1 (0 is empty). */
+   size_t *buckets;
+   size_t mask;
+
+   struct database_manifest_db *dbs;
+   size_t db_count;
+};
+
+database_manifest_file_t *database_manifest_file_new(const char *path,
+      uint64_t size, int64_t mtime)
+{
+   database_manifest_file_t *file = NULL;
+
+   if (!path)
+      return NULL;
+
+   file = (database_manifest_file_t*)calloc(1, sizeof(*file));
+   if (!file)
+      return NULL;
+
+   file->path  = strdup(path);
+   file->size  = size;
+   file->mtime = mtime;
+
+   if (!file->path)
+   {
+      free(file);
+      return NULL;
+   }
+
+   return file;
+}
+
+bool database_manifest_file_add_entry(database_manifest_file_t *file,
+      const char *name, uint32_t crc, bool matched)
+{
+   database_manifest_entry_t *entry = NULL;
+
+   if (!file)
+      return false;
+
+   if (file->count == file->cap)
+   {
+      size_t new_cap = file->cap ? file->cap * 2 : 1;
+      database_manifest_entry_t *new_entries = (database_manifest_entry_t*)
+         realloc(file->entries, new_cap * sizeof(*new_entries));
+
+      if (!new_entries)
+         return false;
+
+      file->entries = new_entries;
+      file->cap     = new_cap;
+   }
+
+   entry          = &file->entries[file->count++];
+   entry->name    = (name && *name) ? strdup(name) : NULL;
+   entry->crc     = crc;
+   entry->matched = matched;
+
+   return true;
+}
+
+database_manifest_file_t *database_manifest_file_dup(
+      const database_manifest_file_t *file)
+{
+   size_t i;
+   database_manifest_file_t *dup = NULL;
+
+   if (!file)
+      return NULL;
+
+   dup = database_manifest_file_new(file->path, file->size, file->mtime);
+
+   for (i = 0; dup && i < file->count; i++)
+   {
+      const database_manifest_entry_t *entry = &file->entries[i];
+
+      if (!database_manifest_file_add_entry(dup,
+               entry->name, entry->crc, entry->matched))
+      {
+         database_manifest_file_free(dup);
+         return NULL;
+      }
+   }
+
+   return dup;
+}
+
+void database_manifest_file_free(database_manifest_file_t *file)
+{
+   size_t i;
+
+   if (!file)
+      return;
+
+   for (i = 0; i < file->count; i++)
+      free(file->entries[i].name);
+
+   free(file->entries);
+   free(file->path);
+   free(file);
+}
+
+database_manifest_t *database_manifest_new(void)
+{
+   return (database_manifest_t*)calloc(1, sizeof(database_manifest_t));
+}
+
+static size_t database_manifest_slot(const database_manifest_t *manifest,
+      const char *path)
+{
+   size_t slot = msg_hash_calculate(path) & manifest->mask;
+
+   while (manifest->buckets[slot])
+   {
+      if (!strcmp(manifest->files[manifest->buckets[slot] - 1]->path, path))
+         break;
+      slot = (slot + 1) & manifest->mask;
+   }
+
+   return slot;
+}
+
+static bool database_manifest_rehash(database_manifest_t *manifest,
+      size_t size)
+{
+   size_t i;
+   size_t *buckets = (size_t*)calloc(size, sizeof(*buckets));
+
+   if (!buckets)
+      return false;
+
+   free(manifest->buckets);
+   manifest->buckets = buckets;
+   manifest->mask    = size - 1;
+
+   for (i = 0; i < manifest->count; i++)
+      manifest->buckets[database_manifest_slot(manifest,
+            manifest->files[i]->path)] = i + 1;
+
+   return true;
+}
+
+const database_manifest_file_t *database_manifest_find(
+      const database_manifest_t *manifest, const char *path)
+{
+   size_t slot;
+
+   if (!manifest || !manifest->buckets || !path)
+      return NULL;
+
+   slot = database_manifest_slot(manifest, path);
+
+   if (!manifest->buckets[slot])
+      return NULL;
+   return manifest->files[manifest->buckets[slot] - 1];
+}
+
+bool database_manifest_insert(database_manifest_t *manifest,
+      database_manifest_file_t *file)
+{
+   size_t slot;
+
+   if (!manifest || !file)
+      return false;
+
+   if (!manifest->buckets || (manifest->count + 1) * 2 > manifest->mask + 1)
+   {
+      if (!database_manifest_rehash(manifest,
+               manifest->buckets ? (manifest->mask + 1) * 2 : 256))
+         return false;
+   }
+
+   slot = database_manifest_slot(manifest, file->path);
+
+   if (manifest->buckets[slot])
+   {
+      size_t idx = manifest->buckets[slot] - 1;
+
+      database_manifest_file_free(manifest->files[idx]);
+      manifest->files[idx] = file;
+      return true;
+   }
+
+   if (manifest->count == manifest->cap)
+   {
+      size_t new_cap = manifest->cap ? manifest->cap * 2 : 256;
+      database_manifest_file_t **new_files = (database_manifest_file_t**)
+         realloc(manifest->files, new_cap * sizeof(*new_files));
+
+      if (!new_files)
+         return false;
+
+      manifest->files = new_files;
+      manifest->cap   = new_cap;
+   }
+
+   manifest->files[manifest->count++] = file;
+   manifest->buckets[slot]            = manifest->count;
+
+   return true;
+}
+
+void database_manifest_merge_missing(database_manifest_t *dst,
+      const database_manifest_t *src)
+{
+   size_t i;
+
+   if (!dst || !src)
+      return;
+
+   for (i = 0; i < src->count; i++)
+   {
+      database_manifest_file_t *file = NULL;
+
+      if (database_manifest_find(dst, src->files[i]->path))
+         continue;
+
+      file = database_manifest_file_dup(src->files[i]);
+      if (!database_manifest_insert(dst, file))
+         database_manifest_file_free(file);
+   }
+}
+
+static void database_manifest_free_databases(database_manifest_t *manifest)
+{
+   size_t i;
+
+   for (i = 0; i < manifest->db_count; i++)
+      free(manifest->dbs[i].path);
+
+   free(manifest->dbs);
+   manifest->dbs      = NULL;
+   manifest->db_count = 0;
+}
+
+static bool database_manifest_add_database(database_manifest_t *manifest,
+      const char *path, uint64_t size, int64_t mtime)
+{
+   struct database_manifest_db *dbs = (struct database_manifest_db*)
+      realloc(manifest->dbs, (manifest->db_count + 1) * sizeof(*dbs));
+
+   if (!dbs)
+      return false;
+
+   manifest->dbs                          = dbs;
+   manifest->dbs[manifest->db_count].path  = strdup(path);
+   manifest->dbs[manifest->db_count].size  = size;
+   manifest->dbs[manifest->db_count].mtime = mtime;
+   manifest->db_count++;
+
+   return true;
+}
+
+void database_manifest_set_databases(database_manifest_t *manifest,
+      const struct string_list *databases)
+{
+   size_t i;
+
+   if (!manifest)
+      return;
+
+   database_manifest_free_databases(manifest);
+
+   if (!databases)
+      return;
+
+   for (i = 0; i < databases->size; i++)
+   {
+      uint64_t size = 0;
+      int64_t mtime = 0;
+
+      file_get_stat(databases->elems[i].data, &size, &mtime);
+      database_manifest_add_database(manifest,
+            databases->elems[i].data, size, mtime);
+   }
+}
+
+bool database_manifest_databases_equal(const database_manifest_t *a,
+      const database_manifest_t *b)
+{
+   size_t i;
+
+   if (!a || !b || a->db_count != b->db_count)
+      return false;
+
+   for (i = 0; i < a->db_count; i++)
+   {
+      if (a->dbs[i].size  != b->dbs[i].size)
+         return false;
+      if (a->dbs[i].mtime != b->dbs[i].mtime)
+         return false;
+      if (strcmp(a->dbs[i].path, b->dbs[i].path))
+         return false;
+   }
+
+   return true;
+}
+
+bool database_manifest_write(database_manifest_t *manifest,
+      const char *path)
+{
+   size_t i, j;
+   bool failed                    = false;
+   FILE *file                     = NULL;
+   char tmp_path[PATH_MAX_LENGTH] = {0};
+
+   if (!manifest || !path)
+      return false;
+
+   /* Written next to @path and renamed over it, so an interrupted
+    * write never leaves a truncated manifest behind. */
+   snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+   file = fopen(tmp_path, "w");
+   if (!file)
+      goto error;
+
+   fprintf(file, "%s\n", DATABASE_MANIFEST_HEADER);
+
+   for (i = 0; i < manifest->db_count; i++)
+      fprintf(file, DATABASE_MANIFEST_FMT_STAT, 'D',
+            (unsigned long long)manifest->dbs[i].size,
+            (long long)manifest->dbs[i].mtime,
+            manifest->dbs[i].path);
+
+   for (i = 0; i < manifest->count; i++)
+   {
+      const database_manifest_file_t *rec = manifest->files[i];
+
+      fprintf(file, DATABASE_MANIFEST_FMT_STAT, 'F',
+            (unsigned long long)rec->size,
+            (long long)rec->mtime, rec->path);
+
+      for (j = 0; j < rec->count; j++)
+         fprintf(file, "E\t%08x\t%d\t%s\n",
+               (unsigned)rec->entries[j].crc,
+               rec->entries[j].matched ? 1 : 0,
+               rec->entries[j].name ? rec->entries[j].name : "");
+   }
+
+   fprintf(file, "T\t%llu\t\n", (unsigned long long)manifest->count);
+
+   failed = ferror(file) != 0;
+   if (fclose(file) != 0 || failed)
+   {
+      remove(tmp_path);
+      goto error;
+   }
+
+#ifdef _WIN32
+   /* rename() does not replace existing files on Windows. */
+   remove(path);
+#endif
+   if (rename(tmp_path, path) != 0)
+   {
+      remove(tmp_path);
+      goto error;
+   }
+
+   return true;
+
+error:
+   RARCH_ERR("Failed to write scan manifest: %s\n", path);
+   return false;
+}
+
+/* Parses an unsigned number in @base and skips the
+ * tab separator following it. */
+static bool database_manifest_parse_num(char **s, unsigned base,
+      uint64_t *out)
+{
+   char *ptr      = *s;
+   uint64_t value = 0;
+   bool negative  = false;
+
+   if (*ptr == '-')
+   {
+      negative = true;
+      ptr++;
+   }
+
+   for (; *ptr && *ptr != '\t'; ptr++)
+   {
+      unsigned digit;
+
+      if (*ptr >= '0' && *ptr <= '9')
+         digit = *ptr - '0';
+      else if (*ptr >= 'a' && *ptr <= 'f')
+         digit = *ptr - 'a' + 10;
+      else if (*ptr >= 'A' && *ptr <= 'F')
+         digit = *ptr - 'A' + 10;
+      else
+         return false;
+
+      if (digit >= base)
+         return false;
+
+      value = value * base + digit;
+   }
+
+   if (*ptr != '\t')
+      return false;
+
+   *out = negative ? (uint64_t)-(int64_t)value : value;
+   *s   = ptr + 1;
+   return true;
+}
+
+static bool database_manifest_parse_line(database_manifest_t *manifest,
+      database_manifest_file_t **current, char *line)
+{
+   uint64_t a     = 0;
+   uint64_t b     = 0;
+   char type      = line[0];
+   char *ptr      = line + 1;
+
+   if (*ptr++ != '\t')
+      return false;
+
+   switch (type)
+   {
+      case 'D':
+      case 'F':
+         if (!database_manifest_parse_num(&ptr, 10, &a))
+            return false;
+         if (!database_manifest_parse_num(&ptr, 10, &b))
+            return false;
+         if (!*ptr)
+            return false;
+
+         if (type == 'D')
+            return database_manifest_add_database(manifest,
+                  ptr, a, (int64_t)b);
+
+         *current = database_manifest_file_new(ptr, a, (int64_t)b);
+         if (!database_manifest_insert(manifest, *current))
+         {
+            database_manifest_file_free(*current);
+            *current = NULL;
+            return false;
+         }
+         return true;
+      case 'E':
+         if (!*current)
+            return false;
+         if (!database_manifest_parse_num(&ptr, 16, &a))
+            return false;
+         if (!database_manifest_parse_num(&ptr, 10, &b))
+            return false;
+
+         return database_manifest_file_add_entry(*current,
+               ptr, (uint32_t)a, b != 0);
+      default:
+         break;
+   }
+
+   return false;
+}
+
+database_manifest_t *database_manifest_load(const char *path,
+      bool *failed)
+{
+   uint64_t total                    = 0;
+   bool complete                     = false;
+   char *line                        = NULL;
+   char *buf                         = NULL;
+   ssize_t len                       = 0;
+   database_manifest_file_t *current = NULL;
+   database_manifest_t *manifest     = NULL;
+
+   if (failed)
+      *failed = false;
+
+   if (!path || !path_file_exists(path))
+      return NULL;
+
+   /* Single read, then parse in place. */
+   if (!retro_read_file(path, (void**)&buf, &len) || !buf)
+      goto error;
+
+   manifest = database_manifest_new();
+   if (!manifest)
+      goto error;
+
+   line = buf;
+
+   while (line && *line)
+   {
+      char *next = strchr(line, '\n');
+
+      if (next)
+         *next++ = '\0';
+
+      if (complete)
+         goto error;
+
+      if (line == buf)
+      {
+         if (strcmp(line, DATABASE_MANIFEST_HEADER))
+            goto error;
+      }
+      else if (line[0] == 'T' && line[1] == '\t')
+      {
+         char *ptr = line + 2;
+
+         if (!database_manifest_parse_num(&ptr, 10, &total) || *ptr)
+            goto error;
+         if (total != manifest->count)
+            goto error;
+         complete = true;
+      }
+      else if (*line && !database_manifest_parse_line(manifest,
+               &current, line))
+         goto error;
+
+      line = next;
+   }
+
+   if (!complete)
+      goto error;
+
+   free(buf);
+   return manifest;
+
+error:
+   RARCH_WARN("Ignoring invalid scan manifest: %s\n", path);
+   if (failed)
+      *failed = true;
+   database_manifest_free(manifest);
+   free(buf);
+   return NULL;
+}
+
+void database_manifest_free(database_manifest_t *manifest)
+{
+   size_t i;
+
+   if (!manifest)
+      return;
+
+   for (i = 0; i < manifest->count; i++)
+      database_manifest_file_free(manifest->files[i]);
+
+   database_manifest_free_databases(manifest);
+   free(manifest->files);
+   free(manifest->buckets);
+   free(manifest);
+}
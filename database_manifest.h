@@ -0,0 +1,132 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2016 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATABASE_MANIFEST_H_
+#define DATABASE_MANIFEST_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <boolean.h>
+
+#include <string/string_list.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* One hashed item of a scanned file. Plain files have
+ * a single entry without a name, archives have one
+ * entry per file inside the archive. */
+typedef struct database_manifest_entry
+{
+   char *name;
+   uint32_t crc;
+   bool matched;
+} database_manifest_entry_t;
+
+typedef struct database_manifest_file
+{
+   char *path;
+   uint64_t size;
+   int64_t mtime;
+   database_manifest_entry_t *entries;
+   size_t count;
+   size_t cap;
+} database_manifest_file_t;
+
+typedef struct database_manifest database_manifest_t;
+
+database_manifest_file_t *database_manifest_file_new(const char *path,
+      uint64_t size, int64_t mtime);
+
+database_manifest_file_t *database_manifest_file_dup(
+      const database_manifest_file_t *file);
+
+bool database_manifest_file_add_entry(database_manifest_file_t *file,
+      const char *name, uint32_t crc, bool matched);
+
+void database_manifest_file_free(database_manifest_file_t *file);
+
+database_manifest_t *database_manifest_new(void);
+
+/**
+ * database_manifest_load:
+ * @path                : Path to the manifest file.
+ * @failed              : Set to true if @path exists but could not
+ *                        be read in full. Can be NULL.
+ *
+ * Reads a scan manifest written by database_manifest_write().
+ *
+ * Returns: new manifest, or NULL if @path does not exist or
+ * could not be read or parsed.
+ **/
+database_manifest_t *database_manifest_load(const char *path,
+      bool *failed);
+
+bool database_manifest_write(database_manifest_t *manifest,
+      const char *path);
+
+void database_manifest_free(database_manifest_t *manifest);
+
+const database_manifest_file_t *database_manifest_find(
+      const database_manifest_t *manifest, const char *path);
+
+/**
+ * database_manifest_insert:
+ * @manifest            : Manifest handle.
+ * @file                : File record, ownership moves to @manifest.
+ *
+ * Adds @file to the manifest, replacing any previous record
+ * with the same path.
+ **/
+bool database_manifest_insert(database_manifest_t *manifest,
+      database_manifest_file_t *file);
+
+/**
+ * database_manifest_merge_missing:
+ * @dst                 : Manifest to add records to.
+ * @src                 : Manifest to copy records from.
+ *
+ * Copies every record of @src whose path is not yet part of @dst.
+ * Used to keep the records of files a cancelled scan never reached.
+ **/
+void database_manifest_merge_missing(database_manifest_t *dst,
+      const database_manifest_t *src);
+
+/**
+ * database_manifest_set_databases:
+ * @manifest            : Manifest handle.
+ * @databases           : List of database paths.
+ *
+ * Records path, size and modification time of every database
+ * the match results in @manifest were computed against.
+ **/
+void database_manifest_set_databases(database_manifest_t *manifest,
+      const struct string_list *databases);
+
+/**
+ * database_manifest_databases_equal:
+ *
+ * Returns: true (1) if both manifests were built against the
+ * same, unmodified set of databases.
+ **/
+bool database_manifest_databases_equal(const database_manifest_t *a,
+      const database_manifest_t *b);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,1084 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2016 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <boolean.h>
+#include <compat/strl.h>
+#include <retro_miscellaneous.h>
+#include <file/file_path.h>
+#include <file/file_extract.h>
+#include <string/string_list.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#include "database_scan.h"
+#include "database_info.h"
+#include "database_manifest.h"
+#include "dir_list_special.h"
+#include "file_ops.h"
+#include "performance.h"
+#include "playlist.h"
+#include "verbosity.h"
+
+#define DATABASE_SCAN_COLLECTION_SIZE 99999
+
+/* The content library scanner is split into pipelined stages:
+ *
+ *  enumerate  -> walks the content directory tree
+ *  index      -> loads every database into an in-memory CRC index
+ *  hash (N)   -> reads files, lists archives and computes CRCs
+ *  write      -> looks results up in the index and pushes the
+ *                matches into the per-database playlists
+ *
+ * Enumeration and index loading run concurrently. The hashing
+ * stage is a bounded worker pool, and the bounded queues between
+ * the stages provide back-pressure. The writer is the only stage
+ * that touches the playlists, so those need no locking.
+ */
+
+struct database_scan_entry
+{
+   uint32_t crc;
+   unsigned db;
+   char *name;
+};
+
+struct database_scan_index
+{
+   struct database_scan_entry *entries;
+   size_t count;
+   size_t cap;
+   /* Open addressing table, holds entry index + 1 (0 is empty). */
+   size_t *buckets;
+   size_t mask;
+};
+
+struct database_scan_result
+{
+   database_manifest_file_t *file;
+   /* False when the file is unchanged since the last scan and
+    * its cached match results are still valid. */
+   bool lookup;
+};
+
+#ifdef HAVE_THREADS
+struct database_scan_queue
+{
+   void **items;
+   size_t cap;
+   size_t head;
+   size_t size;
+   bool closed;
+   slock_t *lock;
+   scond_t *not_empty;
+   scond_t *not_full;
+};
+#endif
+
+struct database_scan
+{
+   char content_dir[PATH_MAX_LENGTH];
+   char playlist_dir[PATH_MAX_LENGTH];
+   char manifest_path[PATH_MAX_LENGTH];
+   struct string_list *databases;
+   struct database_scan_index index;
+   content_playlist_t **playlists;
+   unsigned num_threads;
+
+   /* Manifest of the previous scan, read-only while scanning. */
+   database_manifest_t *old_manifest;
+   /* The previous manifest exists but could not be read. */
+   bool old_manifest_failed;
+   /* Manifest of this scan, only touched by the writer stage. */
+   database_manifest_t *manifest;
+   bool databases_changed;
+   bool index_loaded;
+   bool verify_archives;
+
+   database_scan_progress_cb_t cb;
+   void *userdata;
+
+   volatile bool cancel;
+   bool started;
+   database_scan_progress_t progress;
+
+#ifdef HAVE_THREADS
+   slock_t *progress_lock;
+   slock_t *index_lock;
+   scond_t *index_cond;
+   bool index_ready;
+
+   struct database_scan_queue files;
+   struct database_scan_queue results;
+
+   unsigned workers_active;
+   sthread_t *workers[DATABASE_SCAN_MAX_THREADS];
+   sthread_t *enum_thread;
+   sthread_t *index_thread;
+   sthread_t *writer_thread;
+#endif
+};
+
+typedef bool (*database_scan_emit_t)(database_scan_t *scan, void *data);
+
+#ifdef HAVE_THREADS
+#define database_scan_progress_lock(scan)   slock_lock((scan)->progress_lock)
+#define database_scan_progress_unlock(scan) slock_unlock((scan)->progress_lock)
+#else
+#define database_scan_progress_lock(scan)
+#define database_scan_progress_unlock(scan)
+#endif
+
+static void database_scan_result_free(void *data)
+{
+   struct database_scan_result *result = (struct database_scan_result*)data;
+
+   if (!result)
+      return;
+
+   database_manifest_file_free(result->file);
+   free(result);
+}
+
+/* Index stage */
+
+static bool database_scan_index_append(struct database_scan_index *index,
+      uint32_t crc, unsigned db, char *name)
+{
+   struct database_scan_entry *entry = NULL;
+
+   if (index->count == index->cap)
+   {
+      size_t new_cap = index->cap ? index->cap * 2 : 1024;
+      struct database_scan_entry *new_entries = (struct database_scan_entry*)
+         realloc(index->entries, new_cap * sizeof(*new_entries));
+
+      if (!new_entries)
+         return false;
+
+      index->entries = new_entries;
+      index->cap     = new_cap;
+   }
+
+   entry       = &index->entries[index->count++];
+   entry->crc  = crc;
+   entry->db   = db;
+   entry->name = name;
+
+   return true;
+}
+
+static bool database_scan_index_build_buckets(struct database_scan_index *index)
+{
+   size_t i;
+   size_t size = 64;
+
+   while (size < index->count * 2)
+      size <<= 1;
+
+   index->buckets = (size_t*)calloc(size, sizeof(*index->buckets));
+   if (!index->buckets)
+      return false;
+
+   index->mask = size - 1;
+
+   for (i = 0; i < index->count; i++)
+   {
+      size_t slot = index->entries[i].crc & index->mask;
+
+      while (index->buckets[slot])
+      {
+         /* Databases are loaded in order, the first one wins. */
+         if (index->entries[index->buckets[slot] - 1].crc
+               == index->entries[i].crc)
+            break;
+         slot = (slot + 1) & index->mask;
+      }
+
+      if (!index->buckets[slot])
+         index->buckets[slot] = i + 1;
+   }
+
+   return true;
+}
+
+static const struct database_scan_entry *database_scan_index_find(
+      const struct database_scan_index *index, uint32_t crc)
+{
+   size_t slot;
+
+   if (!index->buckets)
+      return NULL;
+
+   slot = crc & index->mask;
+
+   while (index->buckets[slot])
+   {
+      const struct database_scan_entry *entry =
+         &index->entries[index->buckets[slot] - 1];
+
+      if (entry->crc == crc)
+         return entry;
+      slot = (slot + 1) & index->mask;
+   }
+
+   return NULL;
+}
+
+static void database_scan_index_free(struct database_scan_index *index)
+{
+   size_t i;
+
+   for (i = 0; i < index->count; i++)
+      free(index->entries[i].name);
+
+   free(index->entries);
+   free(index->buckets);
+   memset(index, 0, sizeof(*index));
+}
+
+static void database_scan_index_load(database_scan_t *scan)
+{
+   unsigned i;
+
+   for (i = 0; i < scan->databases->size && !scan->cancel; i++)
+   {
+      database_info_t info;
+      const char *rdb_path           = scan->databases->elems[i].data;
+      database_info_cursor_t *cursor = database_info_cursor_new(
+            rdb_path, NULL, 0, 0);
+
+      if (!cursor)
+      {
+         RARCH_WARN("Could not open database: %s\n", rdb_path);
+         continue;
+      }
+
+      /* Stream the records, only CRC and name are kept. */
+      while (!scan->cancel && database_info_cursor_next(cursor, &info) == 0)
+      {
+         if (info.crc32 && info.name && database_scan_index_append(
+                  &scan->index, info.crc32, i, info.name))
+            info.name = NULL;
+
+         database_info_entry_free(&info);
+      }
+
+      database_info_cursor_free(cursor);
+   }
+
+   if (!scan->cancel)
+      database_scan_index_build_buckets(&scan->index);
+
+   RARCH_LOG("Database scan: indexed %u entries from %u databases.\n",
+         (unsigned)scan->index.count, (unsigned)scan->databases->size);
+
+   scan->index_loaded = true;
+
+   database_scan_progress_lock(scan);
+   scan->progress.index_ready = true;
+   database_scan_progress_unlock(scan);
+}
+
+/**
+ * database_scan_require_index:
+ * @scan                : Scanner handle.
+ *
+ * Waits for the index stage when it runs in the background,
+ * otherwise loads the index on first use. Rescans against
+ * unchanged databases often get by without it.
+ **/
+static void database_scan_require_index(database_scan_t *scan)
+{
+#ifdef HAVE_THREADS
+   if (scan->index_thread)
+   {
+      slock_lock(scan->index_lock);
+      while (!scan->index_ready)
+         scond_wait(scan->index_cond, scan->index_lock);
+      slock_unlock(scan->index_lock);
+      return;
+   }
+#endif
+
+   if (!scan->index_loaded)
+      database_scan_index_load(scan);
+}
+
+/* Enumeration stage */
+
+static bool database_scan_enumerate(database_scan_t *scan,
+      const char *dir, database_scan_emit_t emit)
+{
+   size_t i;
+   struct string_list *list = dir_list_new(dir, NULL, true, true);
+
+   if (!list)
+      return true;
+
+   dir_list_sort(list, true);
+
+   for (i = 0; i < list->size && !scan->cancel; i++)
+   {
+      const char *path = list->elems[i].data;
+
+      if (list->elems[i].attr.i == RARCH_DIRECTORY)
+      {
+         if (!database_scan_enumerate(scan, path, emit))
+            break;
+         continue;
+      }
+
+      database_scan_progress_lock(scan);
+      scan->progress.files_found++;
+      database_scan_progress_unlock(scan);
+
+      if (!emit(scan, strdup(path)))
+         break;
+   }
+
+   dir_list_free(list);
+
+   return !scan->cancel;
+}
+
+/* Hashing stage */
+
+static bool database_scan_hash_emit(database_scan_t *scan,
+      database_manifest_file_t *file, bool lookup,
+      database_scan_emit_t emit)
+{
+   struct database_scan_result *result = NULL;
+
+   if (!file)
+      return false;
+
+   result = (struct database_scan_result*)calloc(1, sizeof(*result));
+   if (!result)
+   {
+      database_manifest_file_free(file);
+      return false;
+   }
+
+   result->file   = file;
+   result->lookup = lookup;
+
+   return emit(scan, result);
+}
+
+static void database_scan_hash_path(database_manifest_file_t *file,
+      const char *path, const char *entry_name)
+{
+#ifdef HAVE_ZLIB
+   ssize_t len  = 0;
+   void *buf    = NULL;
+
+   if (read_file(path, &buf, &len) && len > 0)
+      database_manifest_file_add_entry(file, entry_name,
+            zlib_crc32_calculate((const uint8_t*)buf, len), false);
+
+   free(buf);
+#endif
+}
+
+#ifdef HAVE_COMPRESSION
+struct database_scan_archive
+{
+   database_scan_t *scan;
+   database_manifest_file_t *file;
+   const char *path;
+};
+
+static bool database_scan_archive_crc_cb(const char *name,
+      uint32_t crc, bool has_crc, void *userdata)
+{
+   struct database_scan_archive *archive =
+      (struct database_scan_archive*)userdata;
+
+   if (has_crc)
+      database_manifest_file_add_entry(archive->file, name, crc, false);
+   else
+   {
+      char entry_path[PATH_MAX_LENGTH] = {0};
+
+      /* No stored CRC, this entry has to be decompressed. */
+      fill_pathname_join_delim(entry_path, archive->path,
+            name, '#', sizeof(entry_path));
+      database_scan_hash_path(archive->file, entry_path, name);
+   }
+
+   return !archive->scan->cancel;
+}
+
+static void database_scan_hash_archive(database_scan_t *scan,
+      database_manifest_file_t *file, const char *path)
+{
+   size_t i;
+   struct database_scan_archive archive;
+   struct string_list *entries = NULL;
+
+   archive.scan = scan;
+   archive.file = file;
+   archive.path = path;
+
+   /* Matching against the CRCs stored in the archive
+    * avoids decompressing anything. */
+   if (!scan->verify_archives)
+   {
+      if (compressed_file_parse_crcs(path,
+               database_scan_archive_crc_cb, &archive) || file->count)
+         return;
+   }
+
+   entries = compressed_file_list_new(path, NULL);
+
+   if (!entries)
+   {
+      /* Verifying needs the entry list; the stored CRCs are
+       * still better than recording nothing. */
+      if (scan->verify_archives)
+      {
+         RARCH_WARN("Could not list %s, using its stored CRCs.\n", path);
+         compressed_file_parse_crcs(path,
+               database_scan_archive_crc_cb, &archive);
+      }
+      return;
+   }
+
+   for (i = 0; i < entries->size && !scan->cancel; i++)
+   {
+      char entry_path[PATH_MAX_LENGTH] = {0};
+
+      fill_pathname_join_delim(entry_path, path,
+            entries->elems[i].data, '#', sizeof(entry_path));
+      database_scan_hash_path(file, entry_path, entries->elems[i].data);
+   }
+
+   string_list_free(entries);
+}
+#endif
+
+static bool database_scan_hash_file(database_scan_t *scan,
+      const char *path, database_scan_emit_t emit)
+{
+   uint64_t size                         = 0;
+   int64_t mtime                         = 0;
+   database_manifest_file_t *file        = NULL;
+   const database_manifest_file_t *cached = NULL;
+
+   if (!file_get_stat(path, &size, &mtime))
+      return true;
+
+   /* Unchanged since the last scan, reuse the recorded CRCs.
+    * They only need another lookup if the databases changed. */
+   cached = database_manifest_find(scan->old_manifest, path);
+   if (cached && cached->size == size && cached->mtime == mtime)
+   {
+      database_scan_progress_lock(scan);
+      scan->progress.files_skipped++;
+      database_scan_progress_unlock(scan);
+
+      return database_scan_hash_emit(scan,
+            database_manifest_file_dup(cached),
+            scan->databases_changed, emit);
+   }
+
+   file = database_manifest_file_new(path, size, mtime);
+   if (!file)
+      return false;
+
+#ifdef HAVE_COMPRESSION
+   if (path_is_compressed_file(path))
+      database_scan_hash_archive(scan, file, path);
+   else
+#endif
+      database_scan_hash_path(file, path, NULL);
+
+   return database_scan_hash_emit(scan, file, true, emit);
+}
+
+/* Writer stage */
+
+static content_playlist_t *database_scan_get_playlist(
+      database_scan_t *scan, unsigned db)
+{
+   char db_name[PATH_MAX_LENGTH]       = {0};
+   char playlist_path[PATH_MAX_LENGTH] = {0};
+
+   if (scan->playlists[db])
+      return scan->playlists[db];
+
+   strlcpy(db_name, path_basename(scan->databases->elems[db].data),
+         sizeof(db_name));
+   path_remove_extension(db_name);
+   strlcat(db_name, ".lpl", sizeof(db_name));
+
+   fill_pathname_join(playlist_path, scan->playlist_dir,
+         db_name, sizeof(playlist_path));
+
+   scan->playlists[db] = content_playlist_init(playlist_path,
+         DATABASE_SCAN_COLLECTION_SIZE);
+
+   return scan->playlists[db];
+}
+
+static void database_scan_write_result(database_scan_t *scan,
+      struct database_scan_result *result)
+{
+   size_t i;
+   database_scan_progress_t progress;
+   size_t matches                 = 0;
+   database_manifest_file_t *file = result->file;
+
+   if (result->lookup)
+      database_scan_require_index(scan);
+
+   for (i = 0; i < file->count && result->lookup; i++)
+   {
+      char crc_str[20]                    = {0};
+      char db_name[PATH_MAX_LENGTH]       = {0};
+      char entry_path[PATH_MAX_LENGTH]    = {0};
+      content_playlist_t *playlist        = NULL;
+      database_manifest_entry_t *entry    = &file->entries[i];
+      const struct database_scan_entry *match =
+         database_scan_index_find(&scan->index, entry->crc);
+
+      entry->matched = match != NULL;
+
+      if (!match)
+         continue;
+
+      matches++;
+
+      if (entry->name)
+         fill_pathname_join_delim(entry_path, file->path,
+               entry->name, '#', sizeof(entry_path));
+      else
+         strlcpy(entry_path, file->path, sizeof(entry_path));
+
+      snprintf(crc_str, sizeof(crc_str), "%08X|crc", entry->crc);
+      strlcpy(db_name, path_basename(scan->databases->elems[match->db].data),
+            sizeof(db_name));
+      path_remove_extension(db_name);
+      strlcat(db_name, ".lpl", sizeof(db_name));
+
+      playlist = database_scan_get_playlist(scan, match->db);
+      content_playlist_push(playlist, entry_path, match->name,
+            "DETECT", "DETECT", crc_str, db_name);
+   }
+
+   database_scan_progress_lock(scan);
+   if (result->lookup)
+      scan->progress.files_scanned += file->count;
+   scan->progress.matches += matches;
+   progress = scan->progress;
+   database_scan_progress_unlock(scan);
+
+   /* The record moves on into the manifest of this scan. */
+   if (scan->manifest && database_manifest_insert(scan->manifest, file))
+      result->file = NULL;
+
+   if (scan->cb)
+      scan->cb(&progress, scan->userdata);
+}
+
+static void database_scan_flush_playlists(database_scan_t *scan)
+{
+   unsigned i;
+
+   for (i = 0; i < scan->databases->size; i++)
+   {
+      if (!scan->playlists[i])
+         continue;
+
+      content_playlist_write_file(scan->playlists[i]);
+      content_playlist_free(scan->playlists[i]);
+      scan->playlists[i] = NULL;
+   }
+}
+
+static void database_scan_finish(database_scan_t *scan)
+{
+   database_scan_progress_t progress;
+
+   database_scan_flush_playlists(scan);
+
+   /* A cancelled scan only covers part of the library. If the previous
+    * manifest could not be read, leave it on disk so the next scan
+    * retries it instead of replacing it with the partial records. */
+   if (scan->manifest && !(scan->cancel && scan->old_manifest_failed))
+   {
+      /* Keep the records of whatever a cancelled scan never got to. */
+      if (scan->cancel)
+         database_manifest_merge_missing(scan->manifest, scan->old_manifest);
+      database_manifest_write(scan->manifest, scan->manifest_path);
+   }
+
+   database_scan_progress_lock(scan);
+   scan->progress.status = scan->cancel ?
+      DATABASE_SCAN_STATUS_CANCELLED : DATABASE_SCAN_STATUS_DONE;
+   progress              = scan->progress;
+   database_scan_progress_unlock(scan);
+
+   RARCH_LOG("Database scan %s: %u files scanned, %u unchanged, %u matches.\n",
+         scan->cancel ? "cancelled" : "finished",
+         (unsigned)progress.files_scanned, (unsigned)progress.files_skipped,
+         (unsigned)progress.matches);
+
+   if (scan->cb)
+      scan->cb(&progress, scan->userdata);
+}
+
+#ifdef HAVE_THREADS
+static bool database_scan_queue_init(struct database_scan_queue *queue,
+      size_t cap)
+{
+   queue->items     = (void**)calloc(cap, sizeof(*queue->items));
+   queue->cap       = cap;
+   queue->lock      = slock_new();
+   queue->not_empty = scond_new();
+   queue->not_full  = scond_new();
+
+   return queue->items && queue->lock && queue->not_empty && queue->not_full;
+}
+
+static void database_scan_queue_deinit(struct database_scan_queue *queue,
+      void (*free_item)(void*))
+{
+   while (queue->size)
+   {
+      free_item(queue->items[queue->head]);
+      queue->head = (queue->head + 1) % queue->cap;
+      queue->size--;
+   }
+
+   if (queue->not_full)
+      scond_free(queue->not_full);
+   if (queue->not_empty)
+      scond_free(queue->not_empty);
+   if (queue->lock)
+      slock_free(queue->lock);
+   free(queue->items);
+
+   memset(queue, 0, sizeof(*queue));
+}
+
+/* Blocks while the queue is full. Returns false once the
+ * queue was closed, the caller keeps ownership of @item then. */
+static bool database_scan_queue_push(struct database_scan_queue *queue,
+      void *item)
+{
+   slock_lock(queue->lock);
+
+   while (queue->size == queue->cap && !queue->closed)
+      scond_wait(queue->not_full, queue->lock);
+
+   if (queue->closed)
+   {
+      slock_unlock(queue->lock);
+      return false;
+   }
+
+   queue->items[(queue->head + queue->size) % queue->cap] = item;
+   queue->size++;
+
+   scond_signal(queue->not_empty);
+   slock_unlock(queue->lock);
+
+   return true;
+}
+
+/* Blocks while the queue is empty. Returns NULL once the queue
+ * is both closed and drained. */
+static void *database_scan_queue_pop(struct database_scan_queue *queue)
+{
+   void *item = NULL;
+
+   slock_lock(queue->lock);
+
+   while (!queue->size && !queue->closed)
+      scond_wait(queue->not_empty, queue->lock);
+
+   if (queue->size)
+   {
+      item        = queue->items[queue->head];
+      queue->head = (queue->head + 1) % queue->cap;
+      queue->size--;
+      scond_signal(queue->not_full);
+   }
+
+   slock_unlock(queue->lock);
+
+   return item;
+}
+
+static void database_scan_queue_close(struct database_scan_queue *queue)
+{
+   slock_lock(queue->lock);
+   queue->closed = true;
+   scond_broadcast(queue->not_empty);
+   scond_broadcast(queue->not_full);
+   slock_unlock(queue->lock);
+}
+
+static bool database_scan_emit_path_threaded(database_scan_t *scan,
+      void *data)
+{
+   if (database_scan_queue_push(&scan->files, data))
+      return true;
+
+   free(data);
+   return false;
+}
+
+static bool database_scan_emit_result_threaded(database_scan_t *scan,
+      void *data)
+{
+   if (database_scan_queue_push(&scan->results, data))
+      return true;
+
+   database_scan_result_free(data);
+   return false;
+}
+
+static void database_scan_enum_thread(void *data)
+{
+   database_scan_t *scan = (database_scan_t*)data;
+
+   database_scan_enumerate(scan, scan->content_dir,
+         database_scan_emit_path_threaded);
+
+   database_scan_progress_lock(scan);
+   scan->progress.enumeration_done = true;
+   database_scan_progress_unlock(scan);
+
+   database_scan_queue_close(&scan->files);
+}
+
+static void database_scan_set_index_ready(database_scan_t *scan)
+{
+   slock_lock(scan->index_lock);
+   scan->index_ready = true;
+   scond_broadcast(scan->index_cond);
+   slock_unlock(scan->index_lock);
+}
+
+static void database_scan_index_thread(void *data)
+{
+   database_scan_t *scan = (database_scan_t*)data;
+
+   database_scan_index_load(scan);
+   database_scan_set_index_ready(scan);
+}
+
+static void database_scan_worker_thread(void *data)
+{
+   char *path            = NULL;
+   database_scan_t *scan = (database_scan_t*)data;
+
+   while ((path = (char*)database_scan_queue_pop(&scan->files)))
+   {
+      if (!scan->cancel)
+         database_scan_hash_file(scan, path,
+               database_scan_emit_result_threaded);
+      free(path);
+   }
+
+   database_scan_progress_lock(scan);
+   if (--scan->workers_active == 0)
+      database_scan_queue_close(&scan->results);
+   database_scan_progress_unlock(scan);
+}
+
+static void database_scan_writer_thread(void *data)
+{
+   struct database_scan_result *result = NULL;
+   database_scan_t *scan               = (database_scan_t*)data;
+
+   while ((result = (struct database_scan_result*)
+            database_scan_queue_pop(&scan->results)))
+   {
+      if (!scan->cancel)
+         database_scan_write_result(scan, result);
+      database_scan_result_free(result);
+   }
+
+   database_scan_finish(scan);
+}
+#else
+static bool database_scan_emit_result_sync(database_scan_t *scan,
+      void *data)
+{
+   database_scan_write_result(scan, (struct database_scan_result*)data);
+   database_scan_result_free(data);
+   return !scan->cancel;
+}
+
+static bool database_scan_emit_path_sync(database_scan_t *scan,
+      void *data)
+{
+   bool ret = database_scan_hash_file(scan, (const char*)data,
+         database_scan_emit_result_sync);
+
+   free(data);
+   return ret && !scan->cancel;
+}
+#endif
+
+database_scan_t *database_scan_new(const char *content_dir,
+      const char *database_dir, const char *playlist_dir,
+      const char *manifest_path, unsigned num_threads,
+      database_scan_progress_cb_t cb, void *userdata)
+{
+   database_scan_t *scan = NULL;
+
+   if (!content_dir || !database_dir || !playlist_dir)
+      return NULL;
+
+   scan = (database_scan_t*)calloc(1, sizeof(*scan));
+   if (!scan)
+      return NULL;
+
+   strlcpy(scan->content_dir,  content_dir,  sizeof(scan->content_dir));
+   strlcpy(scan->playlist_dir, playlist_dir, sizeof(scan->playlist_dir));
+
+   scan->databases = dir_list_new_special(database_dir,
+         DIR_LIST_PLAIN, "rdb");
+   if (!scan->databases || !scan->databases->size)
+   {
+      RARCH_ERR("No databases found in: %s\n", database_dir);
+      goto error;
+   }
+
+   /* Database order decides which playlist wins on CRC collisions. */
+   dir_list_sort(scan->databases, false);
+
+   scan->playlists = (content_playlist_t**)calloc(scan->databases->size,
+         sizeof(*scan->playlists));
+   if (!scan->playlists)
+      goto error;
+
+   scan->databases_changed = true;
+
+   if (manifest_path && *manifest_path)
+   {
+      strlcpy(scan->manifest_path, manifest_path,
+            sizeof(scan->manifest_path));
+
+      scan->manifest     = database_manifest_new();
+      scan->old_manifest = database_manifest_load(manifest_path,
+            &scan->old_manifest_failed);
+
+      if (!scan->manifest)
+         goto error;
+
+      database_manifest_set_databases(scan->manifest, scan->databases);
+      scan->databases_changed = !database_manifest_databases_equal(
+            scan->manifest, scan->old_manifest);
+
+      if (scan->old_manifest && scan->databases_changed)
+         RARCH_LOG("Database scan: databases changed since the last scan.\n");
+   }
+
+   if (!num_threads)
+      num_threads = retro_get_cpu_cores();
+   scan->num_threads = MAX(1, MIN(num_threads, DATABASE_SCAN_MAX_THREADS));
+   scan->cb          = cb;
+   scan->userdata    = userdata;
+
+#ifdef HAVE_THREADS
+   scan->progress_lock = slock_new();
+   scan->index_lock    = slock_new();
+   scan->index_cond    = scond_new();
+
+   if (!scan->progress_lock || !scan->index_lock || !scan->index_cond)
+      goto error;
+
+   if (!database_scan_queue_init(&scan->files,   DATABASE_SCAN_QUEUE_SIZE))
+      goto error;
+   if (!database_scan_queue_init(&scan->results, DATABASE_SCAN_QUEUE_SIZE))
+      goto error;
+#endif
+
+   return scan;
+
+error:
+   database_scan_free(scan);
+   return NULL;
+}
+
+void database_scan_set_verify_archives(database_scan_t *scan, bool enable)
+{
+   if (!scan || scan->started)
+      return;
+
+   scan->verify_archives = enable;
+}
+
+bool database_scan_start(database_scan_t *scan)
+{
+#ifdef HAVE_THREADS
+   unsigned i;
+#endif
+
+   if (!scan || scan->started)
+      return false;
+
+   scan->started         = true;
+   scan->progress.status = DATABASE_SCAN_STATUS_RUNNING;
+
+   RARCH_LOG("Database scan: scanning %s against %u databases.\n",
+         scan->content_dir, (unsigned)scan->databases->size);
+
+#ifdef HAVE_THREADS
+   /* Full scans load the index next to enumeration and hashing.
+    * Incremental ones leave it to the writer, on first lookup. */
+   if (scan->databases_changed)
+      scan->index_thread = sthread_create(database_scan_index_thread, scan);
+
+   scan->workers_active = scan->num_threads;
+   scan->writer_thread  = sthread_create(database_scan_writer_thread, scan);
+
+   if (!scan->writer_thread)
+      goto error;
+
+   for (i = 0; i < scan->num_threads; i++)
+   {
+      scan->workers[i] = sthread_create(database_scan_worker_thread, scan);
+      if (scan->workers[i])
+         continue;
+
+      database_scan_progress_lock(scan);
+      if (--scan->workers_active == 0)
+         database_scan_queue_close(&scan->results);
+      database_scan_progress_unlock(scan);
+   }
+
+   scan->enum_thread    = sthread_create(database_scan_enum_thread, scan);
+   if (!scan->enum_thread)
+      goto error;
+#else
+   database_scan_enumerate(scan, scan->content_dir,
+         database_scan_emit_path_sync);
+   scan->progress.enumeration_done = true;
+
+   database_scan_finish(scan);
+#endif
+
+   return true;
+
+#ifdef HAVE_THREADS
+error:
+   RARCH_ERR("Database scan: failed to start pipeline threads.\n");
+   database_scan_cancel(scan);
+   if (!scan->enum_thread)
+      database_scan_queue_close(&scan->files);
+   return false;
+#endif
+}
+
+void database_scan_cancel(database_scan_t *scan)
+{
+   if (!scan)
+      return;
+
+   scan->cancel = true;
+
+#ifdef HAVE_THREADS
+   if (scan->files.lock)
+      database_scan_queue_close(&scan->files);
+   if (scan->results.lock)
+      database_scan_queue_close(&scan->results);
+#endif
+}
+
+bool database_scan_is_finished(database_scan_t *scan)
+{
+   bool ret;
+
+   if (!scan)
+      return true;
+
+   database_scan_progress_lock(scan);
+   ret = scan->progress.status == DATABASE_SCAN_STATUS_DONE
+      || scan->progress.status == DATABASE_SCAN_STATUS_CANCELLED;
+   database_scan_progress_unlock(scan);
+
+   return ret;
+}
+
+void database_scan_get_progress(database_scan_t *scan,
+      database_scan_progress_t *progress)
+{
+   if (!scan || !progress)
+      return;
+
+   database_scan_progress_lock(scan);
+   *progress = scan->progress;
+   database_scan_progress_unlock(scan);
+}
+
+void database_scan_free(database_scan_t *scan)
+{
+#ifdef HAVE_THREADS
+   unsigned i;
+#endif
+
+   if (!scan)
+      return;
+
+#ifdef HAVE_THREADS
+   if (scan->started && !database_scan_is_finished(scan))
+      database_scan_cancel(scan);
+
+   if (scan->enum_thread)
+      sthread_join(scan->enum_thread);
+   for (i = 0; i < scan->num_threads; i++)
+      if (scan->workers[i])
+         sthread_join(scan->workers[i]);
+   if (scan->index_thread)
+      sthread_join(scan->index_thread);
+   if (scan->writer_thread)
+      sthread_join(scan->writer_thread);
+
+   database_scan_queue_deinit(&scan->files, free);
+   database_scan_queue_deinit(&scan->results, database_scan_result_free);
+
+   if (scan->index_cond)
+      scond_free(scan->index_cond);
+   if (scan->index_lock)
+      slock_free(scan->index_lock);
+   if (scan->progress_lock)
+      slock_free(scan->progress_lock);
+#endif
+
+   if (scan->playlists)
+      database_scan_flush_playlists(scan);
+   free(scan->playlists);
+
+   database_scan_index_free(&scan->index);
+   database_manifest_free(scan->manifest);
+   database_manifest_free(scan->old_manifest);
+
+   if (scan->databases)
+      string_list_free(scan->databases);
+
+   free(scan);
+}
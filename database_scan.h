@@ -0,0 +1,154 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2016 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATABASE_SCAN_H_
+#define DATABASE_SCAN_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <boolean.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef DATABASE_SCAN_MAX_THREADS
+#define DATABASE_SCAN_MAX_THREADS 8
+#endif
+
+/* Maximum number of in-flight items between two pipeline stages. */
+#ifndef DATABASE_SCAN_QUEUE_SIZE
+#define DATABASE_SCAN_QUEUE_SIZE  256
+#endif
+
+enum database_scan_status
+{
+   DATABASE_SCAN_STATUS_NONE = 0,
+   DATABASE_SCAN_STATUS_RUNNING,
+   DATABASE_SCAN_STATUS_CANCELLED,
+   DATABASE_SCAN_STATUS_DONE
+};
+
+typedef struct database_scan_progress
+{
+   enum database_scan_status status;
+   /* Files handed out by the enumeration stage so far. */
+   size_t files_found;
+   /* Files (and archive entries) that went through the lookup stage. */
+   size_t files_scanned;
+   /* Files left untouched since the previous scan. */
+   size_t files_skipped;
+   size_t matches;
+   bool enumeration_done;
+   bool index_ready;
+} database_scan_progress_t;
+
+typedef void (*database_scan_progress_cb_t)(
+      const database_scan_progress_t *progress, void *userdata);
+
+typedef struct database_scan database_scan_t;
+
+/**
+ * database_scan_new:
+ * @content_dir         : Directory to scan (recursively) for content.
+ * @database_dir        : Directory holding the .rdb databases.
+ * @playlist_dir        : Directory the per-database playlists are
+ *                        written to.
+ * @manifest_path       : Optional path to the scan manifest. Files that
+ *                        did not change (size, mtime) since the scan
+ *                        that wrote the manifest are not read again,
+ *                        and are only looked up again if the databases
+ *                        changed. NULL always does a full scan.
+ * @num_threads         : Number of hashing workers, 0 picks one per
+ *                        CPU core (capped to DATABASE_SCAN_MAX_THREADS).
+ * @cb                  : Optional progress callback. Invoked from the
+ *                        playlist writer stage, never concurrently.
+ * @userdata            : Userdata passed to @cb.
+ *
+ * Creates a new content library scanner. Nothing happens until
+ * database_scan_start() is called.
+ *
+ * Returns: new scanner handle, or NULL on error.
+ **/
+database_scan_t *database_scan_new(const char *content_dir,
+      const char *database_dir, const char *playlist_dir,
+      const char *manifest_path, unsigned num_threads,
+      database_scan_progress_cb_t cb, void *userdata);
+
+/**
+ * database_scan_set_verify_archives:
+ * @scan                : Scanner handle.
+ * @enable              : Decompress and hash archive entries.
+ *
+ * By default archive entries are matched against the CRC32 stored
+ * in the zip central directory or 7z header, and only entries
+ * without a stored CRC get decompressed. Enabling this hashes the
+ * actual data of every entry instead. Has to be set before
+ * database_scan_start().
+ **/
+void database_scan_set_verify_archives(database_scan_t *scan, bool enable);
+
+/**
+ * database_scan_start:
+ * @scan                : Scanner handle.
+ *
+ * Starts the scan pipeline. With HAVE_THREADS the stages run in the
+ * background and this returns immediately, otherwise the whole scan
+ * runs on the calling thread before returning.
+ *
+ * Returns: true (1) if the scan was started, otherwise false (0).
+ **/
+bool database_scan_start(database_scan_t *scan);
+
+/**
+ * database_scan_cancel:
+ * @scan                : Scanner handle.
+ *
+ * Requests cancellation. All stages stop at their next item;
+ * playlist entries found so far are still written out.
+ **/
+void database_scan_cancel(database_scan_t *scan);
+
+/**
+ * database_scan_is_finished:
+ * @scan                : Scanner handle.
+ *
+ * Returns: true (1) once every stage has exited (either because the
+ * scan completed or because it was cancelled).
+ **/
+bool database_scan_is_finished(database_scan_t *scan);
+
+/**
+ * database_scan_get_progress:
+ * @scan                : Scanner handle.
+ * @progress            : Filled with a snapshot of the scan progress.
+ **/
+void database_scan_get_progress(database_scan_t *scan,
+      database_scan_progress_t *progress);
+
+/**
+ * database_scan_free:
+ * @scan                : Scanner handle.
+ *
+ * Cancels the scan if it is still running, waits for every stage
+ * to exit and frees the handle.
+ **/
+void database_scan_free(database_scan_t *scan);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
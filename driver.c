@@ -261,7 +261,9 @@ static bool driver_update_system_av_info(const struct retro_system_av_info *info
    struct retro_system_av_info *av_info    = video_viewport_get_system_av_info();
 
    memcpy(av_info, info, sizeof(*av_info));
-   event_command(EVENT_CMD_REINIT);
+
+   /* New geometry and timing only concern audio and video. */
+   event_reinit(CONFIG_SUBSYSTEM_AUDIO | CONFIG_SUBSYSTEM_VIDEO);
 
    /* Cannot continue recording with different parameters.
     * Take the easiest route out and just restart the recording. */
@@ -24,6 +24,7 @@
 #include <string/stdstring.h>
 
 #include <boolean.h>
+#include <retro_file.h>
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -35,10 +36,12 @@
 #include "location/location_driver.h"
 #include "record/record_driver.h"
 #include "performance.h"
+#include "file_ops.h"
 #include "system.h"
 
 #include "libretro_private.h"
 #include "cores/internal_cores.h"
+#include "cores/libretro-benchmark/benchmark_core.h"
 #include "frontend/frontend_driver.h"
 #include "retroarch.h"
 #include "configuration.h"
@@ -68,6 +71,8 @@ static dylib_t lib_handle;
 #define SYMBOL_IMAGEVIEWER(x) core.x = libretro_imageviewer_##x
 #endif
 
+#define SYMBOL_BENCHMARK(x) core.x = libretro_benchmark_##x
+
 struct retro_core_t core;
 static bool ignore_environment_cb;
 
@@ -158,6 +163,316 @@ static dylib_t libretro_get_system_info_lib(const char *path,
    return lib;
 }
 
+/* Persistent cache of retro_system_info, so the menu does not
+ * have to load every core library just to read its name.
+ *
+ * Format, one core per line after the header, tab separated:
+ *  path, size, mtime, flags, library name, library version,
+ *  valid extensions
+ */
+#define SYSTEM_INFO_CACHE_FILE   "core_system_info.cache"
+#define SYSTEM_INFO_CACHE_HEADER "RetroArch core system info cache 1"
+
+#ifdef _WIN32
+#define SYSTEM_INFO_CACHE_FMT "%s\t%I64u\t%I64d\t%u\t%s\t%s\t%s\n"
+#else
+#define SYSTEM_INFO_CACHE_FMT "%s\t%llu\t%lld\t%u\t%s\t%s\t%s\n"
+#endif
+
+#define SYSTEM_INFO_CACHE_NUM_FIELDS 7
+
+enum system_info_cache_flags
+{
+   SYSTEM_INFO_CACHE_NEED_FULLPATH  = (1 << 0),
+   SYSTEM_INFO_CACHE_BLOCK_EXTRACT  = (1 << 1),
+   SYSTEM_INFO_CACHE_HAS_EXTENSIONS = (1 << 2),
+   /* Set if the no-game flag below was queried. */
+   SYSTEM_INFO_CACHE_HAS_NO_GAME    = (1 << 3),
+   SYSTEM_INFO_CACHE_NO_GAME        = (1 << 4)
+};
+
+typedef struct system_info_cache_entry
+{
+   char *path;
+   uint64_t size;
+   int64_t mtime;
+   unsigned flags;
+   char *library_name;
+   char *library_version;
+   char *valid_extensions;
+} system_info_cache_entry_t;
+
+static struct
+{
+   system_info_cache_entry_t *entries;
+   size_t count;
+   size_t cap;
+   bool loaded;
+   /* Entries changed since the file was last written. */
+   bool dirty;
+} system_info_cache;
+
+static void system_info_cache_entry_free(system_info_cache_entry_t *entry)
+{
+   free(entry->path);
+   free(entry->library_name);
+   free(entry->library_version);
+   free(entry->valid_extensions);
+   memset(entry, 0, sizeof(*entry));
+}
+
+static system_info_cache_entry_t *system_info_cache_find(const char *path)
+{
+   size_t i;
+
+   for (i = 0; i < system_info_cache.count; i++)
+      if (!strcmp(system_info_cache.entries[i].path, path))
+         return &system_info_cache.entries[i];
+
+   return NULL;
+}
+
+static system_info_cache_entry_t *system_info_cache_append(void)
+{
+   if (system_info_cache.count == system_info_cache.cap)
+   {
+      size_t new_cap = system_info_cache.cap ? system_info_cache.cap * 2 : 32;
+      system_info_cache_entry_t *new_ptr = (system_info_cache_entry_t*)
+         realloc(system_info_cache.entries, new_cap * sizeof(*new_ptr));
+
+      if (!new_ptr)
+         return NULL;
+
+      system_info_cache.entries = new_ptr;
+      system_info_cache.cap     = new_cap;
+   }
+
+   memset(&system_info_cache.entries[system_info_cache.count], 0,
+         sizeof(*system_info_cache.entries));
+   return &system_info_cache.entries[system_info_cache.count++];
+}
+
+static bool system_info_cache_parse_line(char *line)
+{
+   unsigned i;
+   system_info_cache_entry_t *entry                  = NULL;
+   char *fields[SYSTEM_INFO_CACHE_NUM_FIELDS]        = {NULL};
+
+   for (i = 0; i < SYSTEM_INFO_CACHE_NUM_FIELDS; i++)
+   {
+      char *tab = NULL;
+
+      if (!line)
+         return false;
+
+      tab       = strchr(line, '\t');
+      if (tab)
+         *tab++ = '\0';
+      fields[i] = line;
+      line      = tab;
+   }
+
+   if (!*fields[0] || system_info_cache_find(fields[0]))
+      return false;
+
+   if (!(entry = system_info_cache_append()))
+      return false;
+
+   entry->path            = strdup(fields[0]);
+   entry->size            = strtoull(fields[1], NULL, 10);
+   entry->mtime           = strtoll(fields[2], NULL, 10);
+   entry->flags           = strtoul(fields[3], NULL, 10);
+   entry->library_name    = strdup(fields[4]);
+   entry->library_version = strdup(fields[5]);
+   if (entry->flags & SYSTEM_INFO_CACHE_HAS_EXTENSIONS)
+      entry->valid_extensions = strdup(fields[6]);
+
+   return true;
+}
+
+static void system_info_cache_load(void)
+{
+   char *line    = NULL;
+   char *buf     = NULL;
+   ssize_t len   = 0;
+   char path[PATH_MAX_LENGTH] = {0};
+
+   if (system_info_cache.loaded)
+      return;
+
+   system_info_cache.loaded = true;
+
+   if (!config_get_cache_file_path(SYSTEM_INFO_CACHE_FILE,
+            path, sizeof(path)) || !path_file_exists(path))
+      return;
+
+   if (!retro_read_file(path, (void**)&buf, &len) || !buf)
+      return;
+
+   line = buf;
+
+   while (line && *line)
+   {
+      char *next = strchr(line, '\n');
+
+      if (next)
+         *next++ = '\0';
+
+      if (line == buf)
+      {
+         if (strcmp(line, SYSTEM_INFO_CACHE_HEADER))
+         {
+            RARCH_WARN("Ignoring invalid core system info cache: %s\n", path);
+            break;
+         }
+      }
+      else if (*line)
+         system_info_cache_parse_line(line);
+
+      line = next;
+   }
+
+   free(buf);
+}
+
+static void system_info_cache_save(void)
+{
+   size_t i;
+   FILE *file                     = NULL;
+   char path[PATH_MAX_LENGTH]     = {0};
+   char tmp_path[PATH_MAX_LENGTH] = {0};
+
+   if (!config_get_cache_file_path(SYSTEM_INFO_CACHE_FILE,
+            path, sizeof(path)))
+      return;
+
+   snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+   if (!(file = fopen(tmp_path, "w")))
+      return;
+
+   fprintf(file, "%s\n", SYSTEM_INFO_CACHE_HEADER);
+
+   for (i = 0; i < system_info_cache.count; i++)
+   {
+      const system_info_cache_entry_t *entry = &system_info_cache.entries[i];
+
+      fprintf(file, SYSTEM_INFO_CACHE_FMT, entry->path,
+            (unsigned long long)entry->size, (long long)entry->mtime,
+            entry->flags, entry->library_name, entry->library_version,
+            entry->valid_extensions ? entry->valid_extensions : "");
+   }
+
+   if (fclose(file) != 0)
+   {
+      remove(tmp_path);
+      return;
+   }
+
+#ifdef _WIN32
+   remove(path);
+#endif
+   if (rename(tmp_path, path) != 0)
+      remove(tmp_path);
+}
+
+/* Values end up in a tab separated line. */
+static bool system_info_cache_is_storable(const char *s)
+{
+   return !s || !strpbrk(s, "\t\r\n");
+}
+
+static void system_info_cache_store(const char *path,
+      uint64_t size, int64_t mtime,
+      const struct retro_system_info *info, const bool *load_no_content)
+{
+   unsigned no_game_flags           = 0;
+   system_info_cache_entry_t *entry = NULL;
+
+   if (!info->library_name || !info->library_version)
+      return;
+
+   if (!system_info_cache_is_storable(path)
+         || !system_info_cache_is_storable(info->library_name)
+         || !system_info_cache_is_storable(info->library_version)
+         || !system_info_cache_is_storable(info->valid_extensions))
+      return;
+
+   if ((entry = system_info_cache_find(path)))
+   {
+      /* Keep what is known about no-game support of the
+       * same library when this lookup did not ask for it. */
+      if (entry->size == size && entry->mtime == mtime)
+         no_game_flags = entry->flags
+            & (SYSTEM_INFO_CACHE_HAS_NO_GAME | SYSTEM_INFO_CACHE_NO_GAME);
+      system_info_cache_entry_free(entry);
+   }
+   else if (!(entry = system_info_cache_append()))
+      return;
+
+   entry->path            = strdup(path);
+   entry->size            = size;
+   entry->mtime           = mtime;
+   entry->library_name    = strdup(info->library_name);
+   entry->library_version = strdup(info->library_version);
+   entry->flags           = no_game_flags;
+
+   if (info->need_fullpath)
+      entry->flags |= SYSTEM_INFO_CACHE_NEED_FULLPATH;
+   if (info->block_extract)
+      entry->flags |= SYSTEM_INFO_CACHE_BLOCK_EXTRACT;
+   if (info->valid_extensions)
+   {
+      entry->flags |= SYSTEM_INFO_CACHE_HAS_EXTENSIONS;
+      entry->valid_extensions = strdup(info->valid_extensions);
+   }
+   if (load_no_content)
+   {
+      entry->flags &= ~SYSTEM_INFO_CACHE_NO_GAME;
+      entry->flags |= SYSTEM_INFO_CACHE_HAS_NO_GAME;
+      if (*load_no_content)
+         entry->flags |= SYSTEM_INFO_CACHE_NO_GAME;
+   }
+
+   /* Written once by libretro_free_system_info_cache(), not
+    * once per core while a cold cache fills up. */
+   system_info_cache.dirty = true;
+}
+
+/**
+ * libretro_save_system_info_cache:
+ *
+ * Writes the core system info cache out if entries changed
+ * since it was last written.
+ **/
+void libretro_save_system_info_cache(void)
+{
+   if (!system_info_cache.dirty)
+      return;
+
+   system_info_cache_save();
+   system_info_cache.dirty = false;
+}
+
+/**
+ * libretro_free_system_info_cache:
+ *
+ * Writes out pending changes to the core system info cache and
+ * drops the in-memory copy, it gets read again on next use.
+ **/
+void libretro_free_system_info_cache(void)
+{
+   size_t i;
+
+   libretro_save_system_info_cache();
+
+   for (i = 0; i < system_info_cache.count; i++)
+      system_info_cache_entry_free(&system_info_cache.entries[i]);
+
+   free(system_info_cache.entries);
+   memset(&system_info_cache, 0, sizeof(system_info_cache));
+}
+
 /**
  * libretro_get_system_info:
  * @path                         : Path to libretro library.
@@ -168,14 +483,48 @@ static dylib_t libretro_get_system_info_lib(const char *path,
  * Gets system info from an arbitrary lib.
  * The struct returned must be freed as strings are allocated dynamically.
  *
+ * Answered from the core system info cache if the library did not
+ * change (size, mtime) since it was last loaded, otherwise the
+ * library gets loaded and the cache updated.
+ *
  * Returns: true (1) if successful, otherwise false (0).
  **/
 bool libretro_get_system_info(const char *path,
       struct retro_system_info *info, bool *load_no_content)
 {
+   uint64_t size                       = 0;
+   int64_t mtime                       = 0;
+   dylib_t lib                         = NULL;
+   system_info_cache_entry_t *entry    = NULL;
    struct retro_system_info dummy_info = {0};
-   dylib_t lib = libretro_get_system_info_lib(path,
-         &dummy_info, load_no_content);
+   bool has_stat = file_get_stat(path, &size, &mtime);
+
+   system_info_cache_load();
+
+   if (has_stat)
+      entry = system_info_cache_find(path);
+
+   if (entry && entry->size == size && entry->mtime == mtime
+         && (!load_no_content
+            || (entry->flags & SYSTEM_INFO_CACHE_HAS_NO_GAME)))
+   {
+      memset(info, 0, sizeof(*info));
+      info->library_name    = strdup(entry->library_name);
+      info->library_version = strdup(entry->library_version);
+      if (entry->valid_extensions)
+         info->valid_extensions = strdup(entry->valid_extensions);
+      info->need_fullpath   =
+         (entry->flags & SYSTEM_INFO_CACHE_NEED_FULLPATH) ? true : false;
+      info->block_extract   =
+         (entry->flags & SYSTEM_INFO_CACHE_BLOCK_EXTRACT) ? true : false;
+
+      if (load_no_content)
+         *load_no_content   =
+            (entry->flags & SYSTEM_INFO_CACHE_NO_GAME) ? true : false;
+      return true;
+   }
+
+   lib = libretro_get_system_info_lib(path, &dummy_info, load_no_content);
    if (!lib)
       return false;
 
@@ -185,6 +534,10 @@ bool libretro_get_system_info(const char *path,
    if (dummy_info.valid_extensions)
       info->valid_extensions = strdup(dummy_info.valid_extensions);
    dylib_close(lib);
+
+   if (has_stat)
+      system_info_cache_store(path, size, mtime, info, load_no_content);
+
    return true;
 }
 
@@ -250,6 +603,41 @@ libretro_find_controller_description(
    return NULL;
 }
 
+/**
+ * load_benchmark_config:
+ *
+ * Hands the benchmark_* settings to the synthetic core.
+ **/
+static void load_benchmark_config(void)
+{
+   struct benchmark_core_config config = {0};
+   settings_t *settings                = config_get_ptr();
+   const char *fmt                     = settings->benchmark.pixel_format;
+
+   config.width          = settings->benchmark.width;
+   config.height         = settings->benchmark.height;
+   config.audio_batch    = settings->benchmark.audio_batch;
+   config.serialize_size = settings->benchmark.serialize_size;
+   config.dirty_ratio    = settings->benchmark.dirty_ratio;
+   config.sram_size      = settings->benchmark.sram_size;
+   strlcpy(config.memory_map, settings->benchmark.memory_map,
+         sizeof(config.memory_map));
+
+   if (!strcasecmp(fmt, "0RGB1555"))
+      config.pixel_format = RETRO_PIXEL_FORMAT_0RGB1555;
+   else if (!strcasecmp(fmt, "RGB565"))
+      config.pixel_format = RETRO_PIXEL_FORMAT_RGB565;
+   else
+   {
+      if (strcasecmp(fmt, "XRGB8888"))
+         RARCH_WARN("Unknown benchmark_pixel_format \"%s\", using XRGB8888.\n",
+               fmt);
+      config.pixel_format = RETRO_PIXEL_FORMAT_XRGB8888;
+   }
+
+   libretro_benchmark_set_config(&config);
+}
+
 /**
  * load_symbols:
  * @type                        : Type of core to be loaded.
@@ -446,6 +834,43 @@ static void load_symbols(enum rarch_core_type type)
          SYMBOL_IMAGEVIEWER(retro_get_memory_size);
 #endif
          break;
+      case CORE_TYPE_BENCHMARK:
+         load_benchmark_config();
+
+         SYMBOL_BENCHMARK(retro_init);
+         SYMBOL_BENCHMARK(retro_deinit);
+
+         SYMBOL_BENCHMARK(retro_api_version);
+         SYMBOL_BENCHMARK(retro_get_system_info);
+         SYMBOL_BENCHMARK(retro_get_system_av_info);
+
+         SYMBOL_BENCHMARK(retro_set_environment);
+         SYMBOL_BENCHMARK(retro_set_video_refresh);
+         SYMBOL_BENCHMARK(retro_set_audio_sample);
+         SYMBOL_BENCHMARK(retro_set_audio_sample_batch);
+         SYMBOL_BENCHMARK(retro_set_input_poll);
+         SYMBOL_BENCHMARK(retro_set_input_state);
+
+         SYMBOL_BENCHMARK(retro_set_controller_port_device);
+
+         SYMBOL_BENCHMARK(retro_reset);
+         SYMBOL_BENCHMARK(retro_run);
+
+         SYMBOL_BENCHMARK(retro_serialize_size);
+         SYMBOL_BENCHMARK(retro_serialize);
+         SYMBOL_BENCHMARK(retro_unserialize);
+
+         SYMBOL_BENCHMARK(retro_cheat_reset);
+         SYMBOL_BENCHMARK(retro_cheat_set);
+
+         SYMBOL_BENCHMARK(retro_load_game);
+         SYMBOL_BENCHMARK(retro_load_game_special);
+
+         SYMBOL_BENCHMARK(retro_unload_game);
+         SYMBOL_BENCHMARK(retro_get_region);
+         SYMBOL_BENCHMARK(retro_get_memory_data);
+         SYMBOL_BENCHMARK(retro_get_memory_size);
+         break;
    }
 }
 
@@ -31,7 +31,9 @@ enum rarch_core_type
 #ifdef HAVE_FFMPEG
    CORE_TYPE_FFMPEG,
 #endif
-   CORE_TYPE_IMAGEVIEWER
+   CORE_TYPE_IMAGEVIEWER,
+   /* Synthetic core for benchmarking the frontend. */
+   CORE_TYPE_BENCHMARK
 };
 
 #ifdef __cplusplus
@@ -81,6 +83,22 @@ bool libretro_get_system_info(const char *path,
  * Frees system information.
  **/
 void libretro_free_system_info(struct retro_system_info *info);
+
+/**
+ * libretro_save_system_info_cache:
+ *
+ * Writes the core system info cache out if entries changed
+ * since it was last written.
+ **/
+void libretro_save_system_info_cache(void);
+
+/**
+ * libretro_free_system_info_cache:
+ *
+ * Writes out pending changes to the core system info cache and
+ * drops the in-memory copy.
+ **/
+void libretro_free_system_info_cache(void);
 #endif
 
 /**
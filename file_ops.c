@@ -22,6 +22,7 @@
 #include <string.h>
 #include <time.h>
 #include <errno.h>
+#include <sys/stat.h>
 
 #include <boolean.h>
 
@@ -307,7 +308,9 @@ static struct string_list *compressed_7zip_file_list_new(
          res      = utf16_to_char_string(temp, infile, sizeof(infile)) ? SZ_OK : SZ_ERROR_FAIL;
          file_ext = path_get_extension(infile);
 
-         if (string_list_find_elem_prefix(ext_list, ".", file_ext))
+         /* Without an extension list every entry is kept. */
+         if (!ext_list
+               || string_list_find_elem_prefix(ext_list, ".", file_ext))
             supported_by_core = true;
 
          /*
@@ -346,6 +349,84 @@ end:
    string_list_free(ext_list);
    return list;
 }
+
+/* Reports the CRC32 the 7z header stores for every file,
+ * without extracting anything. */
+static bool compressed_7zip_file_parse_crcs(const char *path,
+      compressed_file_crc_cb_t cb, void *userdata)
+{
+   CFileInStream archiveStream;
+   CLookToRead lookStream;
+   CSzArEx db;
+   ISzAlloc allocImp;
+   ISzAlloc allocTempImp;
+   uint16_t *temp               = NULL;
+   size_t temp_size             = 0;
+   bool ret                     = false;
+
+   allocImp.Alloc     = SzAlloc;
+   allocImp.Free      = SzFree;
+   allocTempImp.Alloc = SzAllocTemp;
+   allocTempImp.Free  = SzFreeTemp;
+
+   if (InFile_Open(&archiveStream.file, path))
+      return false;
+
+   FileInStream_CreateVTable(&archiveStream);
+   LookToRead_CreateVTable(&lookStream, False);
+   lookStream.realStream = &archiveStream.s;
+   LookToRead_Init(&lookStream);
+   CrcGenerateTable();
+   SzArEx_Init(&db);
+
+   if (SzArEx_Open(&db, &lookStream.s, &allocImp, &allocTempImp) == SZ_OK)
+   {
+      uint32_t i;
+
+      ret = true;
+
+      for (i = 0; i < db.db.NumFiles; i++)
+      {
+         char infile[PATH_MAX_LENGTH] = {0};
+         size_t                   len = 0;
+         const CSzFileItem         *f = db.db.Files + i;
+
+         if (f->IsDir)
+            continue;
+
+         len = SzArEx_GetFileNameUtf16(&db, i, NULL);
+
+         if (len > temp_size)
+         {
+            free(temp);
+            temp_size = len;
+            temp      = (uint16_t *)malloc(temp_size * sizeof(temp[0]));
+
+            if (!temp)
+            {
+               ret = false;
+               break;
+            }
+         }
+
+         SzArEx_GetFileNameUtf16(&db, i, temp);
+         if (!utf16_to_char_string(temp, infile, sizeof(infile)))
+         {
+            ret = false;
+            break;
+         }
+
+         if (!cb(infile, f->Crc, f->CrcDefined != 0, userdata))
+            break;
+      }
+   }
+
+   SzArEx_Free(&db, &allocImp);
+   free(temp);
+   File_Close(&archiveStream.file);
+
+   return ret;
+}
 #endif
 
 #ifdef HAVE_ZLIB
@@ -478,6 +559,32 @@ error:
    unzClose(zipfile);
    return -1;
 }
+
+struct zip_crc_userdata
+{
+   compressed_file_crc_cb_t cb;
+   void *userdata;
+};
+
+static int zip_parse_crc_cb(const char *name, const char *valid_exts,
+      const uint8_t *cdata, unsigned cmode, uint32_t csize, uint32_t size,
+      uint32_t crc32, void *userdata)
+{
+   struct zip_crc_userdata *data = (struct zip_crc_userdata*)userdata;
+   size_t len                    = strlen(name);
+
+   (void)valid_exts;
+   (void)cdata;
+   (void)cmode;
+   (void)csize;
+
+   /* Skip directories. */
+   if (len && (name[len - 1] == '/' || name[len - 1] == '\\'))
+      return 1;
+
+   /* Only empty files legitimately have a zero CRC. */
+   return data->cb(name, crc32, crc32 != 0 || size == 0, data->userdata);
+}
 #endif
 
 #endif
@@ -579,6 +686,43 @@ int read_file(const char *path, void **buf, ssize_t *length)
    return retro_read_file(path, buf, length);
 }
 
+/**
+ * compressed_file_parse_crcs:
+ * @path             : path to the archive.
+ * @cb               : called for every file inside the archive.
+ * @userdata         : passed to @cb.
+ *
+ * Reports the CRC32 that zip (central directory) and 7z (header)
+ * archives already store for their files. Nothing gets decompressed.
+ *
+ * Returns: true (1) if the archive could be parsed, otherwise false (0).
+ */
+bool compressed_file_parse_crcs(const char *path,
+      compressed_file_crc_cb_t cb, void *userdata)
+{
+#ifdef HAVE_COMPRESSION
+#if defined(HAVE_7ZIP) || defined(HAVE_ZLIB)
+   const char* file_ext = path_get_extension(path);
+#endif
+#ifdef HAVE_7ZIP
+   if (strcasecmp(file_ext,"7z") == 0)
+      return compressed_7zip_file_parse_crcs(path, cb, userdata);
+#endif
+#ifdef HAVE_ZLIB
+   if (strcasecmp(file_ext,"zip") == 0)
+   {
+      struct zip_crc_userdata data;
+
+      data.cb       = cb;
+      data.userdata = userdata;
+
+      return zlib_parse_file(path, NULL, zip_parse_crc_cb, &data) != 0;
+   }
+#endif
+#endif
+   return false;
+}
+
 struct string_list *compressed_file_list_new(const char *path,
       const char* ext)
 {
@@ -597,3 +741,30 @@ struct string_list *compressed_file_list_new(const char *path,
 #endif
    return NULL;
 }
+
+/**
+ * file_get_stat:
+ * @path             : path to file.
+ * @size             : optional, set to the size of the file in bytes.
+ * @mtime            : optional, set to the last modification time
+ *                     of the file (seconds since the epoch).
+ *
+ * Gets size and modification time of a file or directory
+ * with a single stat call.
+ *
+ * Returns: true (1) if @path exists, false (0) otherwise.
+ */
+bool file_get_stat(const char *path, uint64_t *size, int64_t *mtime)
+{
+   struct stat buf;
+
+   if (!path || !*path || stat(path, &buf) != 0)
+      return false;
+
+   if (size)
+      *size  = (uint64_t)buf.st_size;
+   if (mtime)
+      *mtime = (int64_t)buf.st_mtime;
+
+   return true;
+}
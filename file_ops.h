@@ -36,6 +36,39 @@ int read_compressed_file(const char * path, void **buf,
       const char* optional_filename, ssize_t *length);
 #endif
 
+/* Callback for compressed_file_parse_crcs(). @has_crc is false
+ * when the archive does not store a CRC for @name.
+ * Return false to stop parsing. */
+typedef bool (*compressed_file_crc_cb_t)(const char *name,
+      uint32_t crc, bool has_crc, void *userdata);
+
+/**
+ * compressed_file_parse_crcs:
+ * @path             : path to the archive.
+ * @cb               : called for every file inside the archive.
+ * @userdata         : passed to @cb.
+ *
+ * Reports the CRC32 that zip (central directory) and 7z (header)
+ * archives already store for their files. Nothing gets decompressed.
+ *
+ * Returns: true (1) if the archive could be parsed, otherwise false (0).
+ */
+bool compressed_file_parse_crcs(const char *path,
+      compressed_file_crc_cb_t cb, void *userdata);
+
+/**
+ * compressed_file_list_new:
+ * @path             : path to the archive.
+ * @ext              : optional '|'-separated list of extensions to keep,
+ *                     NULL keeps every entry.
+ *
+ * Lists the files inside a zip or 7z archive.
+ *
+ * Returns: new string list of archive entries, or NULL on error.
+ */
+struct string_list *compressed_file_list_new(const char *path,
+      const char* ext);
+
 /**
  * read_file:
  * @path             : path to file.
@@ -62,6 +95,20 @@ int read_file(const char *path, void **buf, ssize_t *length);
  */
 bool write_file(const char *path, const void *buf, ssize_t size);
 
+/**
+ * file_get_stat:
+ * @path             : path to file.
+ * @size             : optional, set to the size of the file in bytes.
+ * @mtime            : optional, set to the last modification time
+ *                     of the file (seconds since the epoch).
+ *
+ * Gets size and modification time of a file or directory
+ * with a single stat call.
+ *
+ * Returns: true (1) if @path exists, false (0) otherwise.
+ */
+bool file_get_stat(const char *path, uint64_t *size, int64_t *mtime);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,254 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2016 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#include "hw_counters.h"
+#include "perf_trace.h"
+#include "verbosity.h"
+
+#if defined(__linux__) && defined(__NR_perf_event_open)
+#define HAVE_PERF_EVENT_OPEN
+#endif
+
+struct hw_counter
+{
+   const char *name;
+   int fd;
+   /* Counting a software stand-in for the hardware event. */
+   bool software;
+
+   uint64_t start;
+   uint64_t frame;
+   uint64_t total;
+};
+
+bool hw_counters_active;
+
+static struct hw_counter hw_counters[HW_COUNTER_LAST] = {
+   { "cycles",           -1, false, 0, 0, 0 },
+   { "instructions",     -1, false, 0, 0, 0 },
+   { "cache misses",     -1, false, 0, 0, 0 },
+   { "branch misses",    -1, false, 0, 0, 0 },
+   { "page faults",      -1, false, 0, 0, 0 },
+   { "context switches", -1, false, 0, 0, 0 },
+};
+
+static uint64_t hw_counters_frames;
+
+#ifdef HAVE_PERF_EVENT_OPEN
+static int hw_counter_open(uint32_t type, uint64_t config)
+{
+   struct perf_event_attr attr;
+
+   memset(&attr, 0, sizeof(attr));
+   attr.size           = sizeof(attr);
+   attr.type           = type;
+   attr.config         = config;
+   attr.exclude_kernel = 1;
+   attr.exclude_hv     = 1;
+
+   /* This thread only, on whatever CPU it runs. */
+   return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static uint64_t hw_counter_read(const struct hw_counter *counter)
+{
+   uint64_t value = 0;
+
+   if (read(counter->fd, &value, sizeof(value)) != sizeof(value))
+      return counter->start;
+   return value;
+}
+#endif
+
+bool hw_counters_init(void)
+{
+#ifdef HAVE_PERF_EVENT_OPEN
+   static const struct
+   {
+      uint32_t type;
+      uint64_t config;
+   } events[HW_COUNTER_LAST] = {
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+      { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS },
+      { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES },
+   };
+   unsigned i;
+   unsigned opened = 0;
+
+   if (hw_counters_active)
+      return true;
+
+   for (i = 0; i < HW_COUNTER_LAST; i++)
+   {
+      struct hw_counter *counter = &hw_counters[i];
+
+      counter->fd       = hw_counter_open(events[i].type, events[i].config);
+      counter->software = false;
+
+      /* No PMU (VMs, some ARM boards) or perf_event_paranoid
+       * forbids it. Task clock in ns stands in for cycles. */
+      if (counter->fd < 0 && i == HW_COUNTER_CYCLES)
+      {
+         counter->fd       = hw_counter_open(PERF_TYPE_SOFTWARE,
+               PERF_COUNT_SW_TASK_CLOCK);
+         counter->software = counter->fd >= 0;
+      }
+
+      if (counter->fd < 0)
+      {
+         RARCH_WARN("[PERF]: %s counter unavailable.\n", counter->name);
+         continue;
+      }
+
+      counter->start = hw_counter_read(counter);
+      opened++;
+   }
+
+   if (!opened)
+      return false;
+
+   hw_counters_reset();
+   hw_counters_active = true;
+   return true;
+#else
+   return false;
+#endif
+}
+
+void hw_counters_deinit(void)
+{
+#ifdef HAVE_PERF_EVENT_OPEN
+   unsigned i;
+#endif
+
+   /* The final perf report runs after this, with the
+    * counters closed, so log what is left now. */
+   hw_counters_log();
+
+#ifdef HAVE_PERF_EVENT_OPEN
+   for (i = 0; i < HW_COUNTER_LAST; i++)
+   {
+      if (hw_counters[i].fd >= 0)
+         close(hw_counters[i].fd);
+      hw_counters[i].fd = -1;
+   }
+#endif
+
+   hw_counters_active = false;
+}
+
+void hw_counters_begin(void)
+{
+#ifdef HAVE_PERF_EVENT_OPEN
+   unsigned i;
+
+   for (i = 0; i < HW_COUNTER_LAST; i++)
+   {
+      if (hw_counters[i].fd >= 0)
+         hw_counters[i].start = hw_counter_read(&hw_counters[i]);
+   }
+#endif
+}
+
+void hw_counters_end(void)
+{
+#ifdef HAVE_PERF_EVENT_OPEN
+   unsigned i;
+
+   for (i = 0; i < HW_COUNTER_LAST; i++)
+   {
+      struct hw_counter *counter = &hw_counters[i];
+
+      if (counter->fd < 0)
+         continue;
+
+      counter->frame  = hw_counter_read(counter) - counter->start;
+      counter->total += counter->frame;
+
+      if (perf_trace_active)
+         perf_trace_counter(counter->name, counter->frame);
+   }
+
+   hw_counters_frames++;
+#endif
+}
+
+bool hw_counters_get_frame(enum hw_counter_id id, uint64_t *value)
+{
+   if (id >= HW_COUNTER_LAST || hw_counters[id].fd < 0)
+      return false;
+
+   *value = hw_counters[id].frame;
+   return true;
+}
+
+void hw_counters_log(void)
+{
+   unsigned i;
+   const struct hw_counter *cycles       = &hw_counters[HW_COUNTER_CYCLES];
+   const struct hw_counter *instructions = &hw_counters[HW_COUNTER_INSTRUCTIONS];
+
+   if (!hw_counters_active || !hw_counters_frames)
+      return;
+
+   RARCH_LOG("[PERF]: retro_run over %llu frames:\n",
+         (unsigned long long)hw_counters_frames);
+
+   for (i = 0; i < HW_COUNTER_LAST; i++)
+   {
+      const struct hw_counter *counter = &hw_counters[i];
+
+      if (counter->fd < 0)
+         continue;
+
+      RARCH_LOG("[PERF]:   %s%s: %llu total, %llu per frame, %llu last frame.\n",
+            counter->name,
+            counter->software ? " (task clock ns)" : "",
+            (unsigned long long)counter->total,
+            (unsigned long long)(counter->total / hw_counters_frames),
+            (unsigned long long)counter->frame);
+   }
+
+   if (cycles->fd >= 0 && !cycles->software && instructions->fd >= 0
+         && cycles->total)
+      RARCH_LOG("[PERF]:   instructions per cycle: %.2f.\n",
+            (double)instructions->total / (double)cycles->total);
+}
+
+void hw_counters_reset(void)
+{
+   unsigned i;
+
+   for (i = 0; i < HW_COUNTER_LAST; i++)
+   {
+      hw_counters[i].frame = 0;
+      hw_counters[i].total = 0;
+   }
+
+   hw_counters_frames = 0;
+}
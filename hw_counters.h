@@ -0,0 +1,101 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2016 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __RARCH_HW_COUNTERS_H
+#define __RARCH_HW_COUNTERS_H
+
+#include <stdint.h>
+
+#include <boolean.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum hw_counter_id
+{
+   HW_COUNTER_CYCLES = 0,
+   HW_COUNTER_INSTRUCTIONS,
+   HW_COUNTER_CACHE_MISSES,
+   HW_COUNTER_BRANCH_MISSES,
+   HW_COUNTER_PAGE_FAULTS,
+   HW_COUNTER_CONTEXT_SWITCHES,
+   HW_COUNTER_LAST
+};
+
+/* Non-zero while counters are open. Checked before calling
+ * into hw_counters_begin()/hw_counters_end(). */
+extern bool hw_counters_active;
+
+/**
+ * hw_counters_init:
+ *
+ * Opens one perf_event_open() counter per enum hw_counter_id for
+ * the calling thread. Hardware events the CPU or the kernel
+ * don't provide fall back to a software event where one makes
+ * sense (task clock for cycles), or are left out.
+ *
+ * Returns: true (1) if at least one counter could be opened,
+ * otherwise false (0). Always false outside of Linux.
+ **/
+bool hw_counters_init(void);
+
+/**
+ * hw_counters_deinit:
+ *
+ * Logs the counts gathered since the last reset, then closes
+ * the counters.
+ **/
+void hw_counters_deinit(void);
+
+/**
+ * hw_counters_begin:
+ *
+ * Takes a snapshot of every counter before a frame of the core.
+ **/
+void hw_counters_begin(void);
+
+/**
+ * hw_counters_end:
+ *
+ * Accounts the counter deltas since hw_counters_begin() to the
+ * last frame and to the running totals.
+ **/
+void hw_counters_end(void);
+
+/**
+ * hw_counters_get_frame:
+ * @id                  : Counter to read.
+ * @value               : Out: value during the last frame.
+ *
+ * Returns: true (1) if @id is available, otherwise false (0).
+ **/
+bool hw_counters_get_frame(enum hw_counter_id id, uint64_t *value);
+
+/**
+ * hw_counters_log:
+ *
+ * Logs totals and per-frame averages since the last
+ * hw_counters_reset().
+ **/
+void hw_counters_log(void);
+
+void hw_counters_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
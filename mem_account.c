@@ -0,0 +1,219 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2016 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#include "mem_account.h"
+#include "verbosity.h"
+
+/* Tagged allocations are prefixed with their size and tag.
+ * The header is padded so the returned memory keeps malloc's
+ * alignment. */
+typedef union mem_tag_header
+{
+   struct
+   {
+      size_t size;
+      unsigned tag;
+   } info;
+   long double align_ld;
+   void *align_ptr;
+   long long align_ll;
+} mem_tag_header_t;
+
+static const char *mem_tag_names[MEM_TAG_LAST] = {
+   "rewind",
+   "content",
+   "playlists",
+   "database",
+   "core info",
+   "cheevos",
+};
+
+static struct mem_account_stats mem_account_stats[MEM_TAG_LAST];
+#ifdef HAVE_THREADS
+static slock_t *mem_account_lock;
+#endif
+
+void mem_account_init(void)
+{
+#ifdef HAVE_THREADS
+   if (!mem_account_lock)
+      mem_account_lock = slock_new();
+#endif
+}
+
+static void mem_account_update(enum mem_tag tag, size_t add, size_t sub)
+{
+   struct mem_account_stats *stats = NULL;
+
+   if ((unsigned)tag >= MEM_TAG_LAST)
+      return;
+
+   stats = &mem_account_stats[tag];
+
+#ifdef HAVE_THREADS
+   if (mem_account_lock)
+      slock_lock(mem_account_lock);
+#endif
+
+   if (add)
+   {
+      stats->current += add;
+      stats->count++;
+      if (stats->current > stats->peak)
+         stats->peak = stats->current;
+   }
+
+   if (sub)
+   {
+      stats->current -= sub > stats->current ? stats->current : sub;
+      if (stats->count)
+         stats->count--;
+   }
+
+#ifdef HAVE_THREADS
+   if (mem_account_lock)
+      slock_unlock(mem_account_lock);
+#endif
+}
+
+void mem_account_add(enum mem_tag tag, size_t size)
+{
+   if (size)
+      mem_account_update(tag, size, 0);
+}
+
+void mem_account_sub(enum mem_tag tag, size_t size)
+{
+   if (size)
+      mem_account_update(tag, 0, size);
+}
+
+void *mem_tag_malloc(enum mem_tag tag, size_t size)
+{
+   mem_tag_header_t *header = (mem_tag_header_t*)
+      malloc(sizeof(*header) + size);
+
+   if (!header)
+      return NULL;
+
+   header->info.size = size;
+   header->info.tag  = tag;
+   mem_account_update(tag, size ? size : 1, 0);
+
+   return header + 1;
+}
+
+void *mem_tag_calloc(enum mem_tag tag, size_t num, size_t size)
+{
+   void *ptr = NULL;
+
+   if (size && num > (size_t)-1 / size)
+      return NULL;
+
+   ptr = mem_tag_malloc(tag, num * size);
+   if (ptr)
+      memset(ptr, 0, num * size);
+   return ptr;
+}
+
+void *mem_tag_realloc(enum mem_tag tag, void *ptr, size_t size)
+{
+   size_t old_size;
+   mem_tag_header_t *header = NULL;
+
+   if (!ptr)
+      return mem_tag_malloc(tag, size);
+
+   header   = (mem_tag_header_t*)ptr - 1;
+   old_size = header->info.size;
+   header   = (mem_tag_header_t*)realloc(header, sizeof(*header) + size);
+
+   if (!header)
+      return NULL;
+
+   header->info.size = size;
+   mem_account_update((enum mem_tag)header->info.tag,
+         size ? size : 1, old_size ? old_size : 1);
+
+   return header + 1;
+}
+
+char *mem_tag_strdup(enum mem_tag tag, const char *s)
+{
+   size_t len = strlen(s) + 1;
+   char *ret  = (char*)mem_tag_malloc(tag, len);
+
+   if (ret)
+      memcpy(ret, s, len);
+   return ret;
+}
+
+void mem_tag_free(void *ptr)
+{
+   mem_tag_header_t *header = NULL;
+
+   if (!ptr)
+      return;
+
+   header = (mem_tag_header_t*)ptr - 1;
+   mem_account_update((enum mem_tag)header->info.tag, 0,
+         header->info.size ? header->info.size : 1);
+   free(header);
+}
+
+void mem_account_get(enum mem_tag tag, struct mem_account_stats *stats)
+{
+   if ((unsigned)tag >= MEM_TAG_LAST)
+   {
+      memset(stats, 0, sizeof(*stats));
+      return;
+   }
+
+#ifdef HAVE_THREADS
+   if (mem_account_lock)
+      slock_lock(mem_account_lock);
+#endif
+   *stats = mem_account_stats[tag];
+#ifdef HAVE_THREADS
+   if (mem_account_lock)
+      slock_unlock(mem_account_lock);
+#endif
+}
+
+void mem_account_log(void)
+{
+   unsigned i;
+
+   RARCH_LOG("[MEM]: Memory use per subsystem:\n");
+
+   for (i = 0; i < MEM_TAG_LAST; i++)
+   {
+      struct mem_account_stats stats;
+
+      mem_account_get((enum mem_tag)i, &stats);
+
+      RARCH_LOG("[MEM]:   %-10s %10.1f KiB current, %10.1f KiB peak, %u allocations.\n",
+            mem_tag_names[i],
+            stats.current / 1024.0, stats.peak / 1024.0,
+            (unsigned)stats.count);
+   }
+}
@@ -0,0 +1,92 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2016 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __RARCH_MEM_ACCOUNT_H
+#define __RARCH_MEM_ACCOUNT_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum mem_tag
+{
+   MEM_TAG_REWIND = 0,
+   MEM_TAG_CONTENT,
+   MEM_TAG_PLAYLIST,
+   MEM_TAG_DATABASE,
+   MEM_TAG_CORE_INFO,
+   MEM_TAG_CHEEVOS,
+   MEM_TAG_LAST
+};
+
+struct mem_account_stats
+{
+   /* Bytes currently held. */
+   size_t current;
+   /* Most bytes ever held at once. */
+   size_t peak;
+   /* Allocations currently held. */
+   size_t count;
+};
+
+/**
+ * mem_account_init:
+ *
+ * Sets up the lock guarding the statistics. Has to be called
+ * before a second thread allocates through this module.
+ **/
+void mem_account_init(void);
+
+/**
+ * mem_account_add:
+ * @tag                 : Subsystem owning the memory.
+ * @size                : Size of the allocation.
+ *
+ * Accounts an allocation made outside of this module, e.g. by
+ * libretro-common, to @tag. Has to be paired with a
+ * mem_account_sub() of the same size once it is freed.
+ **/
+void mem_account_add(enum mem_tag tag, size_t size);
+
+void mem_account_sub(enum mem_tag tag, size_t size);
+
+/* Allocators accounting to @tag. Memory they return must only
+ * be resized with mem_tag_realloc() and freed with mem_tag_free(). */
+void *mem_tag_malloc(enum mem_tag tag, size_t size);
+
+void *mem_tag_calloc(enum mem_tag tag, size_t num, size_t size);
+
+void *mem_tag_realloc(enum mem_tag tag, void *ptr, size_t size);
+
+char *mem_tag_strdup(enum mem_tag tag, const char *s);
+
+void mem_tag_free(void *ptr);
+
+void mem_account_get(enum mem_tag tag, struct mem_account_stats *stats);
+
+/**
+ * mem_account_log:
+ *
+ * Logs current, peak and allocation count of every subsystem.
+ **/
+void mem_account_log(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
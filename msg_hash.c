@@ -15,21 +15,130 @@
 
 #include <string.h>
 
+#include <boolean.h>
+#include <retro_inline.h>
+
 #include <rhash.h>
 
+#include "libretro.h"
 #include "msg_hash.h"
 
 #include "configuration.h"
 
-const char *msg_hash_to_str(uint32_t hash)
+/* Every message the frontend asks for. Their strings are resolved
+ * once per language, with the US fallback already applied. */
+static const uint32_t msg_hash_known[] = {
+   MSG_UNKNOWN,
+   MSG_PROGRAM,
+   MSG_FOUND_SHADER,
+   MSG_LOADING_HISTORY_FILE,
+   MSG_SRAM_WILL_NOT_BE_SAVED,
+   MSG_RECEIVED,
+   MSG_LOADING_CONTENT_FILE,
+   MSG_USING_LIBRETRO_DUMMY_CORE_RECORDING_SKIPPED,
+   MSG_RECORDING_TERMINATED_DUE_TO_RESIZE,
+   MSG_FAILED_TO_START_RECORDING,
+   MSG_REWIND_INIT,
+   MSG_REWIND_INIT_FAILED,
+   MSG_REWIND_INIT_FAILED_THREADED_AUDIO,
+   MSG_REWIND_INIT_FAILED_NO_SAVESTATES,
+   MSG_LIBRETRO_ABI_BREAK,
+   MSG_NETPLAY_FAILED,
+   MSG_NETPLAY_FAILED_MOVIE_PLAYBACK_HAS_STARTED,
+   MSG_DETECTED_VIEWPORT_OF,
+   MSG_RECORDING_TO,
+   MSG_HW_RENDERED_MUST_USE_POSTSHADED_RECORDING,
+   MSG_VIEWPORT_SIZE_CALCULATION_FAILED,
+   MSG_AUTOSAVE_FAILED,
+   MSG_MOVIE_RECORD_STOPPED,
+   MSG_MOVIE_PLAYBACK_ENDED,
+   MSG_TAKING_SCREENSHOT,
+   MSG_FAILED_TO_TAKE_SCREENSHOT,
+   MSG_CUSTOM_TIMING_GIVEN,
+   MSG_SAVING_STATE,
+   MSG_LOADING_STATE,
+   MSG_FAILED_TO_SAVE_STATE_TO,
+   MSG_FAILED_TO_SAVE_SRAM,
+   MSG_STATE_SIZE,
+   MSG_FAILED_TO_LOAD_CONTENT,
+   MSG_COULD_NOT_READ_CONTENT_FILE,
+   MSG_SAVED_SUCCESSFULLY_TO,
+   MSG_BYTES,
+   MSG_BLOCKING_SRAM_OVERWRITE,
+   MSG_UNRECOGNIZED_COMMAND,
+   MSG_SENDING_COMMAND,
+   MSG_RESTARTING_RECORDING_DUE_TO_DRIVER_REINIT,
+   MSG_REWINDING,
+   MSG_SLOW_MOTION_REWIND,
+   MSG_SLOW_MOTION,
+   MSG_REWIND_REACHED_END,
+   MSG_FAILED_TO_START_MOVIE_RECORD,
+   MSG_STATE_SLOT,
+   MSG_STARTING_MOVIE_RECORD_TO,
+   MSG_FAILED_TO_APPLY_SHADER,
+   MSG_APPLYING_SHADER,
+   MSG_SHADER,
+   MSG_REDIRECTING_SAVESTATE_TO,
+   MSG_REDIRECTING_SAVEFILE_TO,
+   MSG_REDIRECTING_CHEATFILE_TO,
+   MSG_SCANNING,
+   MSG_SCANNING_OF_DIRECTORY_FINISHED,
+   MSG_COULD_NOT_PROCESS_ZIP_FILE,
+   MSG_LOADED_STATE_FROM_SLOT,
+   MSG_REMOVING_TEMPORARY_CONTENT_FILE,
+   MSG_FAILED_TO_REMOVE_TEMPORARY_FILE,
+   MSG_STARTING_MOVIE_PLAYBACK,
+   MSG_APPENDED_DISK,
+   MSG_SKIPPING_SRAM_LOAD,
+   MSG_CONFIG_DIRECTORY_NOT_SET,
+   MSG_SAVED_STATE_TO_SLOT,
+   MSG_CORE_DOES_NOT_SUPPORT_SAVESTATES,
+   MSG_FAILED_TO_LOAD_STATE,
+   MSG_RESET,
+   MSG_AUDIO_MUTED,
+   MSG_AUDIO_UNMUTED,
+   MSG_FAILED_TO_UNMUTE_AUDIO,
+   MSG_FAILED_TO_LOAD_OVERLAY,
+   MSG_PAUSED,
+   MSG_UNPAUSED,
+   MSG_CORE_DOES_NOT_SUPPORT_DISK_OPTIONS,
+   MSG_GRAB_MOUSE_STATE,
+   MSG_FAILED_TO_LOAD_MOVIE_FILE,
+   MSG_FAILED_TO,
+   MSG_SAVING_RAM_TYPE,
+   MSG_TO,
+   MSG_VIRTUAL_DISK_TRAY,
+   MSG_REMOVED_DISK_FROM_TRAY,
+   MSG_FAILED_TO_REMOVE_DISK_FROM_TRAY,
+   MSG_GOT_INVALID_DISK_INDEX,
+   MSG_TASK_FAILED,
+   MSG_DOWNLOADING,
+   MSG_EXTRACTING
+};
+
+/* Power of two, kept at least twice the number of known messages
+ * so probe sequences stay short. */
+#define MSG_HASH_TABLE_SIZE 256
+
+struct msg_hash_slot
 {
-   const char *ret = NULL;
-   settings_t *settings = config_get_ptr();
+   uint32_t hash;
+   const char *str;
+};
 
-   if (!settings)
-      goto end;
+struct msg_hash_table
+{
+   bool ready;
+   struct msg_hash_slot slots[MSG_HASH_TABLE_SIZE];
+};
+
+static struct msg_hash_table msg_hash_tables[RETRO_LANGUAGE_LAST];
+
+static const char *msg_hash_resolve(unsigned language, uint32_t hash)
+{
+   const char *ret = NULL;
 
-   switch (settings->user_language)
+   switch (language)
    {
       case RETRO_LANGUAGE_FRENCH:
          ret = msg_hash_to_str_fr(hash);
@@ -62,10 +171,82 @@ const char *msg_hash_to_str(uint32_t hash)
    if (ret && strcmp(ret, "null") != 0)
       return ret;
 
-end:
    return msg_hash_to_str_us(hash);
 }
 
+static INLINE unsigned msg_hash_slot_index(uint32_t hash)
+{
+   /* djb2 mixes poorly into the low bits, fold the top in. */
+   return (hash ^ (hash >> 16)) & (MSG_HASH_TABLE_SIZE - 1);
+}
+
+static void msg_hash_table_build(struct msg_hash_table *table,
+      unsigned language)
+{
+   unsigned i;
+
+   memset(table->slots, 0, sizeof(table->slots));
+
+   for (i = 0; i < sizeof(msg_hash_known) / sizeof(msg_hash_known[0]); i++)
+   {
+      uint32_t hash   = msg_hash_known[i];
+      const char *str = msg_hash_resolve(language, hash);
+      unsigned idx    = msg_hash_slot_index(hash);
+
+      if (!str)
+         continue;
+
+      while (table->slots[idx].str && table->slots[idx].hash != hash)
+         idx = (idx + 1) & (MSG_HASH_TABLE_SIZE - 1);
+
+      table->slots[idx].hash = hash;
+      table->slots[idx].str  = str;
+   }
+
+   table->ready = true;
+}
+
+/**
+ * msg_hash_set_language:
+ * @language            : enum retro_language to resolve messages for.
+ *
+ * Builds the message table of @language, if it was not built yet.
+ * msg_hash_to_str() builds it on first use otherwise.
+ **/
+void msg_hash_set_language(unsigned language)
+{
+   if (language >= RETRO_LANGUAGE_LAST)
+      language = RETRO_LANGUAGE_ENGLISH;
+
+   if (!msg_hash_tables[language].ready)
+      msg_hash_table_build(&msg_hash_tables[language], language);
+}
+
+const char *msg_hash_to_str(uint32_t hash)
+{
+   unsigned idx;
+   unsigned language                  = RETRO_LANGUAGE_ENGLISH;
+   const struct msg_hash_table *table = NULL;
+   settings_t *settings               = config_get_ptr();
+
+   if (settings && settings->user_language < RETRO_LANGUAGE_LAST)
+      language = settings->user_language;
+
+   table = &msg_hash_tables[language];
+   if (!table->ready)
+      msg_hash_set_language(language);
+
+   for (idx = msg_hash_slot_index(hash); table->slots[idx].str;
+         idx = (idx + 1) & (MSG_HASH_TABLE_SIZE - 1))
+   {
+      if (table->slots[idx].hash == hash)
+         return table->slots[idx].str;
+   }
+
+   /* Not one of the known messages. */
+   return msg_hash_resolve(language, hash);
+}
+
 uint32_t msg_hash_calculate(const char *s)
 {
    return djb2_calculate(s);
@@ -157,6 +157,15 @@
 
 const char *msg_hash_to_str(uint32_t hash);
 
+/**
+ * msg_hash_set_language:
+ * @language            : enum retro_language to resolve messages for.
+ *
+ * Builds the message table of @language, if it was not built yet.
+ * msg_hash_to_str() builds it on first use otherwise.
+ **/
+void msg_hash_set_language(unsigned language);
+
 const char *msg_hash_to_str_fr(uint32_t hash);
 
 const char *msg_hash_to_str_de(uint32_t hash);
@@ -26,6 +26,10 @@
 #include <retro_miscellaneous.h>
 #include <net/net_compat.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #include "verbosity.h"
 
 #if !defined(PC_DEVELOPMENT_IP_ADDRESS)
@@ -39,6 +43,176 @@
 static int g_sid;
 static struct sockaddr_in target;
 static char sendbuf[4096];
+
+#ifdef HAVE_THREADS
+/* Bytes of log text the queue holds before messages get dropped. */
+#ifndef NETLOGGER_QUEUE_SIZE
+#define NETLOGGER_QUEUE_SIZE  (32 * 1024)
+#endif
+
+/* Payload of one packet, small enough to never get fragmented. */
+#define NETLOGGER_PACKET_SIZE 1400
+
+/* How long queued text may wait before it is sent anyway. */
+#define NETLOGGER_FLUSH_USEC  10000
+
+/* Every packet starts with a header line:
+ *
+ *    #<sequence> <dropped>\n
+ *
+ * The sequence number goes up by one per packet, so a gap on the
+ * receiving side means packets were lost on the way. <dropped> is
+ * the total number of messages dropped so far because the queue
+ * was full. */
+static struct
+{
+   char queue[NETLOGGER_QUEUE_SIZE];
+   size_t read;
+   size_t size;
+   unsigned dropped;
+   unsigned sequence;
+
+   bool quit;
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond;
+} netlogger;
+
+/* Takes whole lines, up to one packet, off the queue.
+ * Called with the queue lock held. */
+static size_t netlogger_pull(char *s, size_t len)
+{
+   size_t i;
+   size_t count = MIN(len, netlogger.size);
+
+   for (i = 0; i < count; i++)
+      s[i] = netlogger.queue[(netlogger.read + i) % NETLOGGER_QUEUE_SIZE];
+
+   /* Don't split a line over two packets, unless it doesn't
+    * fit into one anyway. */
+   {
+      size_t end = count;
+
+      while (end && s[end - 1] != '\n')
+         end--;
+      if (end)
+         count = end;
+   }
+
+   netlogger.read  = (netlogger.read + count) % NETLOGGER_QUEUE_SIZE;
+   netlogger.size -= count;
+   return count;
+}
+
+static void netlogger_thread(void *data)
+{
+   char packet[NETLOGGER_PACKET_SIZE];
+   (void)data;
+
+   slock_lock(netlogger.lock);
+
+   for (;;)
+   {
+      int header;
+      size_t len;
+
+      if (!netlogger.size)
+      {
+         if (netlogger.quit)
+            break;
+         scond_wait_timeout(netlogger.cond, netlogger.lock,
+               NETLOGGER_FLUSH_USEC);
+         continue;
+      }
+
+      header = snprintf(packet, sizeof(packet), "#%u %u\n",
+            netlogger.sequence++, netlogger.dropped);
+      len    = netlogger_pull(packet + header, sizeof(packet) - header);
+
+      /* The socket may block, let callers keep queueing meanwhile. */
+      slock_unlock(netlogger.lock);
+      sendto(g_sid, packet, header + len, 0,
+            (struct sockaddr*)&target, sizeof(target));
+      slock_lock(netlogger.lock);
+   }
+
+   slock_unlock(netlogger.lock);
+}
+
+static void netlogger_push(const char *s, size_t len)
+{
+   size_t i, write;
+
+   slock_lock(netlogger.lock);
+
+   if (len > NETLOGGER_QUEUE_SIZE - netlogger.size)
+   {
+      netlogger.dropped++;
+      slock_unlock(netlogger.lock);
+      return;
+   }
+
+   write = (netlogger.read + netlogger.size) % NETLOGGER_QUEUE_SIZE;
+   for (i = 0; i < len; i++)
+      netlogger.queue[(write + i) % NETLOGGER_QUEUE_SIZE] = s[i];
+   netlogger.size += len;
+
+   /* Otherwise the sender picks it up on its next timeout. */
+   if (netlogger.size >= NETLOGGER_PACKET_SIZE)
+      scond_signal(netlogger.cond);
+
+   slock_unlock(netlogger.lock);
+}
+
+static bool netlogger_start(void)
+{
+   netlogger.read     = 0;
+   netlogger.size     = 0;
+   netlogger.dropped  = 0;
+   netlogger.sequence = 0;
+   netlogger.quit     = false;
+   netlogger.lock     = slock_new();
+   netlogger.cond     = scond_new();
+
+   if (!netlogger.lock || !netlogger.cond)
+      goto error;
+
+   netlogger.thread   = sthread_create(netlogger_thread, NULL);
+   if (!netlogger.thread)
+      goto error;
+
+   return true;
+
+error:
+   if (netlogger.lock)
+      slock_free(netlogger.lock);
+   if (netlogger.cond)
+      scond_free(netlogger.cond);
+   netlogger.lock = NULL;
+   netlogger.cond = NULL;
+   return false;
+}
+
+static void netlogger_stop(void)
+{
+   if (!netlogger.thread)
+      return;
+
+   /* The sender empties the queue before it exits. */
+   slock_lock(netlogger.lock);
+   netlogger.quit = true;
+   scond_signal(netlogger.cond);
+   slock_unlock(netlogger.lock);
+
+   sthread_join(netlogger.thread);
+   slock_free(netlogger.lock);
+   scond_free(netlogger.cond);
+
+   netlogger.thread = NULL;
+   netlogger.lock   = NULL;
+   netlogger.cond   = NULL;
+}
+#endif
 #ifdef VITA
 static void *net_memory = NULL;
 #define NET_INIT_SIZE 512*1024
@@ -138,11 +312,23 @@ void logger_init (void)
 {
    if (network_interface_up(&target, 1,
          PC_DEVELOPMENT_IP_ADDRESS,PC_DEVELOPMENT_UDP_PORT, &g_sid) < 0)
+   {
       printf("Could not initialize network logger interface.\n");
+      return;
+   }
+
+#ifdef HAVE_THREADS
+   if (!netlogger_start())
+      printf("Could not start network logger thread, sending synchronously.\n");
+#endif
 }
 
 void logger_shutdown (void)
 {
+#ifdef HAVE_THREADS
+   netlogger_stop();
+#endif
+
    if (network_interface_down(&target, &g_sid) < 0)
       printf("Could not deinitialize network logger interface.\n");
 }
@@ -159,6 +345,20 @@ void logger_send(const char *__format,...)
 void logger_send_v(const char *__format, va_list args)
 {
    int len;
+
+#ifdef HAVE_THREADS
+   if (netlogger.thread)
+   {
+      char msg[1024];
+
+      len = vsnprintf(msg, sizeof(msg), __format, args);
+      if (len < 0)
+         return;
+      netlogger_push(msg, MIN((size_t)len, sizeof(msg) - 1));
+      return;
+   }
+#endif
+
    vsnprintf(sendbuf,4000,__format, args);
    len = strlen(sendbuf);
    sendto(g_sid,sendbuf,len,MSG_DONTWAIT,(struct sockaddr*)&target,sizeof(target));
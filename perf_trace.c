@@ -0,0 +1,337 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2016 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <compat/strl.h>
+#include <retro_miscellaneous.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#include "perf_trace.h"
+#include "configuration.h"
+#include "performance.h"
+#include "verbosity.h"
+
+/* Each thread records into its own ring, found through a
+ * thread-local pointer. Without thread-local storage, all
+ * threads share the first ring and take perf_trace_lock to
+ * record into it. */
+#if defined(HAVE_THREADS) && defined(_MSC_VER)
+#define PERF_TRACE_TLS __declspec(thread)
+#elif defined(HAVE_THREADS) && defined(__GNUC__) && !defined(RARCH_CONSOLE)
+#define PERF_TRACE_TLS __thread
+#endif
+
+#ifndef PERF_TRACE_MAX_THREADS
+#define PERF_TRACE_MAX_THREADS 16
+#endif
+
+struct perf_trace_event
+{
+   const char *name;
+   retro_time_t time;
+   /* Only used by counter events. */
+   uint64_t value;
+   char phase;
+};
+
+struct perf_trace_ring
+{
+   struct perf_trace_event *events;
+   /* Only written by the owning thread. */
+   volatile size_t count;
+   unsigned tid;
+};
+
+volatile bool perf_trace_active;
+
+static struct perf_trace_ring perf_trace_rings[PERF_TRACE_MAX_THREADS];
+static unsigned perf_trace_ring_count;
+#ifdef HAVE_THREADS
+static slock_t *perf_trace_lock;
+#endif
+#ifdef PERF_TRACE_TLS
+static PERF_TRACE_TLS struct perf_trace_ring *perf_trace_thread_ring;
+static PERF_TRACE_TLS unsigned perf_trace_thread_generation;
+#endif
+
+/* Frames run so far, for perf_trace_start_frame. */
+static unsigned perf_trace_frame_count;
+static unsigned perf_trace_generation;
+static unsigned perf_trace_armed_frames;
+static unsigned perf_trace_frames_left;
+static bool perf_trace_in_frame;
+static char perf_trace_path[PATH_MAX_LENGTH];
+
+static struct perf_trace_ring *perf_trace_ring_new(void)
+{
+   struct perf_trace_ring *ring = NULL;
+
+#ifdef HAVE_THREADS
+   slock_lock(perf_trace_lock);
+#endif
+
+   if (perf_trace_ring_count < PERF_TRACE_MAX_THREADS)
+   {
+      ring = &perf_trace_rings[perf_trace_ring_count];
+
+      if (!ring->events)
+         ring->events = (struct perf_trace_event*)
+            malloc(PERF_TRACE_RING_SIZE * sizeof(*ring->events));
+
+      if (ring->events)
+      {
+         ring->count = 0;
+         ring->tid   = perf_trace_ring_count++;
+      }
+      else
+         ring = NULL;
+   }
+
+#ifdef HAVE_THREADS
+   slock_unlock(perf_trace_lock);
+#endif
+
+   return ring;
+}
+
+static struct perf_trace_ring *perf_trace_get_ring(void)
+{
+#ifdef PERF_TRACE_TLS
+   /* Rings are handed out anew for every window. */
+   if (perf_trace_thread_generation != perf_trace_generation)
+   {
+      perf_trace_thread_ring       = perf_trace_ring_new();
+      perf_trace_thread_generation = perf_trace_generation;
+   }
+   return perf_trace_thread_ring;
+#else
+   if (!perf_trace_ring_count)
+      return perf_trace_ring_new();
+   return &perf_trace_rings[0];
+#endif
+}
+
+static void perf_trace_push(const char *name, char phase, uint64_t value)
+{
+   struct perf_trace_event *event = NULL;
+   struct perf_trace_ring *ring   = perf_trace_get_ring();
+
+   if (!ring)
+      return;
+
+#if defined(HAVE_THREADS) && !defined(PERF_TRACE_TLS)
+   slock_lock(perf_trace_lock);
+#endif
+
+   event        = &ring->events[ring->count % PERF_TRACE_RING_SIZE];
+   event->name  = name;
+   event->time  = retro_get_time_usec();
+   event->value = value;
+   event->phase = phase;
+   ring->count++;
+
+#if defined(HAVE_THREADS) && !defined(PERF_TRACE_TLS)
+   slock_unlock(perf_trace_lock);
+#endif
+}
+
+void perf_trace_begin(const char *name)
+{
+   if (perf_trace_active && name)
+      perf_trace_push(name, 'B', 0);
+}
+
+void perf_trace_end(const char *name)
+{
+   if (perf_trace_active && name)
+      perf_trace_push(name, 'E', 0);
+}
+
+void perf_trace_counter(const char *name, uint64_t value)
+{
+   if (perf_trace_active && name)
+      perf_trace_push(name, 'C', value);
+}
+
+static void perf_trace_write_string(FILE *file, const char *s)
+{
+   fputc('"', file);
+
+   for (; *s; s++)
+   {
+      if (*s == '"' || *s == '\\')
+         fputc('\\', file);
+      if ((unsigned char)*s >= 0x20)
+         fputc(*s, file);
+   }
+
+   fputc('"', file);
+}
+
+static bool perf_trace_write(const char *path)
+{
+   unsigned i;
+   bool first  = true;
+   size_t lost = 0;
+   FILE *file  = fopen(path, "w");
+
+   if (!file)
+      return false;
+
+   fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+   for (i = 0; i < perf_trace_ring_count; i++)
+   {
+      size_t j;
+      const struct perf_trace_ring *ring = &perf_trace_rings[i];
+      size_t count = MIN(ring->count, PERF_TRACE_RING_SIZE);
+      size_t begin = ring->count - count;
+
+      lost += ring->count - count;
+
+      fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+            "\"tid\":%u,\"args\":{\"name\":\"%s %u\"}}",
+            first ? "" : ",\n", ring->tid,
+            ring->tid ? "thread" : "main", ring->tid);
+      first = false;
+
+      for (j = begin; j < begin + count; j++)
+      {
+         const struct perf_trace_event *event =
+            &ring->events[j % PERF_TRACE_RING_SIZE];
+
+         fprintf(file, ",\n{\"name\":");
+         perf_trace_write_string(file, event->name);
+         fprintf(file, ",\"ph\":\"%c\",\"pid\":1,\"tid\":%u,\"ts\":%llu",
+               event->phase, ring->tid, (unsigned long long)event->time);
+         if (event->phase == 'C')
+            fprintf(file, ",\"args\":{\"value\":%llu}",
+                  (unsigned long long)event->value);
+         fputc('}', file);
+      }
+   }
+
+   fprintf(file, "\n]}\n");
+   fclose(file);
+
+   if (lost)
+      RARCH_WARN("[PERF]: %u trace events were overwritten, "
+            "raise PERF_TRACE_RING_SIZE.\n", (unsigned)lost);
+
+   return true;
+}
+
+bool perf_trace_start(unsigned frames, const char *path)
+{
+   if (!frames || perf_trace_active || perf_trace_armed_frames)
+      return false;
+
+#ifdef HAVE_THREADS
+   if (!perf_trace_lock)
+      perf_trace_lock = slock_new();
+   if (!perf_trace_lock)
+      return false;
+#endif
+
+   strlcpy(perf_trace_path, path && *path ? path : PERF_TRACE_DEFAULT_PATH,
+         sizeof(perf_trace_path));
+   perf_trace_armed_frames = frames;
+
+   RARCH_LOG("[PERF]: Tracing the next %u frames.\n", frames);
+   return true;
+}
+
+void perf_trace_stop(void)
+{
+   if (!perf_trace_active)
+   {
+      perf_trace_armed_frames = 0;
+      return;
+   }
+
+   if (perf_trace_in_frame)
+      perf_trace_end("frame");
+   perf_trace_in_frame = false;
+   perf_trace_active   = false;
+
+   if (perf_trace_write(perf_trace_path))
+      RARCH_LOG("[PERF]: Trace written to \"%s\".\n", perf_trace_path);
+   else
+      RARCH_ERR("[PERF]: Could not write trace to \"%s\".\n", perf_trace_path);
+}
+
+void perf_trace_deinit(void)
+{
+   unsigned i;
+
+   perf_trace_stop();
+
+   for (i = 0; i < PERF_TRACE_MAX_THREADS; i++)
+   {
+      free(perf_trace_rings[i].events);
+      perf_trace_rings[i].events = NULL;
+   }
+   perf_trace_ring_count = 0;
+   /* Thread-local ring pointers are stale now. */
+   perf_trace_generation++;
+
+#ifdef HAVE_THREADS
+   if (perf_trace_lock)
+      slock_free(perf_trace_lock);
+   perf_trace_lock = NULL;
+#endif
+}
+
+void perf_trace_frame(void)
+{
+   settings_t *settings = config_get_ptr();
+
+   if (settings && settings->perf_trace_frames
+         && perf_trace_frame_count == settings->perf_trace_start_frame)
+      perf_trace_start(settings->perf_trace_frames, settings->perf_trace_path);
+   perf_trace_frame_count++;
+
+   if (perf_trace_armed_frames)
+   {
+      perf_trace_frames_left  = perf_trace_armed_frames;
+      perf_trace_armed_frames = 0;
+      perf_trace_ring_count   = 0;
+      perf_trace_generation++;
+      perf_trace_active       = true;
+   }
+
+   if (!perf_trace_active)
+      return;
+
+   if (perf_trace_in_frame)
+      perf_trace_end("frame");
+
+   if (!perf_trace_frames_left)
+   {
+      perf_trace_in_frame = false;
+      perf_trace_stop();
+      return;
+   }
+
+   perf_trace_frames_left--;
+   perf_trace_begin("frame");
+   perf_trace_in_frame = true;
+}
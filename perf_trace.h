@@ -0,0 +1,114 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2016 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __RARCH_PERF_TRACE_H
+#define __RARCH_PERF_TRACE_H
+
+#include <stdint.h>
+
+#include <boolean.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PERF_TRACE_DEFAULT_PATH "retroarch-trace.json"
+
+/* Events kept per thread, 32 bytes each. Once a thread's ring
+ * is full, its oldest events are overwritten. */
+#ifndef PERF_TRACE_RING_SIZE
+#if defined(RARCH_CONSOLE) || defined(_3DS)
+#define PERF_TRACE_RING_SIZE (4 * 1024)
+#else
+#define PERF_TRACE_RING_SIZE (64 * 1024)
+#endif
+#endif
+
+/* Non-zero while a frame window is being recorded. Checked
+ * before calling into perf_trace_begin()/perf_trace_end(). */
+extern volatile bool perf_trace_active;
+
+/**
+ * perf_trace_start:
+ * @frames              : Number of frames to record.
+ * @path                : File the trace is written to once the
+ *                        window is over, NULL for
+ *                        PERF_TRACE_DEFAULT_PATH.
+ *
+ * Starts recording at the next frame. Performance counters of
+ * both the frontend and the core, as well as the runloop phases,
+ * end up in the trace.
+ *
+ * Returns: true (1) if recording was armed, otherwise false (0).
+ **/
+bool perf_trace_start(unsigned frames, const char *path);
+
+/**
+ * perf_trace_stop:
+ *
+ * Ends the current window early and writes the trace out.
+ * Called before the core is unloaded, since counter names
+ * point into the core.
+ **/
+void perf_trace_stop(void);
+
+/**
+ * perf_trace_deinit:
+ *
+ * Ends the current window, if any, and frees every ring.
+ * No other thread may be recording anymore.
+ **/
+void perf_trace_deinit(void);
+
+/**
+ * perf_trace_frame:
+ *
+ * Called at the start of every frame. Opens the armed window,
+ * closes it once enough frames were recorded and writes the
+ * trace out.
+ **/
+void perf_trace_frame(void);
+
+/**
+ * perf_trace_begin:
+ * @name                : Name of the slice. Has to stay valid
+ *                        until the trace is written.
+ *
+ * Opens a slice on the calling thread's timeline.
+ **/
+void perf_trace_begin(const char *name);
+
+/**
+ * perf_trace_end:
+ * @name                : Name of the slice.
+ *
+ * Closes the slice opened by perf_trace_begin().
+ **/
+void perf_trace_end(const char *name);
+
+/**
+ * perf_trace_counter:
+ * @name                : Name of the counter track.
+ * @value               : Current value.
+ *
+ * Adds a sample to a counter track of the trace.
+ **/
+void perf_trace_counter(const char *name, uint64_t value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -15,16 +15,29 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+
+#include <retro_inline.h>
+#include <retro_miscellaneous.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #include "libretro.h"
 #include "performance.h"
+#include "perf_trace.h"
+#include "hw_counters.h"
 #include "general.h"
+#include "configuration.h"
 #include "compat/strl.h"
 #include "verbosity.h"
 
 #ifdef _WIN32
-#define PERF_LOG_FMT "[PERF]: Avg (%s): %I64u ticks, %I64u runs.\n"
+#define PERF_LOG_FMT "[PERF]: %*s%s: avg %.3f, min %.3f, max %.3f, p50 %.3f, p95 %.3f, p99 %.3f usec, %I64u runs.\n"
+#define PERF_LOG_TICKS_FMT "[PERF]: %*s%s: avg %I64u, min %I64u, max %I64u, p50 %I64u, p95 %I64u, p99 %I64u ticks, %I64u runs.\n"
 #else
-#define PERF_LOG_FMT "[PERF]: Avg (%s): %llu ticks, %llu runs.\n"
+#define PERF_LOG_FMT "[PERF]: %*s%s: avg %.3f, min %.3f, max %.3f, p50 %.3f, p95 %.3f, p99 %.3f usec, %llu runs.\n"
+#define PERF_LOG_TICKS_FMT "[PERF]: %*s%s: avg %llu, min %llu, max %llu, p50 %llu, p95 %llu, p99 %llu ticks, %llu runs.\n"
 #endif
 
 #if !defined(_WIN32) && !defined(RARCH_CONSOLE)
@@ -109,29 +122,366 @@ static int clock_gettime(int clk_ik, struct timespec *t)
 #include "frontend/drivers/platform_linux.h"
 #endif
 
-static struct retro_perf_counter *perf_counters_rarch[MAX_COUNTERS];
-static struct retro_perf_counter *perf_counters_libretro[MAX_COUNTERS];
-static unsigned perf_ptr_rarch;
-static unsigned perf_ptr_libretro;
+/* Set by retro_get_cpu_features() when the TSC runs at a constant
+ * rate, regardless of frequency scaling and sleep states. */
+static bool perf_tsc_invariant;
+/* Read the cycle counter instead of calling clock_gettime(). */
+static bool perf_use_raw_ticks;
+
+/* Calibration of the tick source against retro_get_time_usec(). */
+static double perf_usec_per_tick;
+static retro_perf_tick_t perf_calibration_ticks;
+static retro_time_t perf_calibration_usec;
+static bool perf_calibration_refined;
+
+/* Durations are bucketed by power of two, each power split into
+ * PERF_HISTOGRAM_SUB_BUCKETS linear steps, so a percentile is off
+ * by at most 1 / PERF_HISTOGRAM_SUB_BUCKETS of its value. */
+#define PERF_HISTOGRAM_SUB_BITS    2
+#define PERF_HISTOGRAM_SUB_BUCKETS (1 << PERF_HISTOGRAM_SUB_BITS)
+#define PERF_HISTOGRAM_BUCKETS     ((64 - PERF_HISTOGRAM_SUB_BITS + 1) * PERF_HISTOGRAM_SUB_BUCKETS)
+
+/* Deepest nesting of running counters tracked. */
+#define PERF_STACK_DEPTH           32
+
+struct perf_registry;
+
+struct perf_stats
+{
+   struct retro_perf_counter *counter;
+   struct perf_registry *registry;
+   /* Counter that was running when this one first started. */
+   struct perf_stats *parent;
+   bool parent_known;
+
+   retro_perf_tick_t min;
+   retro_perf_tick_t max;
+   uint64_t samples;
+   uint32_t histogram[PERF_HISTOGRAM_BUCKETS];
+};
+
+struct perf_registry
+{
+   /* Kept next to stats for retro_get_perf_counter_*(). */
+   struct retro_perf_counter **counters;
+   struct perf_stats **stats;
+   unsigned count;
+   unsigned capacity;
+};
+
+static struct perf_registry perf_rarch;
+static struct perf_registry perf_libretro;
+
+/* Open-addressed map from counter to stats, for both registries. */
+static struct perf_stats **perf_map;
+static size_t perf_map_size;
+static size_t perf_map_count;
+
+/* Counters are registered, started and stopped from any thread
+ * (threaded video, core threads), the registries and the map are
+ * only touched with this lock held. Starting and stopping a counter
+ * only takes it the first time a thread sees that counter. */
+#ifdef HAVE_THREADS
+static slock_t *perf_lock;
+#endif
+
+/* Running counters are tracked per thread, so a counter's parent
+ * is the one running on its own thread. Without thread-local
+ * storage, parents are not tracked in threaded builds. */
+#if !defined(HAVE_THREADS)
+#define PERF_TLS
+#elif defined(_MSC_VER)
+#define PERF_TLS __declspec(thread)
+#elif defined(__GNUC__) && !defined(RARCH_CONSOLE)
+#define PERF_TLS __thread
+#endif
+
+/* Direct-mapped, per thread cache of perf_map lookups. */
+#define PERF_CACHE_SIZE            64
+
+#ifdef PERF_TLS
+static PERF_TLS struct perf_stats *perf_stack[PERF_STACK_DEPTH];
+static PERF_TLS unsigned perf_stack_depth;
+static PERF_TLS const struct retro_perf_counter *perf_cache_counters[PERF_CACHE_SIZE];
+static PERF_TLS struct perf_stats *perf_cache_stats[PERF_CACHE_SIZE];
+/* Stacks and caches of a generation older than
+ * perf_stack_generation may point to stats freed by
+ * retro_perf_clear(). */
+static PERF_TLS unsigned perf_stack_thread_generation;
+#endif
+static unsigned perf_stack_generation;
+
+static unsigned perf_frame_count;
+
+static void perf_registry_lock(void)
+{
+#ifdef HAVE_THREADS
+   if (perf_lock)
+      slock_lock(perf_lock);
+#endif
+}
+
+static void perf_registry_unlock(void)
+{
+#ifdef HAVE_THREADS
+   if (perf_lock)
+      slock_unlock(perf_lock);
+#endif
+}
+
+/**
+ * rarch_perf_lock_init:
+ *
+ * Creates the lock guarding the counter registries. Called once
+ * at startup, before any other thread exists. The lock lives as
+ * long as the process, since counters can be started up to exit.
+ **/
+void rarch_perf_lock_init(void)
+{
+#ifdef HAVE_THREADS
+   if (!perf_lock)
+      perf_lock = slock_new();
+#endif
+}
+
+static size_t perf_map_index(const struct retro_perf_counter *perf)
+{
+   uint64_t key = (uint64_t)(uintptr_t)perf;
+   key = (key >> 3) * UINT64_C(0x9E3779B97F4A7C15);
+   return (size_t)(key >> 32) & (perf_map_size - 1);
+}
+
+static struct perf_stats *perf_map_find(const struct retro_perf_counter *perf)
+{
+   size_t i;
+
+   if (!perf_map)
+      return NULL;
+
+   for (i = perf_map_index(perf); perf_map[i];
+         i = (i + 1) & (perf_map_size - 1))
+   {
+      if (perf_map[i]->counter == perf)
+         return perf_map[i];
+   }
+
+   return NULL;
+}
+
+/**
+ * perf_stats_lookup:
+ * @perf                : Registered counter.
+ *
+ * Finds the stats of @perf, from the calling thread's cache when
+ * possible, so that starting and stopping a counter doesn't take
+ * perf_lock. The stats of a counter are only updated by the thread
+ * running it, just like its total and call count.
+ *
+ * Returns: stats of @perf, or NULL if it isn't registered.
+ **/
+static struct perf_stats *perf_stats_lookup(
+      const struct retro_perf_counter *perf)
+{
+   struct perf_stats *stats = NULL;
+#ifdef PERF_TLS
+   size_t slot = (size_t)(((uintptr_t)perf >> 3) & (PERF_CACHE_SIZE - 1));
+
+   if (perf_stack_thread_generation != perf_stack_generation)
+   {
+      memset(perf_cache_counters, 0, sizeof(perf_cache_counters));
+      perf_stack_depth             = 0;
+      perf_stack_thread_generation = perf_stack_generation;
+   }
+
+   if (perf_cache_counters[slot] == perf)
+      return perf_cache_stats[slot];
+#endif
+
+   perf_registry_lock();
+   stats = perf_map_find(perf);
+   perf_registry_unlock();
+
+#ifdef PERF_TLS
+   if (stats)
+   {
+      perf_cache_counters[slot] = perf;
+      perf_cache_stats[slot]    = stats;
+   }
+#endif
+
+   return stats;
+}
+
+static void perf_map_insert_nogrow(struct perf_stats *stats)
+{
+   size_t i = perf_map_index(stats->counter);
+
+   while (perf_map[i])
+      i = (i + 1) & (perf_map_size - 1);
+
+   perf_map[i] = stats;
+   perf_map_count++;
+}
+
+static void perf_map_rebuild(size_t size)
+{
+   unsigned i;
+
+   free(perf_map);
+   perf_map       = (struct perf_stats**)calloc(size, sizeof(*perf_map));
+   perf_map_size  = perf_map ? size : 0;
+   perf_map_count = 0;
+
+   if (!perf_map)
+      return;
+
+   for (i = 0; i < perf_rarch.count; i++)
+      perf_map_insert_nogrow(perf_rarch.stats[i]);
+   for (i = 0; i < perf_libretro.count; i++)
+      perf_map_insert_nogrow(perf_libretro.stats[i]);
+}
+
+static bool perf_registry_add(struct perf_registry *reg,
+      struct retro_perf_counter *perf)
+{
+   struct perf_stats *stats = NULL;
+
+   if (reg->count == reg->capacity)
+   {
+      unsigned capacity = reg->capacity ? reg->capacity * 2 : 32;
+      struct retro_perf_counter **counters = (struct retro_perf_counter**)
+         realloc(reg->counters, capacity * sizeof(*counters));
+      struct perf_stats **all_stats        = NULL;
+
+      if (!counters)
+         return false;
+      reg->counters = counters;
+
+      all_stats = (struct perf_stats**)
+         realloc(reg->stats, capacity * sizeof(*all_stats));
+      if (!all_stats)
+         return false;
+      reg->stats    = all_stats;
+      reg->capacity = capacity;
+   }
+
+   /* Keep the map at most half full. */
+   if ((perf_map_count + 1) * 2 > perf_map_size)
+   {
+      perf_map_rebuild(perf_map_size ? perf_map_size * 2 : 128);
+      if (!perf_map)
+         return false;
+   }
+
+   stats = (struct perf_stats*)calloc(1, sizeof(*stats));
+   if (!stats)
+      return false;
+
+   stats->counter  = perf;
+   stats->registry = reg;
+   stats->min      = (retro_perf_tick_t)-1;
+
+   reg->counters[reg->count] = perf;
+   reg->stats[reg->count]    = stats;
+   reg->count++;
+
+   perf_map_insert_nogrow(stats);
+   return true;
+}
+
+static void perf_registry_free(struct perf_registry *reg)
+{
+   unsigned i;
+
+   for (i = 0; i < reg->count; i++)
+      free(reg->stats[i]);
+
+   free(reg->counters);
+   free(reg->stats);
+   memset(reg, 0, sizeof(*reg));
+}
+
+static unsigned perf_histogram_bucket(retro_perf_tick_t ticks)
+{
+   unsigned exp = 0;
+
+   if (ticks < PERF_HISTOGRAM_SUB_BUCKETS)
+      return (unsigned)ticks;
+
+   while ((ticks >> exp) > 1)
+      exp++;
+
+   return (exp - PERF_HISTOGRAM_SUB_BITS + 1) * PERF_HISTOGRAM_SUB_BUCKETS
+      + (unsigned)((ticks >> (exp - PERF_HISTOGRAM_SUB_BITS))
+            & (PERF_HISTOGRAM_SUB_BUCKETS - 1));
+}
+
+/* Largest duration that falls into @bucket. */
+static retro_perf_tick_t perf_histogram_bucket_max(unsigned bucket)
+{
+   unsigned exp, sub;
+
+   if (bucket < PERF_HISTOGRAM_SUB_BUCKETS)
+      return bucket;
+
+   exp = bucket / PERF_HISTOGRAM_SUB_BUCKETS + PERF_HISTOGRAM_SUB_BITS - 1;
+   sub = bucket % PERF_HISTOGRAM_SUB_BUCKETS;
+
+   return ((retro_perf_tick_t)(PERF_HISTOGRAM_SUB_BUCKETS + sub + 1)
+         << (exp - PERF_HISTOGRAM_SUB_BITS)) - 1;
+}
+
+static retro_perf_tick_t perf_stats_percentile(const struct perf_stats *stats,
+      unsigned percent)
+{
+   unsigned i;
+   uint64_t seen   = 0;
+   uint64_t target = (stats->samples * percent + 99) / 100;
+
+   if (!stats->samples)
+      return 0;
+
+   for (i = 0; i < PERF_HISTOGRAM_BUCKETS; i++)
+   {
+      seen += stats->histogram[i];
+      if (seen >= target)
+      {
+         retro_perf_tick_t ticks = perf_histogram_bucket_max(i);
+         return MAX(MIN(ticks, stats->max), stats->min);
+      }
+   }
+
+   return stats->max;
+}
+
+static void perf_stats_reset(struct perf_stats *stats)
+{
+   stats->counter->total    = 0;
+   stats->counter->call_cnt = 0;
+   stats->min               = (retro_perf_tick_t)-1;
+   stats->max               = 0;
+   stats->samples           = 0;
+   memset(stats->histogram, 0, sizeof(stats->histogram));
+}
 
 struct retro_perf_counter **retro_get_perf_counter_rarch(void)
 {
-   return perf_counters_rarch;
+   return perf_rarch.counters;
 }
 
 struct retro_perf_counter **retro_get_perf_counter_libretro(void)
 {
-   return perf_counters_libretro;
+   return perf_libretro.counters;
 }
 
 unsigned retro_get_perf_count_rarch(void)
 {
-   return perf_ptr_rarch;
+   return perf_rarch.count;
 }
 
 unsigned retro_get_perf_count_libretro(void)
 {
-   return perf_ptr_libretro;
+   return perf_libretro.count;
 }
 
 void rarch_perf_register(struct retro_perf_counter *perf)
@@ -139,60 +489,206 @@ void rarch_perf_register(struct retro_perf_counter *perf)
    if (
             !runloop_ctl(RUNLOOP_CTL_IS_PERFCNT_ENABLE, NULL)
          || perf->registered
-         || perf_ptr_rarch >= MAX_COUNTERS
       )
       return;
 
-   perf_counters_rarch[perf_ptr_rarch++] = perf;
-   perf->registered = true;
+   perf_registry_lock();
+   if (perf_map_find(perf) || perf_registry_add(&perf_rarch, perf))
+      perf->registered = true;
+   perf_registry_unlock();
 }
 
 void retro_perf_register(struct retro_perf_counter *perf)
 {
-   if (perf->registered || perf_ptr_libretro >= MAX_COUNTERS)
+   if (perf->registered)
       return;
 
-   perf_counters_libretro[perf_ptr_libretro++] = perf;
-   perf->registered = true;
+   perf_registry_lock();
+   if (perf_map_find(perf) || perf_registry_add(&perf_libretro, perf))
+      perf->registered = true;
+   perf_registry_unlock();
 }
 
 void retro_perf_clear(void)
 {
-   perf_ptr_libretro = 0;
-   memset(perf_counters_libretro, 0, sizeof(perf_counters_libretro));
+   /* Core counter names are about to go away. */
+   perf_trace_stop();
+
+   perf_registry_lock();
+
+   perf_stack_generation++;
+   perf_registry_free(&perf_libretro);
+
+   /* Frontend counters nested in a core counter lose their parent. */
+   {
+      unsigned i;
+      for (i = 0; i < perf_rarch.count; i++)
+      {
+         struct perf_stats *stats = perf_rarch.stats[i];
+         if (stats->parent && stats->parent->registry != &perf_rarch)
+         {
+            stats->parent       = NULL;
+            stats->parent_known = false;
+         }
+      }
+   }
+
+   perf_map_rebuild(perf_map_size ? perf_map_size : 128);
+
+   perf_registry_unlock();
+}
+
+/**
+ * retro_perf_reset:
+ *
+ * Resets the statistics of every registered counter, so the
+ * next log only covers what ran since.
+ **/
+void retro_perf_reset(void)
+{
+   unsigned i;
+
+   perf_registry_lock();
+   for (i = 0; i < perf_rarch.count; i++)
+      perf_stats_reset(perf_rarch.stats[i]);
+   for (i = 0; i < perf_libretro.count; i++)
+      perf_stats_reset(perf_libretro.stats[i]);
+   perf_registry_unlock();
+
+   perf_frame_count = 0;
 }
 
-static void log_counters(struct retro_perf_counter **counters, unsigned num)
+static void log_counter(const struct perf_stats *stats, unsigned depth)
 {
    unsigned i;
-   for (i = 0; i < num; i++)
+   const struct perf_registry *reg  = stats->registry;
+   const struct retro_perf_counter *perf = stats->counter;
+
+   if (perf->call_cnt && stats->samples)
    {
-      if (counters[i]->call_cnt)
-      {
+      retro_perf_tick_t avg = perf->total / perf->call_cnt;
+      retro_perf_tick_t p50 = perf_stats_percentile(stats, 50);
+      retro_perf_tick_t p95 = perf_stats_percentile(stats, 95);
+      retro_perf_tick_t p99 = perf_stats_percentile(stats, 99);
+
+      if (perf_usec_per_tick > 0.0)
          RARCH_LOG(PERF_LOG_FMT,
-               counters[i]->ident,
-               (unsigned long long)counters[i]->total /
-               (unsigned long long)counters[i]->call_cnt,
-               (unsigned long long)counters[i]->call_cnt);
-      }
+               depth * 2, "",
+               perf->ident,
+               retro_perf_ticks_to_usec(avg),
+               retro_perf_ticks_to_usec(stats->min),
+               retro_perf_ticks_to_usec(stats->max),
+               retro_perf_ticks_to_usec(p50),
+               retro_perf_ticks_to_usec(p95),
+               retro_perf_ticks_to_usec(p99),
+               (unsigned long long)perf->call_cnt);
+      else
+         RARCH_LOG(PERF_LOG_TICKS_FMT,
+               depth * 2, "",
+               perf->ident,
+               (unsigned long long)avg,
+               (unsigned long long)stats->min,
+               (unsigned long long)stats->max,
+               (unsigned long long)p50,
+               (unsigned long long)p95,
+               (unsigned long long)p99,
+               (unsigned long long)perf->call_cnt);
+      depth++;
+   }
+
+   for (i = 0; i < reg->count; i++)
+   {
+      if (reg->stats[i]->parent == stats)
+         log_counter(reg->stats[i], depth);
+   }
+}
+
+static void log_counters(const struct perf_registry *reg)
+{
+   unsigned i;
+
+   for (i = 0; i < reg->count; i++)
+   {
+      const struct perf_stats *stats = reg->stats[i];
+
+      /* Counters nested in another registry's counter
+       * are listed at the top level of their own. */
+      if (!stats->parent || stats->parent->registry != reg)
+         log_counter(stats, 0);
    }
 }
 
 void rarch_perf_log(void)
 {
+   hw_counters_log();
+
    if (!runloop_ctl(RUNLOOP_CTL_IS_PERFCNT_ENABLE, NULL))
       return;
 
    RARCH_LOG("[PERF]: Performance counters (RetroArch):\n");
-   log_counters(perf_counters_rarch, perf_ptr_rarch);
+   perf_registry_lock();
+   log_counters(&perf_rarch);
+   perf_registry_unlock();
 }
 
 void retro_perf_log(void)
 {
    RARCH_LOG("[PERF]: Performance counters (libretro):\n");
-   log_counters(perf_counters_libretro, perf_ptr_libretro);
+   perf_registry_lock();
+   log_counters(&perf_libretro);
+   perf_registry_unlock();
 }
 
+/**
+ * rarch_perf_frame:
+ *
+ * Called once per frame. Every perfcnt_reset_interval frames,
+ * logs all counters and resets them.
+ **/
+void rarch_perf_frame(void)
+{
+   settings_t *settings = config_get_ptr();
+
+   if ((!runloop_ctl(RUNLOOP_CTL_IS_PERFCNT_ENABLE, NULL) && !hw_counters_active)
+         || !settings || !settings->perfcnt_reset_interval)
+      return;
+
+   if (++perf_frame_count < settings->perfcnt_reset_interval)
+      return;
+
+   RARCH_LOG("[PERF]: Last %u frames:\n", perf_frame_count);
+   rarch_perf_log();
+   retro_perf_log();
+   retro_perf_reset();
+   hw_counters_reset();
+}
+
+#if defined(__linux__) && defined(__GNUC__) \
+   && (defined(__x86_64__) || defined(__i386__) || defined(__i486__) || defined(__i686__))
+#define PERF_HAVE_TSC
+#elif defined(__linux__) && defined(__GNUC__) && defined(__aarch64__)
+#define PERF_HAVE_CNTVCT
+#endif
+
+#if defined(PERF_HAVE_TSC) || defined(PERF_HAVE_CNTVCT)
+static INLINE retro_perf_tick_t perf_read_raw_ticks(void)
+{
+#if defined(PERF_HAVE_CNTVCT)
+   retro_perf_tick_t ticks;
+   __asm__ volatile ("mrs %0, cntvct_el0" : "=r" (ticks));
+   return ticks;
+#elif defined(__x86_64__)
+   unsigned a, d;
+   __asm__ volatile ("rdtsc" : "=a" (a), "=d" (d));
+   return (retro_perf_tick_t)a | ((retro_perf_tick_t)d << 32);
+#else
+   retro_perf_tick_t ticks;
+   __asm__ volatile ("rdtsc" : "=A" (ticks));
+   return ticks;
+#endif
+}
+#endif
+
 /**
  * retro_get_perf_counter:
  *
@@ -205,6 +701,10 @@ retro_perf_tick_t retro_get_perf_counter(void)
    retro_perf_tick_t time_ticks = 0;
 #if defined(__linux__) || defined(__QNX__) || defined(__MACH__)
    struct timespec tv;
+#if defined(PERF_HAVE_TSC) || defined(PERF_HAVE_CNTVCT)
+   if (perf_use_raw_ticks)
+      return perf_read_raw_ticks();
+#endif
    if (clock_gettime(CLOCK_MONOTONIC, &tv) == 0)
       time_ticks = (retro_perf_tick_t)tv.tv_sec * 1000000000 +
          (retro_perf_tick_t)tv.tv_nsec;
@@ -296,6 +796,94 @@ retro_time_t retro_get_time_usec(void)
 #endif
 }
 
+/* How long rarch_perf_calibrate() spins to get a first estimate. */
+#define PERF_CALIBRATION_USEC        2000
+/* Baseline after which the estimate is redone once, more precisely. */
+#define PERF_CALIBRATION_REFINE_USEC 1000000
+
+/**
+ * rarch_perf_calibrate:
+ *
+ * Picks the cheapest tick source that runs at a constant rate,
+ * which is the TSC on x86 if retro_get_cpu_features() found it to
+ * be invariant, and the virtual counter on AArch64. Then measures
+ * the tick rate against retro_get_time_usec(), for
+ * retro_perf_ticks_to_usec().
+ *
+ * Must be called after retro_get_cpu_features() and before any
+ * counter is started, since the tick unit changes. Only the first
+ * call does anything, so reloading content neither spins again
+ * nor throws away the refined estimate.
+ **/
+void rarch_perf_calibrate(void)
+{
+   retro_perf_tick_t ticks;
+   retro_time_t usec;
+   static bool calibrated = false;
+
+   if (calibrated)
+      return;
+   calibrated = true;
+
+#if defined(PERF_HAVE_TSC)
+   perf_use_raw_ticks = perf_tsc_invariant;
+#elif defined(PERF_HAVE_CNTVCT)
+   perf_use_raw_ticks = true;
+#endif
+
+   perf_calibration_ticks   = retro_get_perf_counter();
+   perf_calibration_usec    = retro_get_time_usec();
+   perf_calibration_refined = false;
+
+   /* No usable reference clock. */
+   if (!perf_calibration_usec)
+      return;
+
+   do
+   {
+      usec  = retro_get_time_usec();
+      ticks = retro_get_perf_counter();
+   } while (usec - perf_calibration_usec < PERF_CALIBRATION_USEC);
+
+   if (ticks > perf_calibration_ticks)
+      perf_usec_per_tick = (double)(usec - perf_calibration_usec)
+         / (double)(ticks - perf_calibration_ticks);
+
+   RARCH_LOG("[PERF]: Tick source: %s, %.3f MHz.\n",
+         perf_use_raw_ticks ? "cycle counter" : "system timer",
+         perf_usec_per_tick > 0.0 ? 1.0 / perf_usec_per_tick : 0.0);
+}
+
+/**
+ * retro_perf_ticks_to_usec:
+ * @ticks              : Difference between two retro_get_perf_counter()
+ *                       values.
+ *
+ * Returns: @ticks in microseconds, or 0 if the tick source
+ * was not calibrated.
+ **/
+double retro_perf_ticks_to_usec(retro_perf_tick_t ticks)
+{
+   if (!perf_calibration_refined && perf_usec_per_tick > 0.0)
+   {
+      retro_time_t usec = retro_get_time_usec();
+
+      /* The startup estimate is only good to a few parts in ten
+       * thousand; redo it once over a long baseline. */
+      if (usec - perf_calibration_usec >= PERF_CALIBRATION_REFINE_USEC)
+      {
+         retro_perf_tick_t now = retro_get_perf_counter();
+
+         if (now > perf_calibration_ticks)
+            perf_usec_per_tick = (double)(usec - perf_calibration_usec)
+               / (double)(now - perf_calibration_ticks);
+         perf_calibration_refined = true;
+      }
+   }
+
+   return ticks * perf_usec_per_tick;
+}
+
 #if defined(__x86_64__) || defined(__i386__) || defined(__i486__) || defined(__i686__)
 #define CPU_X86
 #endif
@@ -547,6 +1135,16 @@ uint64_t retro_get_cpu_features(void)
          cpu |= RETRO_SIMD_MMXEXT;
    }
 
+   /* Not a SIMD feature, so it isn't reported to cores, but
+    * it decides whether perf counters may read the TSC. */
+   if (max_flag >= 0x80000007u)
+   {
+      x86_cpuid(0x80000007, flags);
+      perf_tsc_invariant = (flags[3] & (1 << 8)) != 0;
+      if (perf_tsc_invariant)
+         RARCH_LOG("[CPUID]: Invariant TSC.\n");
+   }
+
 #elif defined(__linux__)
    cpu_flags = linux_get_cpu_features();
 
@@ -609,17 +1207,86 @@ int rarch_perf_init(struct retro_perf_counter *perf, const char *name)
 
 void retro_perf_start(struct retro_perf_counter *perf)
 {
+   struct perf_stats *stats = NULL;
+
+   if (perf_trace_active && perf)
+      perf_trace_begin(perf->ident);
+
    if (!runloop_ctl(RUNLOOP_CTL_IS_PERFCNT_ENABLE, NULL) || !perf)
       return;
 
+   stats = perf_stats_lookup(perf);
+   if (stats)
+   {
+      /* The parent links are walked by the logger, so they are
+       * only changed with the lock held, once per counter. */
+      if (!stats->parent_known)
+      {
+         perf_registry_lock();
+#ifdef PERF_TLS
+         if (!stats->parent_known && perf_stack_depth)
+         {
+            struct perf_stats *parent = perf_stack[perf_stack_depth - 1];
+            struct perf_stats *iter   = parent;
+
+            /* Never make a counter its own ancestor. */
+            while (iter && iter != stats)
+               iter = iter->parent;
+            if (!iter)
+               stats->parent = parent;
+         }
+#endif
+         stats->parent_known = true;
+         perf_registry_unlock();
+      }
+
+#ifdef PERF_TLS
+      if (perf_stack_depth < PERF_STACK_DEPTH)
+         perf_stack[perf_stack_depth++] = stats;
+#endif
+   }
+
    perf->call_cnt++;
    perf->start = retro_get_perf_counter();
 }
 
 void retro_perf_stop(struct retro_perf_counter *perf)
 {
+   unsigned i;
+   retro_perf_tick_t ticks;
+   struct perf_stats *stats = NULL;
+
+   if (perf_trace_active && perf)
+      perf_trace_end(perf->ident);
+
    if (!runloop_ctl(RUNLOOP_CTL_IS_PERFCNT_ENABLE, NULL) || !perf)
       return;
 
-   perf->total += retro_get_perf_counter() - perf->start;
+   ticks        = retro_get_perf_counter() - perf->start;
+   perf->total += ticks;
+
+   stats = perf_stats_lookup(perf);
+   if (!stats)
+      return;
+
+   stats->samples++;
+   stats->histogram[perf_histogram_bucket(ticks)]++;
+   if (ticks < stats->min)
+      stats->min = ticks;
+   if (ticks > stats->max)
+      stats->max = ticks;
+
+#ifdef PERF_TLS
+   /* Also unwinds counters that were started but never stopped. */
+   for (i = perf_stack_depth; i > 0; i--)
+   {
+      if (perf_stack[i - 1] == stats)
+      {
+         perf_stack_depth = i - 1;
+         break;
+      }
+   }
+#else
+   (void)i;
+#endif
 }
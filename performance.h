@@ -25,10 +25,6 @@
 extern "C" {
 #endif
 
-#ifndef MAX_COUNTERS
-#define MAX_COUNTERS 64
-#endif
-
 struct retro_perf_counter **retro_get_perf_counter_rarch(void);
 
 struct retro_perf_counter **retro_get_perf_counter_libretro(void);
@@ -54,6 +50,35 @@ retro_perf_tick_t retro_get_perf_counter(void);
  **/
 retro_time_t retro_get_time_usec(void);
 
+/**
+ * rarch_perf_lock_init:
+ *
+ * Creates the lock guarding the counter registries. Must be
+ * called before a second thread registers or starts a counter.
+ **/
+void rarch_perf_lock_init(void);
+
+/**
+ * rarch_perf_calibrate:
+ *
+ * Picks the cheapest constant-rate tick source for
+ * retro_get_perf_counter() and measures its rate against
+ * retro_get_time_usec(). Must be called after
+ * retro_get_cpu_features() and before any counter is started.
+ * Calls after the first one do nothing.
+ **/
+void rarch_perf_calibrate(void);
+
+/**
+ * retro_perf_ticks_to_usec:
+ * @ticks              : Difference between two retro_get_perf_counter()
+ *                       values.
+ *
+ * Returns: @ticks in microseconds, or 0 if the tick source
+ * was not calibrated.
+ **/
+double retro_perf_ticks_to_usec(retro_perf_tick_t ticks);
+
 void retro_perf_register(struct retro_perf_counter *perf);
 
 /* Same as retro_perf_register, just for libretro cores. */
@@ -61,10 +86,33 @@ void retro_perf_register(struct retro_perf_counter *perf);
 
 void retro_perf_clear(void);
 
+/**
+ * retro_perf_reset:
+ *
+ * Resets the statistics of every registered counter, so the
+ * next log only covers what ran since.
+ **/
+void retro_perf_reset(void);
+
+/**
+ * retro_perf_log:
+ *
+ * Logs the counters registered by the core. Counters started
+ * while another one was running are listed below it. Each
+ * line has average, min, max, p50, p95 and p99 ticks per run.
+ **/
 void retro_perf_log(void);
 
 void rarch_perf_log(void);
 
+/**
+ * rarch_perf_frame:
+ *
+ * Called once per frame. Every perfcnt_reset_interval frames,
+ * logs all counters and resets them.
+ **/
+void rarch_perf_frame(void);
+
 int rarch_perf_init(struct retro_perf_counter *perf, const char *name);
 
 /**
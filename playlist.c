@@ -23,8 +23,11 @@
 #include <compat/posix_string.h>
 
 #include "playlist.h"
+#include "mem_account.h"
 #include "verbosity.h"
 
+#define playlist_strdup(s) mem_tag_strdup(MEM_TAG_PLAYLIST, (s))
+
 struct content_playlist_entry
 {
    char *path;
@@ -123,27 +126,27 @@ static void content_playlist_free_entry(content_playlist_entry_t *entry)
       return;
 
    if (entry->path)
-      free(entry->path);
+      mem_tag_free(entry->path);
    entry->path = NULL;
 
    if (entry->label)
-      free(entry->label);
+      mem_tag_free(entry->label);
    entry->label = NULL;
 
    if (entry->core_path)
-      free(entry->core_path);
+      mem_tag_free(entry->core_path);
    entry->core_path = NULL;
 
    if (entry->core_name)
-      free(entry->core_name);
+      mem_tag_free(entry->core_name);
    entry->core_name = NULL;
 
    if (entry->db_name)
-      free(entry->db_name);
+      mem_tag_free(entry->db_name);
    entry->core_name = NULL;
 
    if (entry->crc32)
-      free(entry->crc32);
+      mem_tag_free(entry->crc32);
    entry->crc32 = NULL;
 
    memset(entry, 0, sizeof(*entry));
@@ -166,12 +169,12 @@ void content_playlist_update(content_playlist_t *playlist, size_t idx,
    if (!entry)
       return;
 
-   entry->path      = path ?  strdup(path)          : entry->path;
-   entry->label     = label ? strdup(label)         : entry->label;
-   entry->core_path = core_path ? strdup(core_path) : entry->core_path;
-   entry->core_name = core_name ? strdup(core_name) : entry->core_name;
-   entry->db_name   = db_name ? strdup(db_name)     : entry->db_name;
-   entry->crc32     = crc32 ? strdup(crc32)         : entry->crc32;
+   entry->path      = path ? playlist_strdup(path) : entry->path;
+   entry->label     = label ? playlist_strdup(label) : entry->label;
+   entry->core_path = core_path ? playlist_strdup(core_path) : entry->core_path;
+   entry->core_name = core_name ? playlist_strdup(core_name) : entry->core_name;
+   entry->db_name   = db_name ? playlist_strdup(db_name) : entry->db_name;
+   entry->crc32     = crc32 ? playlist_strdup(crc32) : entry->crc32;
 }
 
 /**
@@ -241,12 +244,12 @@ void content_playlist_push(content_playlist_t *playlist,
    memmove(playlist->entries + 1, playlist->entries,
          (playlist->cap - 1) * sizeof(content_playlist_entry_t));
 
-   playlist->entries[0].path      = path ? strdup(path) : NULL;
-   playlist->entries[0].label     = label ? strdup(label) : NULL;
-   playlist->entries[0].core_path = core_path ? strdup(core_path) : NULL;
-   playlist->entries[0].core_name = core_name ? strdup(core_name) : NULL;
-   playlist->entries[0].db_name   = db_name ? strdup(db_name) : NULL;
-   playlist->entries[0].crc32     = crc32 ? strdup(crc32) : NULL;
+   playlist->entries[0].path      = path ? playlist_strdup(path) : NULL;
+   playlist->entries[0].label     = label ? playlist_strdup(label) : NULL;
+   playlist->entries[0].core_path = core_path ? playlist_strdup(core_path) : NULL;
+   playlist->entries[0].core_name = core_name ? playlist_strdup(core_name) : NULL;
+   playlist->entries[0].db_name   = db_name ? playlist_strdup(db_name) : NULL;
+   playlist->entries[0].crc32     = crc32 ? playlist_strdup(crc32) : NULL;
    playlist->size++;
 }
 
@@ -290,17 +293,17 @@ void content_playlist_free(content_playlist_t *playlist)
       return;
 
    if (playlist->conf_path)
-      free(playlist->conf_path);
+      mem_tag_free(playlist->conf_path);
 
    playlist->conf_path = NULL;
 
    for (i = 0; i < playlist->cap; i++)
       content_playlist_free_entry(&playlist->entries[i]);
 
-   free(playlist->entries);
+   mem_tag_free(playlist->entries);
    playlist->entries = NULL;
 
-   free(playlist);
+   mem_tag_free(playlist);
 }
 
 /**
@@ -380,15 +383,15 @@ static bool content_playlist_read_file(
          continue;
 
       if (*buf[0])
-         entry->path      = strdup(buf[0]);
+         entry->path      = playlist_strdup(buf[0]);
       if (*buf[1])
-         entry->label     = strdup(buf[1]);
-      entry->core_path    = strdup(buf[2]);
-      entry->core_name    = strdup(buf[3]);
+         entry->label     = playlist_strdup(buf[1]);
+      entry->core_path    = playlist_strdup(buf[2]);
+      entry->core_name    = playlist_strdup(buf[3]);
       if (*buf[4])
-         entry->crc32     = strdup(buf[4]);
+         entry->crc32     = playlist_strdup(buf[4]);
       if (*buf[5])
-         entry->db_name   = strdup(buf[5]);
+         entry->db_name   = playlist_strdup(buf[5]);
       playlist->size++;
    }
 
@@ -409,12 +412,12 @@ end:
 content_playlist_t *content_playlist_init(const char *path, size_t size)
 {
    content_playlist_t *playlist = (content_playlist_t*)
-      calloc(1, sizeof(*playlist));
+      mem_tag_calloc(MEM_TAG_PLAYLIST, 1, sizeof(*playlist));
    if (!playlist)
       return NULL;
 
-   playlist->entries = (content_playlist_entry_t*)calloc(size,
-         sizeof(*playlist->entries));
+   playlist->entries = (content_playlist_entry_t*)
+      mem_tag_calloc(MEM_TAG_PLAYLIST, size, sizeof(*playlist->entries));
    if (!playlist->entries)
       goto error;
 
@@ -422,7 +425,7 @@ content_playlist_t *content_playlist_init(const char *path, size_t size)
 
    content_playlist_read_file(playlist, path);
 
-   playlist->conf_path = strdup(path);
+   playlist->conf_path = playlist_strdup(path);
    return playlist;
 
 error:
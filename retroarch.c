@@ -56,6 +56,9 @@
 #include "runloop.h"
 #include "tasks/tasks.h"
 #include "performance.h"
+#include "hw_counters.h"
+#include "perf_trace.h"
+#include "mem_account.h"
 #include "cheats.h"
 #include "system.h"
 #include "retro_file.h"
@@ -76,6 +79,10 @@
 #include "config.features.h"
 #include "command_event.h"
 
+#ifdef HAVE_LIBRETRODB
+#include "database_info.h"
+#endif
+
 /* Descriptive names for options without short variant. Please keep the name in
    sync with the option name. Order does not matter. */
 enum
@@ -96,7 +103,9 @@ enum
    RA_OPT_VERSION,
    RA_OPT_EOF_EXIT,
    RA_OPT_LOG_FILE,
-   RA_OPT_MAX_FRAMES
+   RA_OPT_MAX_FRAMES,
+   RA_OPT_STARTUP_TIMELINE,
+   RA_OPT_BENCHMARK
 };
 
 static char current_savefile_dir[PATH_MAX_LENGTH];
@@ -104,6 +113,102 @@ static char current_savefile_dir[PATH_MAX_LENGTH];
 static char error_string[PATH_MAX_LENGTH];
 static jmp_buf error_sjlj_context;
 
+#ifndef RARCH_STARTUP_PHASES_MAX
+#define RARCH_STARTUP_PHASES_MAX 32
+#endif
+
+struct rarch_startup_phase
+{
+   const char *name;
+   retro_time_t start;
+   retro_time_t duration;
+};
+
+/* Timeline of rarch_main_init() and the deferred subsystems,
+ * printed with --startup-timeline. */
+static struct
+{
+   struct rarch_startup_phase phases[RARCH_STARTUP_PHASES_MAX];
+   unsigned count;
+   /* Phase currently timed, -1 if none. */
+   int current;
+   retro_time_t origin;
+   retro_time_t first_frame;
+   bool print;
+} rarch_startup;
+
+/* Subsystems the first frame doesn't depend on. They are brought
+ * up one per runloop iteration, starting with the iteration after
+ * the first one, whether that showed a core frame, the menu or
+ * nothing because the core is paused. */
+static const struct
+{
+   const char *name;
+   enum event_command cmd;
+} rarch_deferred_inits[] = {
+   { "rewind",  EVENT_CMD_REWIND_INIT },
+   { "cheats",  EVENT_CMD_CHEATS_INIT },
+   { "command", EVENT_CMD_COMMAND_INIT },
+   { "remote",  EVENT_CMD_REMOTE_INIT },
+};
+
+#define RARCH_DEFERRED_INITS_COUNT \
+   (sizeof(rarch_deferred_inits) / sizeof(rarch_deferred_inits[0]))
+
+static unsigned rarch_deferred_init_next = RARCH_DEFERRED_INITS_COUNT;
+/* Lets the first runloop iteration through before deferred init. */
+static bool rarch_deferred_init_wait;
+
+static void rarch_startup_phase_begin(const char *name)
+{
+   struct rarch_startup_phase *phase = NULL;
+
+   rarch_startup.current = -1;
+
+   if (rarch_startup.count >= RARCH_STARTUP_PHASES_MAX)
+      return;
+
+   rarch_startup.current = rarch_startup.count++;
+   phase                 = &rarch_startup.phases[rarch_startup.current];
+   phase->name           = name;
+   phase->start          = retro_get_time_usec();
+   phase->duration       = 0;
+}
+
+static void rarch_startup_phase_end(void)
+{
+   struct rarch_startup_phase *phase = NULL;
+
+   if (rarch_startup.current < 0)
+      return;
+
+   phase           = &rarch_startup.phases[rarch_startup.current];
+   phase->duration = retro_get_time_usec() - phase->start;
+   rarch_startup.current = -1;
+}
+
+static void rarch_startup_print(void)
+{
+   unsigned i;
+
+   RARCH_LOG("=== Startup timeline ============================\n");
+   RARCH_LOG("   start (ms)  duration (ms)  phase\n");
+
+   for (i = 0; i < rarch_startup.count; i++)
+   {
+      const struct rarch_startup_phase *phase = &rarch_startup.phases[i];
+
+      RARCH_LOG("%13.3f  %13.3f  %s\n",
+            (phase->start - rarch_startup.origin) / 1000.0,
+            phase->duration / 1000.0, phase->name);
+   }
+
+   if (rarch_startup.first_frame)
+      RARCH_LOG("Time to first frame: %.3f ms\n",
+            (rarch_startup.first_frame - rarch_startup.origin) / 1000.0);
+   RARCH_LOG("=================================================\n");
+}
+
 #define _PSUPP(var, name, desc) printf("  %s:\n\t\t%s: %s\n", name, desc, _##var##_supp ? "yes" : "no")
 
 static void print_features(void)
@@ -258,7 +363,13 @@ static void print_help(const char *arg0)
    puts("      --no-patch        Disables all forms of content patching.");
    puts("  -D, --detach          Detach program from the running console. Not relevant for all platforms.");
    puts("      --max-frames=NUMBER\n"
-        "                        Runs for the specified number of frames, then exits.\n");
+        "                        Runs for the specified number of frames, then exits.");
+   puts("      --startup-timeline\n"
+        "                        Logs how long each startup phase took once the\n"
+        "                        first frame has been shown. Needs --verbose.");
+   puts("      --benchmark       Runs the built-in synthetic core instead of a libretro core,\n"
+        "                        configured through the benchmark_* settings. Content is\n"
+        "                        optional, and only names save files and states.\n");
 }
 
 static void set_basename(const char *path)
@@ -610,6 +721,8 @@ static void parse_input(int argc, char *argv[])
       { "features",     0, NULL, RA_OPT_FEATURES },
       { "subsystem",    1, NULL, RA_OPT_SUBSYSTEM },
       { "max-frames",   1, NULL, RA_OPT_MAX_FRAMES },
+      { "startup-timeline", 0, NULL, RA_OPT_STARTUP_TIMELINE },
+      { "benchmark",    0, NULL, RA_OPT_BENCHMARK },
       { "eof-exit",     0, NULL, RA_OPT_EOF_EXIT },
       { "version",      0, NULL, RA_OPT_VERSION },
 #ifdef HAVE_FILE_LOGGER
@@ -865,6 +978,10 @@ static void parse_input(int argc, char *argv[])
             global->inited.core.type        = CORE_TYPE_DUMMY;
             break;
 
+         case RA_OPT_BENCHMARK:
+            global->inited.core.type        = CORE_TYPE_BENCHMARK;
+            break;
+
 #ifdef HAVE_NETPLAY
          case RA_OPT_PORT:
             global->has_set.netplay_ip_port = true;
@@ -914,6 +1031,10 @@ static void parse_input(int argc, char *argv[])
                   sizeof(global->record.config));
             break;
 
+         case RA_OPT_STARTUP_TIMELINE:
+            rarch_startup.print = true;
+            break;
+
          case RA_OPT_MAX_FRAMES:
             {
                unsigned max_frames = strtoul(optarg, NULL, 10);
@@ -1110,17 +1231,32 @@ int rarch_main_init(int argc, char *argv[])
    bool *verbosity   = NULL;
    global_t *global  = global_get_ptr();
 
+   rarch_startup.count       = 0;
+   rarch_startup.current     = -1;
+   rarch_startup.first_frame = 0;
+   rarch_startup.origin      = retro_get_time_usec();
+   rarch_deferred_init_next  = RARCH_DEFERRED_INITS_COUNT;
+
+   mem_account_init();
+#ifdef HAVE_LIBRETRODB
+   database_info_init();
+#endif
+   rarch_perf_lock_init();
    init_state();
 
    if ((sjlj_ret = setjmp(error_sjlj_context)) > 0)
    {
       RARCH_ERR("Fatal error received in: \"%s\"\n", error_string);
+      retro_main_log_flush();
       return sjlj_ret;
    }
 
    rarch_ctl(RARCH_CTL_SET_ERROR_ON_INIT, NULL);
    retro_main_log_file_init(NULL);
+
+   rarch_startup_phase_begin("parse arguments");
    parse_input(argc, argv);
+   rarch_startup_phase_end();
 
    verbosity = retro_main_verbosity();
 
@@ -1140,8 +1276,15 @@ int rarch_main_init(int argc, char *argv[])
    }
 
    rarch_ctl(RARCH_CTL_VALIDATE_CPU_FEATURES, NULL);
+   rarch_perf_calibrate();
+
+   rarch_startup_phase_begin("config");
    config_load();
+   rarch_startup_phase_end();
+
+   rarch_startup_phase_begin("tasks");
    rarch_task_init();
+   rarch_startup_phase_end();
 
    {
       settings_t *settings = config_get_ptr();
@@ -1179,30 +1322,57 @@ int rarch_main_init(int argc, char *argv[])
       }
    }
 
+   rarch_startup_phase_begin("core load");
    init_libretro_sym(global->inited.core.type);
    runloop_ctl(RUNLOOP_CTL_SYSTEM_INFO_INIT, NULL);
    driver_ctl(RARCH_DRIVER_CTL_INIT_PRE, NULL);
+   rarch_startup_phase_end();
 
+   rarch_startup_phase_begin("core init");
    if (!event_command(EVENT_CMD_CORE_INIT))
       goto error;
+   rarch_startup_phase_end();
 
+   rarch_startup_phase_begin("drivers");
    event_command(EVENT_CMD_DRIVERS_INIT);
-   event_command(EVENT_CMD_COMMAND_INIT);
-   event_command(EVENT_CMD_REMOTE_INIT);
-   event_command(EVENT_CMD_REWIND_INIT);
+   rarch_startup_phase_end();
+
+   rarch_startup_phase_begin("controllers");
    event_command(EVENT_CMD_CONTROLLERS_INIT);
+   rarch_startup_phase_end();
+
+   rarch_startup_phase_begin("record");
    event_command(EVENT_CMD_RECORD_INIT);
-   event_command(EVENT_CMD_CHEATS_INIT);
+   rarch_startup_phase_end();
+
+   rarch_startup_phase_begin("remapping");
    event_command(EVENT_CMD_REMAPPING_INIT);
+   rarch_startup_phase_end();
 
+   rarch_startup_phase_begin("savefiles");
    event_command(EVENT_CMD_SAVEFILES_INIT);
    event_command(EVENT_CMD_SET_PER_GAME_RESOLUTION);
+   rarch_startup_phase_end();
+
+   /* Counters follow the thread that opens them, the one
+    * running the core. */
+   {
+      settings_t *settings = config_get_ptr();
+      if (settings->perfcnt_hw_enable)
+         hw_counters_init();
+   }
+
+   /* Rewind, cheats, command and remote interfaces follow
+    * after the first frame, see RARCH_CTL_DEFERRED_INIT_ITERATE. */
+   rarch_deferred_init_next = 0;
+   rarch_deferred_init_wait = true;
 
    rarch_ctl(RARCH_CTL_UNSET_ERROR_ON_INIT, NULL);
    global->inited.main  = true;
    return 0;
 
 error:
+   rarch_startup_phase_end();
    event_command(EVENT_CMD_CORE_DEINIT);
 
    global->inited.main  = false;
@@ -1306,6 +1476,9 @@ bool rarch_ctl(enum rarch_ctl_state state, void *data)
          runloop_ctl(RUNLOOP_CTL_STATE_FREE,  NULL);
          runloop_ctl(RUNLOOP_CTL_GLOBAL_FREE, NULL);
          runloop_ctl(RUNLOOP_CTL_DATA_DEINIT, NULL);
+#ifdef HAVE_LIBRETRODB
+         database_info_deinit();
+#endif
          config_free();
          return true;
       case RARCH_CTL_DEINIT:
@@ -1342,6 +1515,37 @@ bool rarch_ctl(enum rarch_ctl_state state, void *data)
       case RARCH_CTL_SET_PATHS_REDIRECT:
          set_paths_redirect(global->name.base);
          break;
+      case RARCH_CTL_FIRST_FRAME:
+         if (rarch_startup.first_frame)
+            return false;
+
+         rarch_startup.first_frame = retro_get_time_usec();
+         if (rarch_startup.print
+               && rarch_deferred_init_next >= RARCH_DEFERRED_INITS_COUNT)
+            rarch_startup_print();
+         return true;
+      case RARCH_CTL_DEFERRED_INIT_ITERATE:
+         if (rarch_deferred_init_next >= RARCH_DEFERRED_INITS_COUNT)
+            return false;
+
+         if (rarch_deferred_init_wait)
+         {
+            rarch_deferred_init_wait = false;
+            return true;
+         }
+
+         {
+            unsigned i = rarch_deferred_init_next++;
+
+            rarch_startup_phase_begin(rarch_deferred_inits[i].name);
+            event_command(rarch_deferred_inits[i].cmd);
+            rarch_startup_phase_end();
+         }
+
+         if (rarch_startup.print && rarch_startup.first_frame
+               && rarch_deferred_init_next == RARCH_DEFERRED_INITS_COUNT)
+            rarch_startup_print();
+         return true;
       case RARCH_CTL_SET_ERROR_ON_INIT:
          rarch_error_on_init = true;
          break;
@@ -1501,6 +1705,11 @@ void rarch_main_deinit(void)
 {
    global_t *global = global_get_ptr();
 
+   /* Nothing left to bring up for this content. */
+   rarch_deferred_init_next = RARCH_DEFERRED_INITS_COUNT;
+
+   hw_counters_deinit();
+
    event_command(EVENT_CMD_NETPLAY_DEINIT);
    event_command(EVENT_CMD_COMMAND_DEINIT);
    event_command(EVENT_CMD_REMOTE_DEINIT);
@@ -1518,6 +1727,10 @@ void rarch_main_deinit(void)
    event_command(EVENT_CMD_AUTOSAVE_STATE);
 
    event_command(EVENT_CMD_CORE_DEINIT);
+   perf_trace_deinit();
+#ifdef HAVE_DYNAMIC
+   libretro_save_system_info_cache();
+#endif
 
    event_command(EVENT_CMD_TEMPORARY_CONTENT_DEINIT);
    event_command(EVENT_CMD_SUBSYSTEM_FULLPATHS_DEINIT);
@@ -1747,7 +1960,8 @@ void retro_fail(int error_code, const char *error)
 {
    /* We cannot longjmp unless we're in rarch_main_init().
     * If not, something went very wrong, and we should 
-    * just exit right away. */
+    * just exit right away. Get the log out first. */
+   retro_main_log_flush();
    retro_assert(rarch_ctl(RARCH_CTL_IS_ERROR_ON_INIT, NULL));
 
    strlcpy(error_string, error, sizeof(error_string));
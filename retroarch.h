@@ -105,6 +105,15 @@ enum rarch_ctl_state
 
    RARCH_CTL_SET_PATHS_REDIRECT,
 
+   /* Brings up the next subsystem rarch_main_init() left for
+    * after the first frame. Called once per runloop iteration.
+    * Returns false once nothing is left. */
+   RARCH_CTL_DEFERRED_INIT_ITERATE,
+
+   /* Records the first frame the core ran for the startup
+    * timeline. Returns false if it was already recorded. */
+   RARCH_CTL_FIRST_FRAME,
+
    RARCH_CTL_SET_FORCE_FULLSCREEN,
 
    RARCH_CTL_UNSET_FORCE_FULLSCREEN,
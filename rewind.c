@@ -28,6 +28,7 @@
 #include "libretro_version_1.h"
 #include "performance.h"
 #include "verbosity.h"
+#include "mem_account.h"
 #include "audio/audio_driver.h"
 
 /* This makes Valgrind throw errors if a core overflows its savestate size. */
@@ -72,6 +73,9 @@ struct state_manager
     * (yes, the math is a bit ugly). */
    size_t maxcompsize;
 
+   /* Bytes accounted to MEM_TAG_REWIND. */
+   size_t accounted;
+
    unsigned entries;
    bool thisblock_valid;
 #if STRICT_BUF_SIZE
@@ -426,7 +430,10 @@ state_manager_t *state_manager_new(size_t state_size, size_t buffer_size)
    if (!state->data || !state->thisblock || !state->nextblock)
       goto error;
 
-   state->capacity = buffer_size;
+   state->capacity  = buffer_size;
+   state->accounted = sizeof(*state) + buffer_size
+      + 2 * (state->blocksize + sizeof(uint16_t) * 4 + 16);
+   mem_account_add(MEM_TAG_REWIND, state->accounted);
 
    state->head = state->data + sizeof(size_t);
    state->tail = state->data + sizeof(size_t);
@@ -448,6 +455,7 @@ void state_manager_free(state_manager_t *state)
    if (!state)
       return;
 
+   mem_account_sub(MEM_TAG_REWIND, state->accounted);
    free(state->data);
    free(state->thisblock);
    free(state->nextblock);
@@ -38,6 +38,8 @@
 #include "cheats.h"
 #include "configuration.h"
 #include "performance.h"
+#include "perf_trace.h"
+#include "hw_counters.h"
 #include "movie.h"
 #include "retroarch.h"
 #include "runloop.h"
@@ -1239,6 +1241,8 @@ int runloop_iterate(unsigned *sleep_ms)
    global_t   *global                           = global_get_ptr();
    rarch_system_info_t *system                  = NULL;
 
+   perf_trace_frame();
+
    cmd.state[1]                                 = last_input;
    cmd.state[0]                                 = input_keys_pressed();
    last_input                                   = cmd.state[0];
@@ -1349,6 +1353,14 @@ int runloop_iterate(unsigned *sleep_ms)
       return -1;
    }
 
+   /* Bring up whatever rarch_main_init() deferred, one
+    * subsystem per iteration. Done before the menu and pause
+    * checks below so neither holds it back. */
+   if (perf_trace_active)
+      perf_trace_begin("deferred_init");
+   rarch_ctl(RARCH_CTL_DEFERRED_INIT_ITERATE, NULL);
+   if (perf_trace_active)
+      perf_trace_end("deferred_init");
 
 #ifdef HAVE_MENU
    if (menu_driver_ctl(RARCH_MENU_CTL_IS_ALIVE, NULL))
@@ -1411,7 +1423,16 @@ int runloop_iterate(unsigned *sleep_ms)
       retro_sleep(settings->video.frame_delay);
 
    /* Run libretro for one frame. */
+   if (perf_trace_active)
+      perf_trace_begin("retro_run");
+   if (hw_counters_active)
+      hw_counters_begin();
    core.retro_run();
+   if (hw_counters_active)
+      hw_counters_end();
+   if (perf_trace_active)
+      perf_trace_end("retro_run");
+   rarch_ctl(RARCH_CTL_FIRST_FRAME, NULL);
 
 #ifdef HAVE_CHEEVOS
    /* Test the achievements. */
@@ -1434,6 +1455,8 @@ int runloop_iterate(unsigned *sleep_ms)
    netplay_driver_ctl(RARCH_NETPLAY_CTL_POST_FRAME, NULL);
 #endif
 
+   rarch_perf_frame();
+
 #if defined(HAVE_THREADS)
    unlock_autosave();
 #endif
@@ -46,12 +46,317 @@
 #define PROGRAM_NAME "N/A"
 #endif
 
+#if defined(HAVE_THREADS) && defined(RARCH_INTERNAL) && !defined(IS_SALAMANDER) \
+   && !defined(HAVE_LOGGER) && !defined(ANDROID) && !defined(_XBOX1) \
+   && !TARGET_OS_IPHONE && (defined(__GNUC__) || defined(_MSC_VER))
+#define HAVE_LOG_RING
+#endif
+
+#ifdef HAVE_LOG_RING
+#include <stdint.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+#include <windows.h>
+#endif
+
+#include <retro_miscellaneous.h>
+#include <rthreads/rthreads.h>
+
+#include "performance.h"
+#endif
+
 #include "verbosity.h"
 
 /* If this is non-NULL. RARCH_LOG and friends 
  * will write to this file. */
 static FILE *log_file;
 
+/* Messages below this level are discarded before being formatted. */
+static unsigned log_level;
+
+#ifdef HAVE_LOG_RING
+/* Both must be powers of two. */
+#ifndef LOG_RING_SLOTS
+#define LOG_RING_SLOTS    256
+#endif
+#ifndef LOG_RING_MSG_SIZE
+#define LOG_RING_MSG_SIZE 1024
+#endif
+
+#ifdef _MSC_VER
+#define LOG_RING_CAS(ptr, old, new) \
+   (InterlockedCompareExchange((volatile LONG*)(ptr), (LONG)(new), (LONG)(old)) == (LONG)(old))
+#define LOG_RING_INC(ptr) InterlockedIncrement((volatile LONG*)(ptr))
+#define LOG_RING_DEC(ptr) InterlockedDecrement((volatile LONG*)(ptr))
+#define LOG_RING_BARRIER() MemoryBarrier()
+#else
+#define LOG_RING_CAS(ptr, old, new) __sync_bool_compare_and_swap((ptr), (old), (new))
+#define LOG_RING_INC(ptr) __sync_fetch_and_add((ptr), 1)
+#define LOG_RING_DEC(ptr) __sync_fetch_and_sub((ptr), 1)
+#define LOG_RING_BARRIER() __sync_synchronize()
+#endif
+
+/* A slot is free for the producer claiming position N when its
+ * sequence equals N, and ready for the writer once it equals N + 1.
+ * Consuming it moves it to N + LOG_RING_SLOTS, the next lap. */
+struct log_ring_slot
+{
+   volatile uint32_t seq;
+   retro_time_t time;
+   char text[LOG_RING_MSG_SIZE];
+};
+
+static struct
+{
+   struct log_ring_slot slots[LOG_RING_SLOTS];
+   volatile uint32_t head;
+   uint32_t tail;
+   volatile uint32_t dropped;
+   uint32_t dropped_reported;
+   retro_time_t start;
+
+   volatile bool running;
+   /* Threads between checking running and finishing their push.
+    * log_ring_stop() waits for them before the last drain. */
+   volatile uint32_t producers;
+   /* Set by the writer while it waits on cond. Producers only
+    * take lock to wake it up when this is set. */
+   volatile bool sleeping;
+   bool quit;
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond;
+   /* Held by whoever is writing slots out, so the background
+    * writer and an explicit flush never interleave. */
+   slock_t *drain_lock;
+} log_ring;
+
+static void log_ring_write(retro_time_t time, const char *text)
+{
+   retro_time_t usec = time - log_ring.start;
+
+   fprintf(LOG_FILE, "[%u.%06u] %s",
+         (unsigned)(usec / 1000000), (unsigned)(usec % 1000000), text);
+}
+
+static void log_ring_drain_locked(void)
+{
+   uint32_t dropped;
+
+   for (;;)
+   {
+      struct log_ring_slot *slot =
+         &log_ring.slots[log_ring.tail & (LOG_RING_SLOTS - 1)];
+
+      if (slot->seq != log_ring.tail + 1)
+         break;
+      LOG_RING_BARRIER();
+
+      log_ring_write(slot->time, slot->text);
+
+      LOG_RING_BARRIER();
+      slot->seq = log_ring.tail + LOG_RING_SLOTS;
+      log_ring.tail++;
+   }
+
+   dropped = log_ring.dropped;
+   if (dropped != log_ring.dropped_reported)
+   {
+      fprintf(LOG_FILE, "%s [WARN] :: %u log messages dropped.\n",
+            PROGRAM_NAME, dropped - log_ring.dropped_reported);
+      log_ring.dropped_reported = dropped;
+   }
+
+   fflush(LOG_FILE);
+}
+
+static void log_ring_drain(void)
+{
+   slock_lock(log_ring.drain_lock);
+   log_ring_drain_locked();
+   slock_unlock(log_ring.drain_lock);
+}
+
+static bool log_ring_ready(void)
+{
+   bool ready;
+
+   slock_lock(log_ring.drain_lock);
+   ready = log_ring.slots[log_ring.tail & (LOG_RING_SLOTS - 1)].seq
+      == log_ring.tail + 1;
+   slock_unlock(log_ring.drain_lock);
+
+   return ready;
+}
+
+static void log_ring_thread(void *data)
+{
+   (void)data;
+
+   for (;;)
+   {
+      log_ring_drain();
+
+      slock_lock(log_ring.lock);
+      if (log_ring.quit)
+      {
+         slock_unlock(log_ring.lock);
+         break;
+      }
+
+      /* Pairs with the barrier in log_ring_push(): either the
+       * producer sees sleeping and signals under lock, or the
+       * slot it published is seen here. */
+      log_ring.sleeping = true;
+      LOG_RING_BARRIER();
+      if (!log_ring_ready())
+         scond_wait(log_ring.cond, log_ring.lock);
+      log_ring.sleeping = false;
+      slock_unlock(log_ring.lock);
+   }
+
+   log_ring_drain();
+}
+
+static void log_ring_start(void)
+{
+   unsigned i;
+
+   if (log_ring.running)
+      return;
+
+   for (i = 0; i < LOG_RING_SLOTS; i++)
+      log_ring.slots[i].seq = i;
+
+   log_ring.head             = 0;
+   log_ring.tail             = 0;
+   log_ring.dropped          = 0;
+   log_ring.dropped_reported = 0;
+   log_ring.producers        = 0;
+   log_ring.sleeping         = false;
+   log_ring.quit             = false;
+   log_ring.start            = retro_get_time_usec();
+   log_ring.lock             = slock_new();
+   log_ring.cond             = scond_new();
+   log_ring.drain_lock       = slock_new();
+
+   if (!log_ring.lock || !log_ring.cond || !log_ring.drain_lock)
+      goto error;
+
+   log_ring.thread = sthread_create(log_ring_thread, NULL);
+   if (!log_ring.thread)
+      goto error;
+
+   LOG_RING_BARRIER();
+   log_ring.running = true;
+   return;
+
+error:
+   if (log_ring.lock)
+      slock_free(log_ring.lock);
+   if (log_ring.cond)
+      scond_free(log_ring.cond);
+   if (log_ring.drain_lock)
+      slock_free(log_ring.drain_lock);
+   log_ring.lock       = NULL;
+   log_ring.cond       = NULL;
+   log_ring.drain_lock = NULL;
+}
+
+static void log_ring_stop(void)
+{
+   if (!log_ring.running)
+      return;
+
+   log_ring.running = false;
+   LOG_RING_BARRIER();
+
+   /* Let producers that already saw the ring running finish,
+    * so nothing lands after the last drain or signals a freed
+    * cond. */
+   while (log_ring.producers)
+      retro_sleep(1);
+
+   slock_lock(log_ring.lock);
+   log_ring.quit = true;
+   scond_signal(log_ring.cond);
+   slock_unlock(log_ring.lock);
+
+   sthread_join(log_ring.thread);
+
+   slock_free(log_ring.lock);
+   scond_free(log_ring.cond);
+   slock_free(log_ring.drain_lock);
+   log_ring.thread     = NULL;
+   log_ring.lock       = NULL;
+   log_ring.cond       = NULL;
+   log_ring.drain_lock = NULL;
+}
+
+/**
+ * log_ring_push:
+ * @tag                 : Tag of the message.
+ * @fmt                 : Format string.
+ * @ap                  : Format arguments.
+ *
+ * Formats the message straight into a free slot of the ring,
+ * without taking any lock. Messages longer than LOG_RING_MSG_SIZE
+ * are truncated. If the ring is full, the message is dropped and
+ * counted; the writer reports the count.
+ *
+ * Callers must hold a reference in log_ring.producers.
+ **/
+static void log_ring_push(const char *tag,
+      const char *fmt, va_list ap)
+{
+   int len;
+   uint32_t pos;
+   struct log_ring_slot *slot = NULL;
+
+   for (;;)
+   {
+      int32_t diff;
+
+      pos  = log_ring.head;
+      slot = &log_ring.slots[pos & (LOG_RING_SLOTS - 1)];
+      diff = (int32_t)(slot->seq - pos);
+
+      if (diff == 0)
+      {
+         if (LOG_RING_CAS(&log_ring.head, pos, pos + 1))
+            break;
+      }
+      else if (diff < 0)
+      {
+         LOG_RING_INC(&log_ring.dropped);
+         return;
+      }
+   }
+
+   slot->time = retro_get_time_usec();
+   len        = snprintf(slot->text, sizeof(slot->text), "%s %s :: ",
+         PROGRAM_NAME, tag ? tag : "[INFO]");
+   if (len < 0 || len >= (int)sizeof(slot->text))
+      len = 0;
+   len       += vsnprintf(slot->text + len, sizeof(slot->text) - len, fmt, ap);
+   if (len >= (int)sizeof(slot->text))
+      slot->text[sizeof(slot->text) - 2] = '\n';
+
+   LOG_RING_BARRIER();
+   slot->seq = pos + 1;
+
+   /* Only take the lock if the writer is asleep. */
+   LOG_RING_BARRIER();
+   if (log_ring.sleeping)
+   {
+      slock_lock(log_ring.lock);
+      scond_signal(log_ring.cond);
+      slock_unlock(log_ring.lock);
+   }
+}
+#endif
+
 bool *retro_main_verbosity(void)
 {
    static bool main_verbosity;
@@ -65,20 +370,51 @@ FILE *retro_main_log_file(void)
 
 void retro_main_log_file_init(const char *path)
 {
+#ifdef HAVE_LOG_RING
+   /* Whatever is queued belongs to the previous file. */
+   if (log_ring.running)
+   {
+      slock_lock(log_ring.drain_lock);
+      log_ring_drain_locked();
+   }
+#endif
+
    log_file     = stderr;
-   if (path == NULL)
-      return;
+   if (path)
+      log_file = fopen(path, "wb");
 
-   log_file = fopen(path, "wb");
+#ifdef HAVE_LOG_RING
+   if (log_ring.running)
+      slock_unlock(log_ring.drain_lock);
+   else
+      log_ring_start();
+#endif
 }
 
 void retro_main_log_file_deinit(void)
 {
+#ifdef HAVE_LOG_RING
+   log_ring_stop();
+#endif
+
    if (log_file && log_file != stderr)
       fclose(log_file);
    log_file = NULL;
 }
 
+void retro_main_log_set_level(unsigned level)
+{
+   log_level = level;
+}
+
+void retro_main_log_flush(void)
+{
+#ifdef HAVE_LOG_RING
+   if (log_ring.running)
+      log_ring_drain();
+#endif
+}
+
 #if !defined(HAVE_LOGGER)
 static bool RARCH_LOG_VERBOSE(void)
 {
@@ -89,7 +425,8 @@ static bool RARCH_LOG_VERBOSE(void)
    return *verbose;
 }
 
-void RARCH_LOG_V(const char *tag, const char *fmt, va_list ap)
+static void retro_main_log_v(unsigned level,
+      const char *tag, const char *fmt, va_list ap)
 {
 #if TARGET_OS_IPHONE
    static int asl_inited = 0;
@@ -98,7 +435,7 @@ static aslclient asl_client;
 #endif
 #endif
 
-   if (!RARCH_LOG_VERBOSE())
+   if (!RARCH_LOG_VERBOSE() || level < log_level)
       return;
 #if TARGET_OS_IPHONE
 #if TARGET_IPHONE_SIMULATOR
@@ -136,17 +473,33 @@ static aslclient asl_client;
    }
    __android_log_vprint(prio, PROGRAM_NAME, fmt, ap);
 #else
+#ifdef HAVE_LOG_RING
+   LOG_RING_INC(&log_ring.producers);
+   LOG_RING_BARRIER();
+   if (log_ring.running)
+   {
+      log_ring_push(tag, fmt, ap);
+      LOG_RING_DEC(&log_ring.producers);
+      return;
+   }
+   LOG_RING_DEC(&log_ring.producers);
+#endif
    fprintf(LOG_FILE, "%s %s :: ", PROGRAM_NAME, tag ? tag : "[INFO]");
    vfprintf(LOG_FILE, fmt, ap);
    fflush(LOG_FILE);
 #endif
 }
 
+void RARCH_LOG_V(const char *tag, const char *fmt, va_list ap)
+{
+   retro_main_log_v(RARCH_LOG_LEVEL_INFO, tag, fmt, ap);
+}
+
 void RARCH_LOG(const char *fmt, ...)
 {
    va_list ap;
 
-   if (!RARCH_LOG_VERBOSE())
+   if (!RARCH_LOG_VERBOSE() || log_level > RARCH_LOG_LEVEL_INFO)
       return;
 
    va_start(ap, fmt);
@@ -169,7 +522,7 @@ void RARCH_LOG_OUTPUT(const char *msg, ...)
 
 void RARCH_WARN_V(const char *tag, const char *fmt, va_list ap)
 {
-   RARCH_LOG_V(tag, fmt, ap);
+   retro_main_log_v(RARCH_LOG_LEVEL_WARN, tag, fmt, ap);
 }
 
 void RARCH_WARN(const char *fmt, ...)
@@ -182,7 +535,7 @@ void RARCH_WARN(const char *fmt, ...)
 
 void RARCH_ERR_V(const char *tag, const char *fmt, va_list ap)
 {
-   RARCH_LOG_V(tag, fmt, ap);
+   retro_main_log_v(RARCH_LOG_LEVEL_ERROR, tag, fmt, ap);
 }
 
 void RARCH_ERR(const char *fmt, ...)
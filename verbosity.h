@@ -27,14 +27,45 @@
 extern "C" {
 #endif
 
+enum rarch_log_level
+{
+   RARCH_LOG_LEVEL_INFO = 0,
+   RARCH_LOG_LEVEL_WARN,
+   RARCH_LOG_LEVEL_ERROR
+};
+
 bool *retro_main_verbosity(void);
 
 FILE *retro_main_log_file(void);
 
 void retro_main_log_file_deinit(void);
 
+/**
+ * retro_main_log_file_init:
+ * @path                : Path of the log file, NULL logs to stderr.
+ *
+ * Sets where RARCH_LOG and friends write to. On platforms with
+ * threads, this also starts the background writer: messages are
+ * then formatted into a lock-free ring on the caller's thread and
+ * written out, timestamped, by the writer.
+ **/
 void retro_main_log_file_init(const char *path);
 
+/**
+ * retro_main_log_set_level:
+ * @level               : enum rarch_log_level.
+ *
+ * Discards messages below @level.
+ **/
+void retro_main_log_set_level(unsigned level);
+
+/**
+ * retro_main_log_flush:
+ *
+ * Writes out every message queued so far before returning.
+ **/
+void retro_main_log_flush(void);
+
 #if defined(HAVE_LOGGER)
 
 #define BUFSIZE	(64 * 1024)